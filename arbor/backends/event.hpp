@@ -53,9 +53,31 @@ inline deliverable_event_data event_data(const deliverable_event& ev) {
 
 using probe_handle = const fvm_value_type*;
 
+// How a sampled value is stored at its offset. Values for reduced samplers
+// are combined with the value stored at the same offset by earlier samples
+// in the reduction window, unless first in the window for this integration.
+enum class sample_store: unsigned char {
+    copy,        // store the value
+    sum,         // sum of values
+    sum_squares, // sum of squared values
+    min,         // least value
+    max          // greatest value
+};
+
 struct raw_probe_info {
     probe_handle handle;      // where the to-be-probed value sits
     sample_size_type offset;  // offset into array to store raw probed value
+    fvm_index_type linear = -1; // if non-negative, index of linear probe to evaluate instead
+    sample_store store = sample_store::copy;
+    bool first = true;        // if true, overwrite rather than combine with the stored value
+};
+
+// Linear probes are weighted sums of back-end state values, evaluated by
+// the back-end when sampled; the terms of each are held by the shared state.
+
+struct linear_probe_term {
+    probe_handle handle;
+    fvm_value_type weight;
 };
 
 struct sample_event {
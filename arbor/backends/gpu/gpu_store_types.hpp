@@ -18,6 +18,7 @@ namespace gpu {
 using array  = memory::device_vector<fvm_value_type>;
 using iarray = memory::device_vector<fvm_index_type>;
 using gjarray = memory::device_vector<fvm_gap_junction>;
+using linear_term_array = memory::device_vector<linear_probe_term>;
 
 using deliverable_event_stream = arb::gpu::multi_event_stream<deliverable_event>;
 using sample_event_stream = arb::gpu::multi_event_stream<sample_event>;
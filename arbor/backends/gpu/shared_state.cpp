@@ -37,6 +37,7 @@ void add_gj_current_impl(
 
 void take_samples_impl(
     const multi_event_stream_state<raw_probe_info>& s,
+    const linear_probe_term* linear_terms, const fvm_index_type* linear_divs,
     const fvm_value_type* time, fvm_value_type* sample_time, fvm_value_type* sample_value);
 
 void add_scalar(std::size_t n, fvm_value_type* data, fvm_value_type v);
@@ -219,6 +220,14 @@ void shared_state::configure_stimulus(const fvm_stimulus_config& stims) {
     stim_data = istim_state(stims);
 }
 
+void shared_state::configure_linear_probes(
+    const std::vector<linear_probe_term>& terms,
+    const std::vector<fvm_index_type>& divs)
+{
+    linear_terms = make_const_view(terms);
+    linear_divs = make_const_view(divs);
+}
+
 void shared_state::reset() {
     memory::copy(init_voltage, voltage);
     memory::fill(current_density, 0);
@@ -273,7 +282,7 @@ std::pair<fvm_value_type, fvm_value_type> shared_state::voltage_bounds() const {
 }
 
 void shared_state::take_samples(const sample_event_stream::state& s, array& sample_time, array& sample_value) {
-    take_samples_impl(s, time.data(), sample_time.data(), sample_value.data());
+    take_samples_impl(s, linear_terms.data(), linear_divs.data(), time.data(), sample_time.data(), sample_value.data());
 }
 
 // Debug interface
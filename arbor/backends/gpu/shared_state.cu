@@ -69,6 +69,8 @@ __global__ void set_dt_impl(      T* __restrict__ dt_intdom,
 
 __global__ void take_samples_impl(
     multi_event_stream_state<raw_probe_info> s,
+    const linear_probe_term* __restrict__ const linear_terms,
+    const fvm_index_type* __restrict__ const linear_divs,
     const fvm_value_type* __restrict__ const time,
     fvm_value_type* __restrict__ const sample_time,
     fvm_value_type* __restrict__ const sample_value)
@@ -79,7 +81,35 @@ __global__ void take_samples_impl(
         auto end = s.ev_data+s.end_offset[i];
         for (auto p = begin; p!=end; ++p) {
             sample_time[p->offset] = time[i];
-            sample_value[p->offset] = p->handle? *p->handle: 0;
+
+            fvm_value_type v = 0;
+            if (p->handle) {
+                v = *p->handle;
+            }
+            else if (p->linear>=0) {
+                for (auto j = linear_divs[p->linear]; j<linear_divs[p->linear+1]; ++j) {
+                    v += linear_terms[j].weight*(*linear_terms[j].handle);
+                }
+            }
+
+            fvm_value_type& x = sample_value[p->offset];
+            switch (p->store) {
+            case sample_store::copy:
+                x = v;
+                break;
+            case sample_store::sum:
+                x = p->first? v: x+v;
+                break;
+            case sample_store::sum_squares:
+                x = p->first? v*v: x+v*v;
+                break;
+            case sample_store::min:
+                x = p->first || v<x? v: x;
+                break;
+            case sample_store::max:
+                x = p->first || x<v? v: x;
+                break;
+            }
         }
     }
 }
@@ -130,13 +160,14 @@ void add_gj_current_impl(
 
 void take_samples_impl(
     const multi_event_stream_state<raw_probe_info>& s,
+    const linear_probe_term* linear_terms, const fvm_index_type* linear_divs,
     const fvm_value_type* time, fvm_value_type* sample_time, fvm_value_type* sample_value)
 {
     if (!s.n_streams()) return;
 
     constexpr int block_dim = 128;
     const int nblock = block_count(s.n_streams(), block_dim);
-    kernel::take_samples_impl<<<nblock, block_dim>>>(s, time, sample_time, sample_value);
+    kernel::take_samples_impl<<<nblock, block_dim>>>(s, linear_terms, linear_divs, time, sample_time, sample_value);
 }
 
 } // namespace gpu
@@ -122,6 +122,9 @@ struct shared_state {
     array time_since_spike;   // Stores time since last spike on any detector, organized by cell.
     iarray src_to_spike;      // Maps spike source index to spike index
 
+    linear_term_array linear_terms; // Terms of linear probes.
+    iarray linear_divs;      // Maps linear probe index to its range of terms.
+
     istim_state stim_data;
     std::unordered_map<std::string, ion_state> ion_data;
     deliverable_event_stream deliverable_events;
@@ -149,6 +152,12 @@ struct shared_state {
 
     void configure_stimulus(const fvm_stimulus_config&);
 
+    // Set terms of linear probes: the value of probe i is the weighted sum
+    // of terms[divs[i]] to terms[divs[i+1]-1].
+    void configure_linear_probes(
+        const std::vector<linear_probe_term>& terms,
+        const std::vector<fvm_index_type>& divs);
+
     void zero_currents();
 
     void ions_init_concentration();
@@ -24,6 +24,7 @@ using padded_vector = std::vector<V, util::padded_allocator<V>>;
 using array  = padded_vector<fvm_value_type>;
 using iarray = padded_vector<fvm_index_type>;
 using gjarray = padded_vector<fvm_gap_junction>;
+using linear_term_array = padded_vector<linear_probe_term>;
 
 using deliverable_event_stream = arb::multicore::multi_event_stream<deliverable_event>;
 using sample_event_stream = arb::multicore::multi_event_stream<sample_event>;
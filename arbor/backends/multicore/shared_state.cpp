@@ -89,6 +89,25 @@ void ion_state::reset() {
 
 // istim_state methods:
 
+namespace {
+// Sinusoidal stimuli are advanced incrementally by rotation through the
+// phase increment ω·h of each step, with sin and cos of the increment
+// given by truncated Taylor series. Fall back to direct evaluation when
+// the increment is too large for the series, and periodically to bound
+// the accumulated round-off.
+
+constexpr double stim_max_rotation = 0.1; // (rad)
+constexpr fvm_index_type stim_max_rotation_steps = 256;
+
+template <typename T>
+void sincos_small(const T& theta, T& s, T& c) {
+    // Taylor series to order 9 (sin) and 10 (cos): error < 1e-18 for |θ| ≤ 0.1.
+    T t2 = theta*theta;
+    s = theta*(1.-t2*(1./6)*(1.-t2*(1./20)*(1.-t2*(1./42)*(1.-t2*(1./72)))));
+    c = 1.-t2*(1./2)*(1.-t2*(1./12)*(1.-t2*(1./30)*(1.-t2*(1./56)*(1.-t2*(1./90)))));
+}
+} // anonymous namespace
+
 istim_state::istim_state(const fvm_stimulus_config& stim, unsigned align):
     alignment(min_alignment(align)),
     accu_to_cv_(stim.cv_unique.begin(), stim.cv_unique.end(), pad(alignment)),
@@ -97,18 +116,35 @@ istim_state::istim_state(const fvm_stimulus_config& stim, unsigned align):
 {
     using util::assign;
 
-    // Translate instance-to-CV index from stim to istim_state index vectors.
-    assign(accu_index_, util::index_into(stim.cv, accu_to_cv_));
-    accu_stim_.resize(accu_to_cv_.size());
-
-    std::size_t n = accu_index_.size();
+    std::size_t n = frequency_.size();
     std::vector<fvm_value_type> envl_a, envl_t;
     std::vector<fvm_index_type> edivs;
 
-    arb_assert(n==frequency_.size());
+    arb_assert(n==stim.cv.size());
     arb_assert(n==stim.envelope_time.size());
     arb_assert(n==stim.envelope_amplitude.size());
 
+    // Per-instance data used in the vectorized update are padded to a
+    // multiple of the SIMD width. Padding instances repeat the last CV
+    // and accumulator indices, and contribute zero current.
+    std::size_t n_pad = n? math::round_up(n, simd_width): 0;
+
+    // Translate instance-to-CV index from stim to istim_state index vectors.
+    std::vector<fvm_index_type> accu_index = util::assign_from(util::index_into(stim.cv, accu_to_cv_));
+    std::vector<fvm_index_type> cv = stim.cv;
+    if (n) {
+        accu_index.resize(n_pad, accu_index.back());
+        cv.resize(n_pad, cv.back());
+    }
+    accu_index_ = iarray(accu_index.begin(), accu_index.end(), pad(alignment));
+    instance_cv_ = iarray(cv.begin(), cv.end(), pad(alignment));
+    accu_stim_.resize(accu_to_cv_.size());
+
+    omega_ = array(n_pad, 0., pad(alignment));
+    for (auto i: util::make_span(n)) {
+        omega_[i] = 2*math::pi<double>*frequency_[i];
+    }
+
     edivs.reserve(n+1);
     edivs.push_back(0);
 
@@ -125,6 +161,13 @@ istim_state::istim_state(const fvm_stimulus_config& stim, unsigned align):
     assign(envl_times_, envl_t);
     assign(envl_divs_, edivs);
     envl_index_.assign(edivs.data(), edivs.data()+n);
+
+    for (auto* a: {&seg_t0_, &seg_t1_, &seg_J0_, &seg_dJ_, &wave_sin_, &wave_cos_, &wave_t_}) {
+        *a = array(n_pad, 0., pad(alignment));
+    }
+    wave_steps_ = iarray(n_pad, 0, pad(alignment));
+
+    reset();
 }
 
 void istim_state::zero_current() {
@@ -136,44 +179,120 @@ void istim_state::reset() {
 
     std::size_t n = envl_index_.size();
     std::copy(envl_divs_.data(), envl_divs_.data()+n, envl_index_.begin());
-}
 
-void istim_state::add_current(const array& time, const iarray& cv_to_intdom, array& current_density) {
-    constexpr double two_pi = 2*math::pi<double>;
-
-    // Consider vectorizing...
-    for (auto i: util::count_along(accu_index_)) {
-        // Advance index into envelope until either
-        // - the next envelope time is greater than simulation time, or
-        // - it is the last valid index for the envelope.
-
-        fvm_index_type ei_left = envl_divs_[i];
-        fvm_index_type ei_right = envl_divs_[i+1];
+    // Invalidate envelope segments, so that they are recomputed on first use;
+    // padding instances keep a zero segment that never expires.
+    util::fill(seg_t0_, 0);
+    util::fill(seg_J0_, 0);
+    util::fill(seg_dJ_, 0);
+    util::fill(seg_t1_, INFINITY);
+    std::fill(seg_t1_.begin(), seg_t1_.begin()+n, -INFINITY);
+
+    // Non-oscillating instances have constant unit waveform; force a direct
+    // evaluation on first use for the others.
+    util::fill(wave_sin_, 1);
+    util::fill(wave_cos_, 0);
+    util::fill(wave_t_, 0);
+    util::fill(wave_steps_, stim_max_rotation_steps);
+}
 
-        fvm_index_type ai = accu_index_[i];
-        fvm_index_type cv = accu_to_cv_[ai];
-        double t = time[cv_to_intdom[cv]];
+void istim_state::update_segment(fvm_size_type i, fvm_value_type t) {
+    // Advance index into envelope until either
+    // - the next envelope time is greater than simulation time, or
+    // - it is the last valid index for the envelope.
+    // Then record the linear segment containing t.
+
+    fvm_index_type ei_left = envl_divs_[i];
+    fvm_index_type ei_right = envl_divs_[i+1];
+
+    if (ei_left==ei_right || t<envl_times_[ei_left]) {
+        // Zero current until the envelope starts.
+        seg_t0_[i] = t;
+        seg_t1_[i] = ei_left==ei_right? INFINITY: envl_times_[ei_left];
+        seg_J0_[i] = 0;
+        seg_dJ_[i] = 0;
+        return;
+    }
 
-        if (ei_left==ei_right || t<envl_times_[ei_left]) continue;
+    fvm_index_type& ei = envl_index_[i];
+    while (ei+1<ei_right && envl_times_[ei+1]<=t) ++ei;
 
-        fvm_index_type& ei = envl_index_[i];
-        while (ei+1<ei_right && envl_times_[ei+1]<=t) ++ei;
+    seg_t0_[i] = envl_times_[ei];
+    seg_J0_[i] = envl_amplitudes_[ei]; // current density (A/m²)
+    if (ei+1<ei_right) {
+        // linearly interpolate:
+        arb_assert(envl_times_[ei]<=t && envl_times_[ei+1]>t);
+        seg_t1_[i] = envl_times_[ei+1];
+        seg_dJ_[i] = (envl_amplitudes_[ei+1]-envl_amplitudes_[ei])/(envl_times_[ei+1]-envl_times_[ei]);
+    }
+    else {
+        seg_t1_[i] = INFINITY;
+        seg_dJ_[i] = 0;
+    }
+}
 
-        double J = envl_amplitudes_[ei]; // current density (A/m²)
-        if (ei+1<ei_right) {
-            // linearly interpolate:
-            arb_assert(envl_times_[ei]<=t && envl_times_[ei+1]>t);
-            double J1 = envl_amplitudes_[ei+1];
-            double u = (t-envl_times_[ei])/(envl_times_[ei+1]-envl_times_[ei]);
-            J = math::lerp(J, J1, u);
-        }
+void istim_state::add_current(const array& time, const iarray& cv_to_intdom, array& current_density) {
+    using simd::assign;
+    using simd::indirect;
 
-        if (frequency_[i]) {
-            J *= std::sin(two_pi*frequency_[i]*t + phase_[i]);
+    const fvm_size_type n = envl_index_.size();
+    const fvm_size_type n_pad = instance_cv_.size();
+
+    // Scalar pass: update envelope segments that have expired, and evaluate
+    // sinusoids directly where incremental update is not possible.
+    for (fvm_size_type i = 0; i<n; ++i) {
+        double t = time[cv_to_intdom[instance_cv_[i]]];
+
+        if (t>=seg_t1_[i]) update_segment(i, t);
+
+        if (omega_[i]) {
+            double theta = omega_[i]*(t-wave_t_[i]);
+            if (wave_steps_[i]>=stim_max_rotation_steps || !(std::abs(theta)<=stim_max_rotation)) {
+                double phi = omega_[i]*t + phase_[i];
+                wave_sin_[i] = std::sin(phi);
+                wave_cos_[i] = std::cos(phi);
+                wave_t_[i] = t;
+                wave_steps_[i] = 0;
+            }
+            else {
+                ++wave_steps_[i];
+            }
         }
+    }
 
-        accu_stim_[ai] += J;
-        current_density[cv] -= J;
+    // Vector pass: rotate waveforms to the current time, evaluate
+    // envelope segments, and accumulate current contributions.
+    // Instances are ordered by CV, so indices are monotonic.
+    for (fvm_size_type i = 0; i<n_pad; i+=simd_width) {
+        simd_index_type cv, intdom, ai;
+        assign(cv, indirect(instance_cv_.data()+i, simd_width));
+        assign(ai, indirect(accu_index_.data()+i, simd_width));
+        assign(intdom, indirect(cv_to_intdom.data(), cv, simd_width));
+
+        simd_value_type t, t0, J0, dJ, s, c, wt, omega;
+        assign(t, indirect(time.data(), intdom, simd_width));
+        assign(t0, indirect(seg_t0_.data()+i, simd_width));
+        assign(J0, indirect(seg_J0_.data()+i, simd_width));
+        assign(dJ, indirect(seg_dJ_.data()+i, simd_width));
+        assign(s, indirect(wave_sin_.data()+i, simd_width));
+        assign(c, indirect(wave_cos_.data()+i, simd_width));
+        assign(wt, indirect(wave_t_.data()+i, simd_width));
+        assign(omega, indirect(omega_.data()+i, simd_width));
+
+        simd_value_type sr, cr;
+        sincos_small(omega*(t-wt), sr, cr);
+
+        simd_value_type s_new = s*cr+c*sr;
+        simd_value_type c_new = c*cr-s*sr;
+
+        indirect(wave_sin_.data()+i, simd_width) = s_new;
+        indirect(wave_cos_.data()+i, simd_width) = c_new;
+        indirect(wave_t_.data()+i, simd_width) = t;
+
+        simd_value_type J = (J0+dJ*(t-t0))*s_new;
+
+        indirect(accu_stim_.data(), ai, simd_width, simd::index_constraint::none) += J;
+        indirect(current_density.data(), cv, simd_width, simd::index_constraint::none) -= J;
     }
 }
 
@@ -249,6 +368,14 @@ void shared_state::configure_stimulus(const fvm_stimulus_config& stims) {
     stim_data = istim_state(stims, alignment);
 }
 
+void shared_state::configure_linear_probes(
+    const std::vector<linear_probe_term>& terms,
+    const std::vector<fvm_index_type>& divs)
+{
+    linear_terms = linear_term_array(terms.begin(), terms.end(), pad(alignment));
+    linear_divs = iarray(divs.begin(), divs.end(), pad(alignment));
+}
+
 void shared_state::reset() {
     std::copy(init_voltage.begin(), init_voltage.end(), voltage.begin());
     util::fill(current_density, 0);
@@ -346,11 +473,55 @@ void shared_state::take_samples(
         auto begin = s.begin_marked(i);
         auto end = s.end_marked(i);
 
-        // Null handles are explicitly permitted, and always give a sample of zero.
-        // (Note: probably not worth explicitly vectorizing this.)
-        for (auto p = begin; p<end; ++p) {
-            sample_time[p->offset] = time[i];
-            sample_value[p->offset] = p->handle? *p->handle: 0;
+        // Events with consecutive handles and consecutive offsets, as given by
+        // probes on contiguous state such as whole-cell probes, are taken as
+        // runs with block copies. Null handles are explicitly permitted, and
+        // always give a sample of zero, unless the event is for a linear
+        // probe, which is evaluated from its terms. Samples for reduced
+        // samplers are combined with the value at their offset.
+        for (auto p = begin; p<end;) {
+            auto q = p+1;
+            if (p->handle && p->store==sample_store::copy) {
+                while (q<end && q->handle==q[-1].handle+1 && q->offset==q[-1].offset+1 && q->store==sample_store::copy) ++q;
+            }
+
+            auto n = q-p;
+            std::fill_n(sample_time.data()+p->offset, n, time[i]);
+            if (n>1) {
+                std::copy_n(p->handle, n, sample_value.data()+p->offset);
+                p = q;
+                continue;
+            }
+
+            fvm_value_type v = 0;
+            if (p->handle) {
+                v = *p->handle;
+            }
+            else if (p->linear>=0) {
+                for (auto j = linear_divs[p->linear]; j<linear_divs[p->linear+1]; ++j) {
+                    v += linear_terms[j].weight*(*linear_terms[j].handle);
+                }
+            }
+
+            fvm_value_type& x = sample_value[p->offset];
+            switch (p->store) {
+            case sample_store::copy:
+                x = v;
+                break;
+            case sample_store::sum:
+                x = p->first? v: x+v;
+                break;
+            case sample_store::sum_squares:
+                x = p->first? v*v: x+v*v;
+                break;
+            case sample_store::min:
+                x = p->first? v: std::min(x, v);
+                break;
+            case sample_store::max:
+                x = p->first? v: std::max(x, v);
+                break;
+            }
+            p = q;
         }
     }
 }
@@ -79,9 +79,11 @@ struct istim_state {
     // Immutable data (post initialization):
     iarray accu_index_;     // Instance to accumulator index (accu_stim_ index) map.
     iarray accu_to_cv_;     // Accumulator index to CV map.
+    iarray instance_cv_;    // Instance to CV map.
 
     array frequency_;       // (kHz) stimulus frequency per instance.
     array phase_;           // (rad) stimulus waveform phase at t=0.
+    array omega_;           // (rad/ms) stimulus angular frequency per instance.
     array envl_amplitudes_; // (A/m²) stimulus envelope amplitudes, partitioned by instance.
     array envl_times_;      // (A/m²) stimulus envelope timepoints, partitioned by instance.
     iarray envl_divs_;      // Partition divisions for envl_ arrays,
@@ -90,6 +92,22 @@ struct istim_state {
     array accu_stim_;       // (A/m²) accumulated stim current / CV area, one per CV with a stimulus.
     iarray envl_index_;     // Per instance index into envl_ arrays, corresponding to last sample time.
 
+    // Envelope segment per instance, valid for t in [seg_t0_, seg_t1_):
+    // envelope amplitude is seg_J0_ + seg_dJ_·(t-seg_t0_).
+    array seg_t0_;          // (ms) segment start time.
+    array seg_t1_;          // (ms) segment end time.
+    array seg_J0_;          // (A/m²) envelope amplitude at segment start.
+    array seg_dJ_;          // (A/m²/ms) envelope slope over segment.
+
+    // Waveform per instance, updated incrementally from last sample time:
+    array wave_sin_;        // sin(ω·t+φ) at last sample time (1 if ω is zero).
+    array wave_cos_;        // cos(ω·t+φ) at last sample time (0 if ω is zero).
+    array wave_t_;          // (ms) last sample time.
+    iarray wave_steps_;     // Number of incremental updates since last direct evaluation.
+
+    // Per-instance arrays used in the vectorized update are padded to a
+    // multiple of the SIMD width; instance count is envl_index_.size().
+
     // Zero stim current.
     void zero_current();
 
@@ -103,6 +121,10 @@ struct istim_state {
     istim_state(const fvm_stimulus_config& stim_data, unsigned align);
 
     istim_state() = default;
+
+private:
+    // Advance envelope index and recompute segment for instance i at time t.
+    void update_segment(fvm_size_type i, fvm_value_type t);
 };
 
 struct shared_state {
@@ -132,6 +154,9 @@ struct shared_state {
     array time_since_spike;   // Stores time since last spike on any detector, organized by cell.
     iarray src_to_spike;      // Maps spike source index to spike index
 
+    linear_term_array linear_terms; // Terms of linear probes.
+    iarray linear_divs;       // Maps linear probe index to its range of terms.
+
     istim_state stim_data;
     std::unordered_map<std::string, ion_state> ion_data;
     deliverable_event_stream deliverable_events;
@@ -159,6 +184,12 @@ struct shared_state {
 
     void configure_stimulus(const fvm_stimulus_config&);
 
+    // Set terms of linear probes: the value of probe i is the weighted sum
+    // of terms[divs[i]] to terms[divs[i+1]-1].
+    void configure_linear_probes(
+        const std::vector<linear_probe_term>& terms,
+        const std::vector<fvm_index_type>& divs);
+
     void zero_currents();
 
     void ions_init_concentration();
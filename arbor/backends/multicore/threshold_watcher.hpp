@@ -1,8 +1,12 @@
 #pragma once
 
+#include <cmath>
+#include <vector>
+
 #include <arbor/assert.hpp>
 #include <arbor/fvm_types.hpp>
 #include <arbor/math.hpp>
+#include <arbor/simd/simd.hpp>
 
 #include "backends/threshold_crossing.hpp"
 #include "execution_context.hpp"
@@ -12,6 +16,12 @@ namespace arb {
 namespace multicore {
 
 class threshold_watcher {
+    // Detectors are tested with explicit SIMD over detector arrays padded
+    // to a multiple of the SIMD width; padding detectors never cross.
+    static constexpr unsigned simd_width_ = simd::simd_abi::native_width<fvm_value_type>::value;
+    using simd_value_type = simd::simd<fvm_value_type, simd_width_, simd::simd_abi::default_abi>;
+    using simd_index_type = simd::simd<fvm_index_type, simd_width_, simd::simd_abi::default_abi>;
+
 public:
     threshold_watcher() = default;
 
@@ -34,11 +44,17 @@ public:
         t_after_ptr_(t_after),
         n_cv_(cv_index.size()),
         cv_index_(cv_index),
-        is_crossed_(n_cv_),
-        thresholds_(thresholds),
-        v_prev_(values_, values_+n_cv_)
+        thresholds_(thresholds)
     {
         arb_assert(n_cv_==thresholds.size());
+
+        // Padding detectors watch the last CV with an infinite threshold.
+        if (n_cv_) {
+            auto n_pad = math::round_up(n_cv_, simd_width_);
+            cv_index_.resize(n_pad, cv_index_.back());
+            thresholds_.resize(n_pad, INFINITY);
+        }
+        v_prev_.resize(cv_index_.size());
         reset();
     }
 
@@ -53,8 +69,9 @@ public:
     /// calling, because the values are used to determine the initial state
     void reset() {
         clear_crossings();
-        for (fvm_size_type i = 0; i<n_cv_; ++i) {
-            is_crossed_[i] = values_[cv_index_[i]]>=thresholds_[i];
+        last_crossed_.clear();
+        for (fvm_size_type i = 0; i<cv_index_.size(); ++i) {
+            v_prev_[i] = values_[cv_index_[i]];
         }
     }
 
@@ -66,49 +83,56 @@ public:
     /// Crossing events are recorded for each threshold that
     /// is crossed since the last call to test
     void test(array* time_since_spike) {
-        // Reset all spike times to -1.0 indicating no spike has been recorded on the detector
-        const fvm_value_type* t_before = t_before_ptr_->data();
-        const fvm_value_type* t_after  = t_after_ptr_->data();
-        for (fvm_size_type i = 0; i<n_cv_; ++i) {
-            auto cv     = cv_index_[i];
-            auto intdom = cv_to_intdom_[cv];
-            auto v_prev = v_prev_[i];
-            auto v      = values_[cv];
-            auto thresh = thresholds_[i];
-            fvm_index_type spike_idx = 0;
-
-            if (!time_since_spike->empty()) {
-                spike_idx = src_to_spike_[i];
-                (*time_since_spike)[spike_idx] = -1.0;
+        using simd::assign;
+        using simd::indirect;
+
+        // Reset spike times set by the previous test to -1.0, indicating no
+        // spike has been recorded on the detector; all other entries are
+        // already -1.0.
+        const bool record_spikes = !time_since_spike->empty();
+        if (record_spikes) {
+            for (auto i: last_crossed_) {
+                (*time_since_spike)[src_to_spike_[i]] = -1.0;
             }
+        }
+        last_crossed_.clear();
 
-            if (!is_crossed_[i]) {
-                if (v>=thresh) {
-                    // The threshold has been passed, so estimate the time using
-                    // linear interpolation.
-                    auto pos = (thresh - v_prev)/(v - v_prev);
-                    auto crossing_time = math::lerp(t_before[intdom], t_after[intdom], pos);
-                    crossings_.push_back({i, crossing_time});
-
-                    if (!time_since_spike->empty()) {
-                        (*time_since_spike)[spike_idx] = t_after[intdom] - crossing_time;
-                    }
-
-                    is_crossed_[i] = true;
-                }
+        // A detector is in the crossed state exactly when its value at the
+        // previous test was at or above threshold, so only upward crossings
+        // need be found. These are found for all detectors lane-wise, and
+        // crossing times are interpolated only for the lanes that crossed.
+        const fvm_value_type* t_before = t_before_ptr_->data();
+        const fvm_value_type* t_after  = t_after_ptr_->data();
+        const fvm_size_type n_pad = cv_index_.size();
+
+        for (fvm_size_type i = 0; i<n_pad; i+=simd_width_) {
+            simd_index_type cv;
+            simd_value_type v, v_prev, thresh;
+            assign(cv, indirect(cv_index_.data()+i, simd_width_));
+            assign(v, indirect(values_, cv, simd_width_));
+            assign(v_prev, indirect(v_prev_.data()+i, simd_width_));
+            assign(thresh, indirect(thresholds_.data()+i, simd_width_));
+
+            bool crossed[simd_width_];
+            simd::logical_and(v>=thresh, v_prev<thresh).copy_to(crossed);
+
+            bool any_crossed = false;
+            for (unsigned lane = 0; lane<simd_width_; ++lane) {
+                any_crossed |= crossed[lane];
             }
-            else {
-                if (v<thresh) {
-                    is_crossed_[i] = false;
+            if (any_crossed) {
+                for (unsigned lane = 0; lane<simd_width_; ++lane) {
+                    if (!crossed[lane]) continue;
+                    record_crossing(i+lane, t_before, t_after, time_since_spike);
                 }
             }
 
-            v_prev_[i] = v;
+            indirect(v_prev_.data()+i, simd_width_) = v;
         }
     }
 
     bool is_crossed(fvm_size_type i) const {
-        return is_crossed_[i];
+        return v_prev_[i]>=thresholds_[i];
     }
 
     /// The number of threshold values that are monitored.
@@ -117,6 +141,26 @@ public:
     }
 
 private:
+    // Record upward crossing on detector i, before v_prev_[i] is updated.
+    void record_crossing(fvm_size_type i, const fvm_value_type* t_before, const fvm_value_type* t_after, array* time_since_spike) {
+        auto cv     = cv_index_[i];
+        auto intdom = cv_to_intdom_[cv];
+        auto v_prev = v_prev_[i];
+        auto v      = values_[cv];
+        auto thresh = thresholds_[i];
+
+        // The threshold has been passed, so estimate the time using
+        // linear interpolation.
+        auto pos = (thresh - v_prev)/(v - v_prev);
+        auto crossing_time = math::lerp(t_before[intdom], t_after[intdom], pos);
+        crossings_.push_back({i, crossing_time});
+
+        if (!time_since_spike->empty()) {
+            (*time_since_spike)[src_to_spike_[i]] = t_after[intdom] - crossing_time;
+            last_crossed_.push_back(i);
+        }
+    }
+
     /// Non-owning pointers to cv-to-intdom map,
     /// the values for to test against thresholds,
     /// and pointers to the time arrays
@@ -126,13 +170,13 @@ private:
     const array* t_before_ptr_ = nullptr;
     const array* t_after_ptr_ = nullptr;
 
-    /// Threshold watcher state.
+    /// Threshold watcher state; detector arrays are padded.
     fvm_size_type n_cv_ = 0;
     std::vector<fvm_index_type> cv_index_;
-    std::vector<fvm_size_type> is_crossed_;
     std::vector<fvm_value_type> thresholds_;
     std::vector<fvm_value_type> v_prev_;
     std::vector<threshold_crossing> crossings_;
+    std::vector<fvm_size_type> last_crossed_; // Detectors crossed in last test.
 };
 
 } // namespace multicore
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <exception>
 
 #include <arbor/arbexcept.hpp>
@@ -11,10 +13,15 @@
 #include "label_resolution.hpp"
 #include "profile/profiler_macro.hpp"
 
+#include "util/rangeutil.hpp"
 #include "util/span.hpp"
 
 namespace arb {
 
+namespace {
+constexpr std::size_t cache_line_bytes = 64;
+}
+
 benchmark_cell_group::benchmark_cell_group(const std::vector<cell_gid_type>& gids,
                                            const recipe& rec,
                                            cell_label_range& cg_sources,
@@ -32,6 +39,16 @@ benchmark_cell_group::benchmark_cell_group(const std::vector<cell_gid_type>& gid
         cells_.push_back(util::any_cast<benchmark_cell>(rec.get_cell_description(gid)));
     }
 
+    state_.reserve(gids_.size());
+    for (const auto& c: cells_) {
+        // Working set defaults to the bytes streamed per step if unspecified.
+        // A smaller working set is reused within a step, down to one cache line.
+        std::size_t ws = c.cost.working_set_bytes? c.cost.working_set_bytes: c.cost.bytes_per_step;
+        if (ws) ws = std::max<std::size_t>(ws, cache_line_bytes);
+        state_.emplace_back(ws/sizeof(double), 0.);
+    }
+    state_pos_.assign(gids_.size(), 0);
+
     for (const auto& c: cells_) {
         cg_sources.add_cell();
         cg_targets.add_cell();
@@ -46,6 +63,10 @@ void benchmark_cell_group::reset() {
     for (auto& c: cells_) {
         c.time_sequence.reset();
     }
+    for (auto& x: state_) {
+        util::fill(x, 0.);
+    }
+    util::fill(state_pos_, 0);
 
     clear_spikes();
 }
@@ -64,10 +85,16 @@ void benchmark_cell_group::advance(epoch ep,
     PE(advance_bench_cell);
     // Micro-seconds to advance in this epoch.
     auto us = 1e3*(ep.duration());
+    // Number of time steps taken in this epoch.
+    const auto n_steps = dt>0? (std::size_t)std::ceil(ep.duration()/dt): 0;
+
     for (auto i: util::make_span(0, gids_.size())) {
-        // Expected time to complete epoch in micro seconds.
-        const double duration_us = cells_[i].realtime_ratio*us;
+        const auto& cost = cells_[i].cost;
         const auto gid = gids_[i];
+        const auto n_events = event_lanes.size()? event_lanes[i].size(): 0;
+
+        // Expected time to complete epoch in micro seconds.
+        const double duration_us = cells_[i].realtime_ratio*us + cost.event_cost_us*n_events;
 
         // Start timer.
         auto start = high_resolution_clock::now();
@@ -77,15 +104,40 @@ void benchmark_cell_group::advance(epoch ep,
             spikes_.push_back({{gid, 0u}, t});
         }
 
+        // Emulate the memory traffic of the cell state update, one step at a time.
+        if (!state_[i].empty()) {
+            const std::size_t n_per_step = cost.bytes_per_step/sizeof(double);
+            for (std::size_t k = 0; k<n_steps; ++k) {
+                stream_state(i, n_per_step);
+            }
+        }
+
         // Wait until the expected time to advance has elapsed. Use a busy-wait
         // so that the resources of this thread are tied up until the interval
-        // has elapsed, to emulate a "real" cell.
+        // has elapsed, to emulate a "real" cell. Time spent streaming state
+        // above counts towards this interval.
         while (duration_type(high_resolution_clock::now()-start).count() < duration_us);
     }
 
     PL();
 };
 
+void benchmark_cell_group::stream_state(std::size_t i, std::size_t n) {
+    auto& x = state_[i];
+    auto& pos = state_pos_[i];
+    const std::size_t size = x.size();
+
+    while (n) {
+        std::size_t m = std::min(n, size-pos);
+        double* p = x.data()+pos;
+        for (std::size_t j = 0; j<m; ++j) {
+            p[j] = 0.5*p[j]+0.5;
+        }
+        n -= m;
+        pos = pos+m==size? 0: pos+m;
+    }
+}
+
 const std::vector<spike>& benchmark_cell_group::spikes() const {
     return spikes_;
 }
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <vector>
+
 #include <arbor/benchmark_cell.hpp>
 #include <arbor/common_types.hpp>
 #include <arbor/recipe.hpp>
@@ -34,10 +37,22 @@ public:
 
     void remove_all_samplers() override {}
 
+    // Emulated state of the i-th cell in the group; elements are non-zero
+    // once they have been streamed.
+    const std::vector<double>& cell_state(std::size_t i) const { return state_[i]; }
+
 private:
     std::vector<benchmark_cell> cells_;
     std::vector<spike> spikes_;
     std::vector<cell_gid_type> gids_;
+
+    // Emulated per-cell state for cells with a memory cost profile,
+    // and the position in that state at which streaming resumes.
+    std::vector<std::vector<double>> state_;
+    std::vector<std::size_t> state_pos_;
+
+    // Read and write n elements of the state of cell i, cycling over its working set.
+    void stream_state(std::size_t i, std::size_t n);
 };
 
 } // namespace arb
@@ -44,6 +44,11 @@ public:
     virtual void remove_sampler(sampler_association_handle) = 0;
     virtual void remove_all_samplers() = 0;
 
+    // Cell groups that do not support bulk or reduced sampling ignore such sampler associations.
+
+    virtual void add_bulk_sampler(sampler_association_handle, cell_member_predicate, schedule, bulk_sampler_function, sampling_policy) {}
+    virtual void add_reduced_sampler(sampler_association_handle, cell_member_predicate, schedule, sampler_function, sample_reducer, sampling_policy) {}
+
     // Probe metadata queries might also be called while a simulation is running, and so should
     // also be thread-safe.
 
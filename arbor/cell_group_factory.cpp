@@ -33,8 +33,8 @@ cell_group_factory cell_kind_implementation(
     case cell_kind::spike_source:
         if (bk!=backend_kind::multicore) break;
 
-        return [](const gid_vector& gids, const recipe& rec, cell_label_range& cg_sources, cell_label_range& cg_targets) {
-            return make_cell_group<spike_source_cell_group>(gids, rec, cg_sources, cg_targets);
+        return [ctx](const gid_vector& gids, const recipe& rec, cell_label_range& cg_sources, cell_label_range& cg_targets) {
+            return make_cell_group<spike_source_cell_group>(gids, rec, cg_sources, cg_targets, ctx.thread_pool);
         };
 
     case cell_kind::lif:
@@ -130,10 +130,11 @@ std::pair<cell_size_type, cell_size_type> communicator::group_queue_range(cell_s
 }
 
 time_type communicator::min_delay() {
-    auto local_min = std::numeric_limits<time_type>::max();
-    for (auto& con : connections_) {
-        local_min = std::min(local_min, con.delay());
-    }
+    auto local_min = threading::parallel_reduce::apply(0, connections_.size(), thread_pool_.get(),
+        std::numeric_limits<time_type>::max(),
+        [&](int i) { return connections_[i].delay(); },
+        [](time_type a, time_type b) { return std::min(a, b); },
+        1024);
 
     return distributed_->min(local_min);
 }
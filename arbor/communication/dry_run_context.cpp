@@ -89,6 +89,11 @@ struct dry_run_context_impl {
         return std::vector<T>(num_ranks_, value);
     }
 
+    template <typename T>
+    std::vector<T> gather_all(T value) const {
+        return std::vector<T>(num_ranks_, value);
+    }
+
     int id() const { return 0; }
 
     int size() const { return num_ranks_; }
@@ -102,6 +107,12 @@ struct dry_run_context_impl {
     template <typename T>
     T sum(T value) const { return value * num_ranks_; }
 
+    template <typename T>
+    std::vector<T> sum(std::vector<T> values) const {
+        for (auto& v: values) v *= num_ranks_;
+        return values;
+    }
+
     void barrier() const {}
 
     std::string name() const { return "dryrun"; }
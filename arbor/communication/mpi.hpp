@@ -249,6 +249,21 @@ T reduce(T value, MPI_Op op, MPI_Comm comm) {
     return result;
 }
 
+// Element-wise reduction over all ranks of vectors of equal length.
+template <typename T>
+std::vector<T> reduce(const std::vector<T>& values, MPI_Op op, MPI_Comm comm) {
+    using traits = mpi_traits<T>;
+    static_assert(traits::is_mpi_native_type(),
+                  "can only perform reductions on MPI native types");
+
+    std::vector<T> result(values.size());
+
+    MPI_OR_THROW(MPI_Allreduce,
+        values.data(), result.data(), values.size(), traits::mpi_type(), op, comm);
+
+    return result;
+}
+
 template <typename T>
 std::pair<T,T> minmax(T value) {
     return {reduce<T>(value, MPI_MIN), reduce<T>(value, MPI_MAX)};
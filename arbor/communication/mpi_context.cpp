@@ -61,6 +61,11 @@ struct mpi_context_impl {
         return mpi::gather(value, root, comm_);
     }
 
+    template <typename T>
+    std::vector<T> gather_all(T value) const {
+        return mpi::gather_all(value, comm_);
+    }
+
     std::string name() const { return "MPI"; }
     int id() const { return rank_; }
     int size() const { return size_; }
@@ -80,6 +85,11 @@ struct mpi_context_impl {
         return mpi::reduce(value, MPI_SUM, comm_);
     }
 
+    template <typename T>
+    std::vector<T> sum(std::vector<T> values) const {
+        return mpi::reduce(values, MPI_SUM, comm_);
+    }
+
     void barrier() const {
         mpi::barrier(comm_);
     }
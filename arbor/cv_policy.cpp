@@ -85,7 +85,7 @@ locset cv_policy_explicit::cv_boundary_points(const cable_cell& cell) const {
                     return sum(std::move(l), ls::restrict(locs_, comp));
                 },
                 ls::boundary(domain_),
-                components(cell.morphology(), thingify(domain_, cell.provider()))));
+                components(cell.morphology(), cell.provider().concrete_region(domain_))));
 }
 
 cv_policy_base_ptr cv_policy_explicit::clone() const {
@@ -113,7 +113,7 @@ locset cv_policy_max_extent::cv_boundary_points(const cable_cell& cell) const {
 
     std::vector<mlocation> points;
     double oomax_extent = 1./max_extent_;
-    auto comps = components(cell.morphology(), thingify(domain_, cell.provider()));
+    auto comps = components(cell.morphology(), cell.provider().concrete_region(domain_));
 
     for (auto& comp: comps) {
         for (mcable c: comp) {
@@ -152,7 +152,7 @@ locset cv_policy_fixed_per_branch::cv_boundary_points(const cable_cell& cell) co
 
     std::vector<mlocation> points;
     double ooncv = 1./cv_per_branch_;
-    auto comps = components(cell.morphology(), thingify(domain_, cell.provider()));
+    auto comps = components(cell.morphology(), cell.provider().concrete_region(domain_));
 
     for (auto& comp: comps) {
         for (mcable c: comp) {
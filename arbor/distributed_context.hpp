@@ -15,19 +15,25 @@ namespace arb {
     T min(T value) const { return impl_->min(value); }\
     T max(T value) const { return impl_->max(value); }\
     T sum(T value) const { return impl_->sum(value); }\
-    std::vector<T> gather(T value, int root) const { return impl_->gather(value, root); }
+    std::vector<T> sum(std::vector<T> values) const { return impl_->sum(std::move(values)); }\
+    std::vector<T> gather(T value, int root) const { return impl_->gather(value, root); }\
+    std::vector<T> gather_all(T value) const { return impl_->gather_all(value); }
 
 #define ARB_INTERFACE_COLLECTIVES_(T) \
     virtual T min(T value) const = 0;\
     virtual T max(T value) const = 0;\
     virtual T sum(T value) const = 0;\
-    virtual std::vector<T> gather(T value, int root) const = 0;
+    virtual std::vector<T> sum(std::vector<T> values) const = 0;\
+    virtual std::vector<T> gather(T value, int root) const = 0;\
+    virtual std::vector<T> gather_all(T value) const = 0;
 
 #define ARB_WRAP_COLLECTIVES_(T) \
     T min(T value) const override { return wrapped.min(value); }\
     T max(T value) const override { return wrapped.max(value); }\
     T sum(T value) const override { return wrapped.sum(value); }\
-    std::vector<T> gather(T value, int root) const override { return wrapped.gather(value, root); }
+    std::vector<T> sum(std::vector<T> values) const override { return wrapped.sum(std::move(values)); }\
+    std::vector<T> gather(T value, int root) const override { return wrapped.gather(value, root); }\
+    std::vector<T> gather_all(T value) const override { return wrapped.gather_all(value); }
 
 #define ARB_COLLECTIVE_TYPES_ float, double, int, unsigned, long, unsigned long, long long, unsigned long long
 
@@ -191,6 +197,10 @@ struct local_context {
     std::vector<T> gather(T value, int) const {
         return {std::move(value)};
     }
+    template <typename T>
+    std::vector<T> gather_all(T value) const {
+        return {std::move(value)};
+    }
 
     int id() const { return 0; }
 
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <arbor/common_types.hpp>
+
+namespace arb {
+
+// Divide cells among domains in contiguous ranges of gids of near equal total
+// cost, where each domain holds the costs of the cells [first, first+local_costs.size())
+// in a contiguous division of all cells, and domain_totals holds the total
+// of the costs held by each domain. A cell is assigned to the domain in whose
+// share of the total cost the midpoint of its cost lies.
+//
+// Returns the first gid of each domain other than the first whose share
+// starts in the local costs: concatenated in domain order, the divisions
+// found by every domain give the first gid of domains 1, 2, ... in turn.
+std::vector<cell_gid_type> local_cost_divisions(
+    const std::vector<double>& domain_totals,
+    unsigned domain_id,
+    const std::vector<double>& local_costs,
+    cell_gid_type first);
+
+// The part of the graph of connections and gap junctions between cells held
+// by a domain, for the cells [first, first+n) in a contiguous division of
+// all cells. Cells connected by gap junctions within the domain are
+// contracted to the cell of smallest gid among them, and connections that
+// are repeated after contraction are merged into one edge.
+struct local_cell_graph {
+    // Gid of the cell to which each local cell is contracted.
+    std::vector<cell_gid_type> roots;
+    // Connections between contracted cells (source[k], target[k]), where
+    // weight[k] is the number of connections merged; sources outside the
+    // domain are not contracted.
+    std::vector<cell_gid_type> source, target, weight;
+    // Gap junctions (peer[k], cell[k]) with peers outside the domain.
+    std::vector<cell_gid_type> peer, cell;
+
+    // Number of edges to be gathered from the domain.
+    std::size_t num_edges() const { return source.size()+peer.size(); }
+};
+
+// Build the local graph from the sources of the connections on, and the gap
+// junction peers of, each local cell.
+local_cell_graph make_local_cell_graph(
+    cell_gid_type first,
+    const std::vector<std::vector<cell_gid_type>>& sources,
+    const std::vector<std::vector<cell_gid_type>>& peers);
+
+// Divide all cells among num_domains domains by partitioning the graph
+// gathered from the local graphs of every domain, concatenated in domain
+// order, with the given weight for each cell. Cells connected by gap
+// junctions are assigned the same domain. Returns the domain of each cell.
+std::vector<int> partition_cell_graph(
+    const std::vector<cell_gid_type>& weights,
+    const local_cell_graph& gathered,
+    unsigned num_domains);
+
+} // namespace arb
@@ -20,7 +20,7 @@ void execution_context_deleter::operator()(execution_context* p) const {
 
 execution_context::execution_context(const proc_allocation& resources):
     distributed(make_local_context()),
-    thread_pool(std::make_shared<threading::task_system>(resources.num_threads)),
+    thread_pool(std::make_shared<threading::task_system>(resources.num_threads, resources.thread_affinity)),
     gpu(resources.has_gpu()? std::make_shared<gpu_context>(resources.gpu_id)
                            : std::make_shared<gpu_context>())
 {}
@@ -33,7 +33,7 @@ context make_context(const proc_allocation& p) {
 template <>
 execution_context::execution_context(const proc_allocation& resources, MPI_Comm comm):
     distributed(make_mpi_context(comm)),
-    thread_pool(std::make_shared<threading::task_system>(resources.num_threads)),
+    thread_pool(std::make_shared<threading::task_system>(resources.num_threads, resources.thread_affinity)),
     gpu(resources.has_gpu()? std::make_shared<gpu_context>(resources.gpu_id)
                            : std::make_shared<gpu_context>())
 {}
@@ -48,7 +48,7 @@ execution_context::execution_context(
         const proc_allocation& resources,
         dry_run_info d):
         distributed(make_dry_run_context(d.num_ranks, d.num_cells_per_rank)),
-        thread_pool(std::make_shared<threading::task_system>(resources.num_threads)),
+        thread_pool(std::make_shared<threading::task_system>(resources.num_threads, resources.thread_affinity)),
         gpu(resources.has_gpu()? std::make_shared<gpu_context>(resources.gpu_id)
                                : std::make_shared<gpu_context>())
 {}
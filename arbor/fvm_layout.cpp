@@ -1,7 +1,11 @@
 #include <algorithm>
+#include <cstdint>
 #include <optional>
 #include <set>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
@@ -131,6 +135,10 @@ pw_elements<U> pw_over_cable(const mcable_map<T>& mm, mcable cable, U dflt_value
 // Construct cv_geometry for cell from locset describing CV boundary points.
 
 cv_geometry cv_geometry_from_ends(const cable_cell& cell, const locset& lset) {
+    return cv_geometry_from_ends(cell, cell.provider().concrete_locset(lset));
+}
+
+cv_geometry cv_geometry_from_ends(const cable_cell& cell, mlocation_list locs) {
     auto pop = [](auto& vec) { auto h = vec.back(); return vec.pop_back(), h; };
 
     cv_geometry geom;
@@ -142,8 +150,6 @@ cv_geometry cv_geometry_from_ends(const cable_cell& cell, const locset& lset) {
         return geom;
     }
 
-    mlocation_list locs = thingify(lset, mp);
-
     // Filter out root, terminal locations and repeated locations so as to
     // avoid trivial CVs outside of fork points. (This is not necessary for
     // correctness, but is for the convenience of specification by lset.)
@@ -283,6 +289,47 @@ namespace impl {
         }
     };
 
+    // Concatenate the sequences field(0), ..., field(n-1) in parallel, with
+    // each element x of field(i) replaced by f(i, x).
+    template <typename Field, typename F>
+    auto concat(std::size_t n, Field field, F f, threading::task_system* ts) {
+        using value_type = std::decay_t<decltype(f(std::size_t(0), *begin(field(std::size_t(0)))))>;
+
+        std::vector<std::size_t> offset(n+1, 0);
+        for (std::size_t i = 0; i<n; ++i) offset[i+1] = offset[i]+std::size(field(i));
+
+        std::vector<value_type> out(offset.back());
+        threading::parallel_for::apply(0, n, ts,
+            [&](int i) {
+                auto o = offset[i];
+                for (const auto& x: field(i)) out[o++] = f(i, x);
+            });
+        return out;
+    }
+
+    template <typename Field>
+    auto concat(std::size_t n, Field field, threading::task_system* ts) {
+        return concat(n, field, [](std::size_t, const auto& x) { return x; }, ts);
+    }
+
+    // Concatenate partition divisions as append_divs, in parallel.
+    template <typename Field>
+    auto concat_divs(std::size_t n, Field field, threading::task_system* ts) {
+        using value_type = std::decay_t<decltype(*begin(field(std::size_t(0))))>;
+
+        std::vector<value_type> base(n+1, 0);
+        for (std::size_t i = 0; i<n; ++i) {
+            const auto& divs = field(i);
+            base[i+1] = base[i]+(divs.empty()? 0: divs.back());
+        }
+
+        auto divs = concat(n,
+            [&](std::size_t i) { const auto& d = field(i); return d.empty()? util::make_range(d.end(), d.end()): tail(d); },
+            [&](std::size_t i, value_type x) { return x+base[i]; },
+            ts);
+        if (!divs.empty()) divs.insert(divs.begin(), value_type(0));
+        return divs;
+    }
 }
 
 // Merge CV geometry lists in-place.
@@ -324,6 +371,15 @@ cv_geometry& append(cv_geometry& geom, const cv_geometry& right) {
 fvm_cv_discretization& append(fvm_cv_discretization& dczn, const fvm_cv_discretization& right) {
     using util::append;
 
+    // Cell templates are kept only if known for both.
+    const fvm_size_type n_cell = dczn.geometry.n_cell();
+    if (dczn.cell_template.size()==n_cell && right.cell_template.size()==right.geometry.n_cell()) {
+        for (auto t: right.cell_template) dczn.cell_template.push_back(t+n_cell);
+    }
+    else {
+        dczn.cell_template.clear();
+    }
+
     append(dczn.geometry, right.geometry);
 
     append(dczn.face_conductance, right.face_conductance);
@@ -339,6 +395,195 @@ fvm_cv_discretization& append(fvm_cv_discretization& dczn, const fvm_cv_discreti
 }
 
 
+// Cell templates
+// --------------
+//
+// Cells built from the same morphology and decorations have the same
+// discretization and mechanism data, up to the offsets of their CV and target
+// indices. Cells are compared by a structural key: the concrete data from which
+// these are built, written as bytes. Keys are first compared by hash, without
+// storing them, and matches confirmed by comparing the keys in full.
+
+namespace {
+struct key_hash_sink {
+    std::uint64_t hash = 0xcbf29ce484222325ull; // 64-bit FNV-1a.
+
+    void append(const char* p, std::size_t n) {
+        for (std::size_t i = 0; i<n; ++i) {
+            hash = (hash^(unsigned char)p[i])*0x100000001b3ull;
+        }
+    }
+};
+
+struct key_string_sink {
+    std::string key;
+
+    void append(const char* p, std::size_t n) { key.append(p, n); }
+};
+
+template <typename Sink>
+struct key_writer {
+    Sink& sink;
+
+    template <typename T, typename = std::enable_if_t<std::is_arithmetic<T>::value>>
+    void operator()(T x) { sink.append(reinterpret_cast<const char*>(&x), sizeof(x)); }
+
+    void operator()(const std::string& s) { (*this)(s.size()); sink.append(s.data(), s.size()); }
+    void operator()(const std::optional<double>& x) { (*this)(bool(x)); if (x) (*this)(*x); }
+
+    void operator()(const mpoint& p) { (*this)(p.x); (*this)(p.y); (*this)(p.z); (*this)(p.radius); }
+    void operator()(const mlocation& l) { (*this)(l.branch); (*this)(l.pos); }
+    void operator()(const mcable& c) { (*this)(c.branch); (*this)(c.prox_pos); (*this)(c.dist_pos); }
+
+    void operator()(const mechanism_desc& m) {
+        (*this)(m.name());
+        std::vector<std::pair<std::string, double>> values(m.values().begin(), m.values().end());
+        util::sort(values);
+        (*this)(values.size());
+        for (const auto& v: values) { (*this)(v.first); (*this)(v.second); }
+    }
+
+    void operator()(const init_membrane_potential& x) { (*this)(x.value); }
+    void operator()(const axial_resistivity& x) { (*this)(x.value); }
+    void operator()(const temperature_K& x) { (*this)(x.value); }
+    void operator()(const membrane_capacitance& x) { (*this)(x.value); }
+    void operator()(const init_int_concentration& x) { (*this)(x.ion); (*this)(x.value); }
+    void operator()(const init_ext_concentration& x) { (*this)(x.ion); (*this)(x.value); }
+    void operator()(const init_reversal_potential& x) { (*this)(x.ion); (*this)(x.value); }
+    void operator()(const threshold_detector& x) { (*this)(x.threshold); }
+    void operator()(const gap_junction_site&) {}
+
+    void operator()(const i_clamp& x) {
+        (*this)(x.envelope.size());
+        for (const auto& p: x.envelope) { (*this)(p.t); (*this)(p.amplitude); }
+        (*this)(x.frequency);
+        (*this)(x.phase);
+    }
+
+    void operator()(const cable_cell_ion_data& x) {
+        (*this)(x.init_int_concentration);
+        (*this)(x.init_ext_concentration);
+        (*this)(x.init_reversal_potential);
+    }
+
+    template <typename T>
+    void operator()(const mcable_map<T>& m) {
+        (*this)(m.size());
+        for (const auto& [cable, value]: m) { (*this)(cable); (*this)(value); }
+    }
+
+    template <typename T>
+    void operator()(const mlocation_map<T>& m) {
+        (*this)(m.size());
+        for (const auto& p: m) { (*this)(p.loc); (*this)(p.lid); (*this)(p.item); }
+    }
+
+    // Maps are written in key order.
+    template <typename T>
+    void operator()(const std::unordered_map<std::string, T>& m) {
+        std::vector<const std::string*> keys;
+        for (const auto& kv: m) keys.push_back(&kv.first);
+        util::sort_by(keys, [](const std::string* k) { return *k; });
+        (*this)(keys.size());
+        for (auto k: keys) { (*this)(*k); (*this)(m.at(*k)); }
+    }
+};
+
+// The CV boundary points of a policy are evaluated once for the cells built
+// on copies of one morphology with the same label dictionary.
+mlocation_list cv_boundary_points(const cable_cell& cell, const cable_cell_parameter_set& global_dflt) {
+    const auto& dflt = cell.default_parameters();
+    const auto& mp = cell.provider();
+    return dflt.discretization? mp.concrete_cv_boundary_points(*dflt.discretization, cell):
+           global_dflt.discretization? mp.concrete_cv_boundary_points(*global_dflt.discretization, cell):
+           mp.concrete_cv_boundary_points(default_cv_policy(), cell);
+}
+
+template <typename Sink>
+void write_cell_key(Sink& sink, const cable_cell& cell, const cable_cell_parameter_set& global_dflt) {
+    key_writer<Sink> w{sink};
+
+    const auto& m = cell.morphology();
+    w(m.num_branches());
+    for (msize_t b = 0; b<m.num_branches(); ++b) {
+        w(m.branch_parent(b));
+        const auto& segments = m.branch_segments(b);
+        w(segments.size());
+        for (const auto& seg: segments) { w(seg.prox); w(seg.dist); w(seg.tag); }
+    }
+
+    auto boundary = cv_boundary_points(cell, global_dflt);
+    w(boundary.size());
+    for (const auto& l: boundary) w(l);
+
+    const auto& R = cell.region_assignments();
+    w(R.get<mechanism_desc>());
+    w(R.get<init_membrane_potential>());
+    w(R.get<axial_resistivity>());
+    w(R.get<temperature_K>());
+    w(R.get<membrane_capacitance>());
+    w(R.get<init_int_concentration>());
+    w(R.get<init_ext_concentration>());
+    w(R.get<init_reversal_potential>());
+
+    const auto& L = cell.location_assignments();
+    w(L.get<mechanism_desc>());
+    w(L.get<i_clamp>());
+    w(L.get<gap_junction_site>());
+    w(L.get<threshold_detector>());
+
+    const auto& dflt = cell.default_parameters();
+    w(dflt.init_membrane_potential);
+    w(dflt.temperature_K);
+    w(dflt.axial_resistivity);
+    w(dflt.membrane_capacitance);
+    w(dflt.ion_data);
+    w(dflt.reversal_potential_method);
+}
+
+// For each cell, the index of the first cell with the same key.
+std::vector<fvm_size_type> cell_templates(const std::vector<cable_cell>& cells,
+    const cable_cell_parameter_set& global_dflt, threading::task_system* ts)
+{
+    const std::size_t n = cells.size();
+    std::vector<std::uint64_t> hashes(n);
+    threading::parallel_for::apply(0, n, ts,
+        [&](int i) {
+            key_hash_sink sink;
+            write_cell_key(sink, cells[i], global_dflt);
+            hashes[i] = sink.hash;
+        });
+
+    auto key = [&](std::size_t i) {
+        key_string_sink sink;
+        write_cell_key(sink, cells[i], global_dflt);
+        return std::move(sink.key);
+    };
+
+    // Cells with the hash of an earlier cell are candidates for that cell's
+    // template, confirmed by comparing keys.
+    std::vector<fvm_size_type> templ(n);
+    std::unordered_map<std::uint64_t, fvm_size_type> first;
+    std::vector<std::size_t> candidates;
+    for (std::size_t i = 0; i<n; ++i) {
+        auto [it, inserted] = first.emplace(hashes[i], i);
+        templ[i] = it->second;
+        if (!inserted) candidates.push_back(i);
+    }
+
+    std::unordered_map<fvm_size_type, std::string> template_keys;
+    for (auto i: candidates) template_keys[templ[i]];
+    for (auto& kv: template_keys) kv.second = key(kv.first);
+
+    threading::parallel_for::apply(0, candidates.size(), ts,
+        [&](int k) {
+            auto i = candidates[k];
+            if (key(i)!=template_keys.at(templ[i])) templ[i] = i;
+        });
+    return templ;
+}
+} // anonymous namespace
+
 // FVM discretization
 // ------------------
 
@@ -346,10 +591,7 @@ fvm_cv_discretization fvm_cv_discretize(const cable_cell& cell, const cable_cell
     const auto& dflt = cell.default_parameters();
     fvm_cv_discretization D;
 
-    D.geometry = cv_geometry_from_ends(cell,
-        dflt.discretization? dflt.discretization->cv_boundary_points(cell):
-        global_dflt.discretization? global_dflt.discretization->cv_boundary_points(cell):
-        default_cv_policy().cv_boundary_points(cell));
+    D.geometry = cv_geometry_from_ends(cell, cv_boundary_points(cell, global_dflt));
 
     if (D.geometry.empty()) return D;
 
@@ -467,14 +709,49 @@ fvm_cv_discretization fvm_cv_discretize(const std::vector<cable_cell>& cells,
     const cable_cell_parameter_set& global_defaults,
     const arb::execution_context& ctx)
 {
-    std::vector<fvm_cv_discretization> cell_disc(cells.size());
-    threading::parallel_for::apply(0, cells.size(), ctx.thread_pool.get(),
-          [&] (int i) { cell_disc[i]=fvm_cv_discretize(cells[i], global_defaults);});
+    auto ts = ctx.thread_pool.get();
+    const std::size_t n = cells.size();
+
+    // Only the first cell of each template is discretized.
+    auto templ = cell_templates(cells, global_defaults, ts);
+    std::vector<fvm_cv_discretization> templ_disc(n);
+    threading::parallel_for::apply(0, n, ts,
+          [&] (int i) { if (templ[i]==fvm_size_type(i)) templ_disc[i]=fvm_cv_discretize(cells[i], global_defaults);});
+
+    // Concatenate the discretizations in parallel, shifting CV and cell indices.
+    auto disc = [&](std::size_t i) -> const fvm_cv_discretization& { return templ_disc[templ[i]]; };
+    auto geom = [&](std::size_t i) -> const cv_geometry& { return disc(i).geometry; };
+
+    // Offsets of the CV and cell indices of each cell.
+    std::vector<fvm_index_type> cv_base(n+1, 0), cell_base(n+1, 0);
+    for (std::size_t i = 0; i<n; ++i) {
+        cv_base[i+1] = cv_base[i]+geom(i).size();
+        cell_base[i+1] = cell_base[i]+geom(i).n_cell();
+    }
+    auto shift_cv = [&](std::size_t i, fvm_index_type x) { return x+1==0? x: x+cv_base[i]; };
+    auto shift_cell = [&](std::size_t i, fvm_index_type x) { return x+1==0? x: x+cell_base[i]; };
 
     fvm_cv_discretization combined;
-    for (auto cell_idx: count_along(cells)) {
-        append(combined, cell_disc[cell_idx]);
-    }
+    cv_geometry& G = combined.geometry;
+    G.cv_cables = impl::concat(n, [&](std::size_t i) -> auto& { return geom(i).cv_cables; }, ts);
+    G.cv_cables_divs = impl::concat_divs(n, [&](std::size_t i) -> auto& { return geom(i).cv_cables_divs; }, ts);
+    G.cv_parent = impl::concat(n, [&](std::size_t i) -> auto& { return geom(i).cv_parent; }, shift_cv, ts);
+    G.cv_children = impl::concat(n, [&](std::size_t i) -> auto& { return geom(i).cv_children; }, shift_cv, ts);
+    G.cv_children_divs = impl::concat_divs(n, [&](std::size_t i) -> auto& { return geom(i).cv_children_divs; }, ts);
+    G.cv_to_cell = impl::concat(n, [&](std::size_t i) -> auto& { return geom(i).cv_to_cell; }, shift_cell, ts);
+    G.cell_cv_divs = impl::concat_divs(n, [&](std::size_t i) -> auto& { return geom(i).cell_cv_divs; }, ts);
+    G.branch_cv_map = impl::concat(n, [&](std::size_t i) -> auto& { return geom(i).branch_cv_map; }, ts);
+
+    combined.face_conductance = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).face_conductance; }, ts);
+    combined.cv_area = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).cv_area; }, ts);
+    combined.cv_capacitance = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).cv_capacitance; }, ts);
+    combined.init_membrane_potential = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).init_membrane_potential; }, ts);
+    combined.temperature_K = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).temperature_K; }, ts);
+    combined.diam_um = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).diam_um; }, ts);
+    combined.axial_resistivity = impl::concat(n, [&](std::size_t i) -> auto& { return disc(i).axial_resistivity; }, ts);
+
+    combined.cell_template = std::move(templ);
+
     return combined;
 }
 
@@ -703,86 +980,110 @@ fvm_voltage_interpolant fvm_axial_current(const cable_cell& cell, const fvm_cv_d
 // FVM mechanism data
 // ------------------
 
-// CVs are absolute (taken from combined discretization) so do not need to be shifted.
-// Only target numbers need to be shifted.
+fvm_mechanism_data fvm_build_mechanism_data(const cable_cell_global_properties& gprop,
+    const cable_cell& cell, const fvm_cv_discretization& D, fvm_size_type cell_idx);
 
-fvm_mechanism_data& append(fvm_mechanism_data& left, const fvm_mechanism_data& right) {
-    using util::append;
-    using impl::append_offset;
-    using impl::append_divs;
+fvm_mechanism_data fvm_build_mechanism_data(const cable_cell_global_properties& gprop,
+    const std::vector<cable_cell>& cells, const fvm_cv_discretization& D, const execution_context& ctx)
+{
+    auto ts = ctx.thread_pool.get();
+    const std::size_t n = cells.size();
+
+    // With cell templates, only the first cell of each template is built, and
+    // the others take its data with CV indices shifted to their own CVs.
+    std::vector<fvm_size_type> templ(n);
+    if (D.cell_template.size()==n) {
+        templ = D.cell_template;
+    }
+    else {
+        for (std::size_t i = 0; i<n; ++i) templ[i] = i;
+    }
 
-    fvm_size_type target_offset = left.n_target;
+    std::vector<fvm_mechanism_data> templ_mech(n);
+    threading::parallel_for::apply(0, n, ts,
+          [&] (int i) { if (templ[i]==fvm_size_type(i)) templ_mech[i]=fvm_build_mechanism_data(gprop, cells[i], D, i);});
 
-    for (const auto& kv: right.ions) {
-        fvm_ion_config& L = left.ions[kv.first];
-        const fvm_ion_config& R = kv.second;
+    auto mech = [&](std::size_t i) -> const fvm_mechanism_data& { return templ_mech[templ[i]]; };
+    const auto& cell_cv_divs = D.geometry.cell_cv_divs;
+    auto shift_cv = [&](std::size_t i, fvm_index_type cv) { return fvm_index_type(cv+cell_cv_divs[i]-cell_cv_divs[templ[i]]); };
 
-        append(L.cv, R.cv);
-        append(L.init_iconc, R.init_iconc);
-        append(L.init_econc, R.init_econc);
-        append(L.reset_iconc, R.reset_iconc);
-        append(L.reset_econc, R.reset_econc);
-        append(L.init_revpot, R.init_revpot);
+    fvm_mechanism_data combined;
+    std::vector<std::size_t> target_base(n+1, 0);
+    for (std::size_t i = 0; i<n; ++i) {
+        target_base[i+1] = target_base[i]+mech(i).n_target;
+        combined.post_events |= mech(i).post_events;
     }
-
-    for (const auto& kv: right.mechanisms) {
-        if (!left.mechanisms.count(kv.first)) {
-            fvm_mechanism_config& L = left.mechanisms[kv.first];
-
-            L = kv.second;
-            for (auto& t: L.target) t += target_offset;
-        }
-        else {
-            fvm_mechanism_config& L = left.mechanisms[kv.first];
-            const fvm_mechanism_config& R = kv.second;
-
-            L.kind = R.kind;
-            append(L.cv, R.cv);
-            append(L.multiplicity, R.multiplicity);
-            append(L.norm_area, R.norm_area);
-            append_offset(L.target, target_offset, R.target);
-
-            arb_assert(util::equal(L.param_values, R.param_values,
-                [](auto& a, auto& b) { return a.first==b.first; }));
-            arb_assert(L.param_values.size()==R.param_values.size());
-
-            for (auto j: count_along(R.param_values)) {
-                arb_assert(L.param_values[j].first==R.param_values[j].first);
-                append(L.param_values[j].second, R.param_values[j].second);
-            }
-        }
+    combined.n_target = target_base.back();
+    combined.target_divs = impl::concat_divs(n, [&](std::size_t i) -> auto& { return mech(i).target_divs; }, ts);
+
+    // Each mechanism and ion is concatenated from the cells on which it is
+    // present, in cell order, with CVs and targets shifted.
+    std::unordered_map<std::string, std::vector<std::size_t>> mech_cells, ion_cells;
+    for (std::size_t i = 0; i<n; ++i) {
+        for (const auto& kv: mech(i).mechanisms) mech_cells[kv.first].push_back(i);
+        for (const auto& kv: mech(i).ions) ion_cells[kv.first].push_back(i);
     }
 
-    append(left.stimuli.cv, right.stimuli.cv);
-    append(left.stimuli.cv_unique, right.stimuli.cv_unique);
-    append(left.stimuli.frequency, right.stimuli.frequency);
-    append(left.stimuli.phase, right.stimuli.phase);
-    append(left.stimuli.envelope_time, right.stimuli.envelope_time);
-    append(left.stimuli.envelope_amplitude, right.stimuli.envelope_amplitude);
-
-    left.n_target += right.n_target;
-    left.post_events |= right.post_events;
-
-    append_divs(left.target_divs, right.target_divs);
-    arb_assert(left.n_target==left.target_divs.back());
+    // Entries are created before the parallel loops, which only look them up.
+    std::vector<const std::string*> mech_names, ion_names;
+    for (const auto& kv: mech_cells) {
+        combined.mechanisms[kv.first];
+        mech_names.push_back(&kv.first);
+    }
+    for (const auto& kv: ion_cells) {
+        combined.ions[kv.first];
+        ion_names.push_back(&kv.first);
+    }
 
-    return left;
-}
+    threading::parallel_for::apply(0, mech_names.size(), ts,
+        [&](int k) {
+            const auto& name = *mech_names[k];
+            const auto& on = mech_cells.at(name);
+            fvm_mechanism_config& L = combined.mechanisms.at(name);
+            auto R = [&](std::size_t j) -> const fvm_mechanism_config& { return mech(on[j]).mechanisms.at(name); };
+            const std::size_t m = on.size();
+
+            L.kind = R(0).kind;
+            L.cv = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).cv; },
+                [&](std::size_t j, fvm_index_type cv) { return shift_cv(on[j], cv); }, ts);
+            L.multiplicity = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).multiplicity; }, ts);
+            L.norm_area = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).norm_area; }, ts);
+            L.target = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).target; },
+                [&](std::size_t j, fvm_index_type t) { return fvm_index_type(t+target_base[on[j]]); }, ts);
+
+            for (auto p: count_along(R(0).param_values)) {
+                arb_assert(util::all_of(make_span(m), [&](auto j) { return R(j).param_values.at(p).first==R(0).param_values[p].first; }));
+                L.param_values.emplace_back(R(0).param_values[p].first,
+                    impl::concat(m, [&](std::size_t j) -> auto& { return R(j).param_values[p].second; }, ts));
+            }
+        });
 
-fvm_mechanism_data fvm_build_mechanism_data(const cable_cell_global_properties& gprop,
-    const cable_cell& cell, const fvm_cv_discretization& D, fvm_size_type cell_idx);
+    threading::parallel_for::apply(0, ion_names.size(), ts,
+        [&](int k) {
+            const auto& name = *ion_names[k];
+            const auto& on = ion_cells.at(name);
+            fvm_ion_config& L = combined.ions.at(name);
+            auto R = [&](std::size_t j) -> const fvm_ion_config& { return mech(on[j]).ions.at(name); };
+            const std::size_t m = on.size();
+
+            L.cv = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).cv; },
+                [&](std::size_t j, fvm_index_type cv) { return shift_cv(on[j], cv); }, ts);
+            L.init_iconc = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).init_iconc; }, ts);
+            L.init_econc = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).init_econc; }, ts);
+            L.reset_iconc = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).reset_iconc; }, ts);
+            L.reset_econc = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).reset_econc; }, ts);
+            L.init_revpot = impl::concat(m, [&](std::size_t j) -> auto& { return R(j).init_revpot; }, ts);
+        });
 
-fvm_mechanism_data fvm_build_mechanism_data(const cable_cell_global_properties& gprop,
-    const std::vector<cable_cell>& cells, const fvm_cv_discretization& D, const execution_context& ctx)
-{
-    std::vector<fvm_mechanism_data> cell_mech(cells.size());
-    threading::parallel_for::apply(0, cells.size(), ctx.thread_pool.get(),
-          [&] (int i) { cell_mech[i]=fvm_build_mechanism_data(gprop, cells[i], D, i);});
+    auto& S = combined.stimuli;
+    auto stim = [&](std::size_t i) -> const fvm_stimulus_config& { return mech(i).stimuli; };
+    S.cv = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).cv; }, shift_cv, ts);
+    S.cv_unique = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).cv_unique; }, shift_cv, ts);
+    S.frequency = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).frequency; }, ts);
+    S.phase = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).phase; }, ts);
+    S.envelope_time = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).envelope_time; }, ts);
+    S.envelope_amplitude = impl::concat(n, [&](std::size_t i) -> auto& { return stim(i).envelope_amplitude; }, ts);
 
-    fvm_mechanism_data combined;
-    for (auto cell_idx: count_along(cells)) {
-        append(combined, cell_mech[cell_idx]);
-    }
     return combined;
 }
 
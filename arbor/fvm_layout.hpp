@@ -156,6 +156,9 @@ cv_geometry& append(cv_geometry&, const cv_geometry&);
 // Construct cv_geometry from locset describing boundaries.
 cv_geometry cv_geometry_from_ends(const cable_cell& cell, const locset& lset);
 
+// As above, from the concrete boundary points.
+cv_geometry cv_geometry_from_ends(const cable_cell& cell, mlocation_list locs);
+
 // Discretization of morphologies and physical properties. Contains cv_geometry
 // as above.
 //
@@ -192,13 +195,20 @@ struct fvm_cv_discretization {
 
     // For each cell, one piece-wise constant value per branch.
     std::vector<std::vector<pw_constant_fn>> axial_resistivity; // [Ω·cm]
+
+    // For each cell, the index of the first cell with the same structure,
+    // from which its discretization and mechanism data are copied with
+    // offset indices. Empty if the cells were not compared.
+    std::vector<size_type> cell_template;
 };
 
 // Combine two fvm_cv_geometry groups in-place.
 // (Returns reference to first argument.)
 fvm_cv_discretization& append(fvm_cv_discretization&, const fvm_cv_discretization&);
 
-// Construct fvm_cv_discretization from one or more cells.
+// Construct fvm_cv_discretization from one or more cells. Of a set of cells
+// with the same structure (morphology, discretization, painted and placed
+// items, and default parameters), only the first is discretized.
 fvm_cv_discretization fvm_cv_discretize(const cable_cell& cell, const cable_cell_parameter_set& global_dflt);
 fvm_cv_discretization fvm_cv_discretize(const std::vector<cable_cell>& cells, const cable_cell_parameter_set& global_defaults, const arb::execution_context& ctx={});
 
@@ -305,6 +315,8 @@ struct fvm_mechanism_data {
     bool post_events = false;
 };
 
+// Mechanism data for the cells of D. If D records cell templates, the data
+// is built once for each template cell and copied to the others.
 fvm_mechanism_data fvm_build_mechanism_data(const cable_cell_global_properties& gprop, const std::vector<cable_cell>& cells, const fvm_cv_discretization& D, const arb::execution_context& ctx={});
 
 } // namespace arb
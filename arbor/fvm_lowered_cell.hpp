@@ -18,7 +18,6 @@
 #include "backends/event.hpp"
 #include "backends/threshold_crossing.hpp"
 #include "execution_context.hpp"
-#include "sampler_map.hpp"
 #include "util/meta.hpp"
 #include "util/range.hpp"
 #include "util/transform.hpp"
@@ -52,6 +51,7 @@ struct fvm_probe_interpolated {
     probe_handle raw_handles[2] = {nullptr, nullptr};
     double coef[2];
     mlocation metadata;
+    fvm_index_type linear = -1; // Back-end linear probe giving the interpolated value.
 
     util::any_ptr get_metadata_ptr() const { return &metadata; }
 };
@@ -126,6 +126,23 @@ struct fvm_probe_membrane_currents {
     util::any_ptr get_metadata_ptr() const { return &metadata; }
 };
 
+// Linear combinations of back-end state values, evaluated by the back-end
+// when sampled: sample value i is the value of the back-end linear probe
+// with index linear[i]. Raw handles are null.
+struct fvm_probe_linear_response {
+    std::vector<probe_handle> raw_handles;
+    std::vector<fvm_index_type> linear;
+    std::vector<mpoint> metadata;
+
+    void shrink_to_fit() {
+        raw_handles.shrink_to_fit();
+        linear.shrink_to_fit();
+        metadata.shrink_to_fit();
+    }
+
+    util::any_ptr get_metadata_ptr() const { return &metadata; }
+};
+
 struct missing_probe_info {
     // dummy data...
     std::array<probe_handle, 0> raw_handles;
@@ -142,6 +159,7 @@ struct fvm_probe_data {
     fvm_probe_data(fvm_probe_weighted_multi p): info(std::move(p)) {}
     fvm_probe_data(fvm_probe_interpolated_multi p): info(std::move(p)) {}
     fvm_probe_data(fvm_probe_membrane_currents p): info(std::move(p)) {}
+    fvm_probe_data(fvm_probe_linear_response p): info(std::move(p)) {}
 
     std::variant<
         missing_probe_info,
@@ -150,7 +168,8 @@ struct fvm_probe_data {
         fvm_probe_multi,
         fvm_probe_weighted_multi,
         fvm_probe_interpolated_multi,
-        fvm_probe_membrane_currents
+        fvm_probe_membrane_currents,
+        fvm_probe_linear_response
     > info = missing_probe_info{};
 
     auto raw_handle_range() const {
@@ -164,6 +183,15 @@ struct fvm_probe_data {
                 info));
     }
 
+    // Back-end linear probe index for each raw handle; empty if samples
+    // are taken directly from the raw handles.
+    util::range<const fvm_index_type*> linear_index_range() const {
+        if (auto* p = std::get_if<fvm_probe_linear_response>(&info)) {
+            return util::make_range(p->linear.data(), p->linear.data()+p->linear.size());
+        }
+        return {nullptr, nullptr};
+    }
+
     util::any_ptr get_metadata_ptr() const {
         return std::visit([](const auto& i) -> util::any_ptr { return i.get_metadata_ptr(); }, info);
     }
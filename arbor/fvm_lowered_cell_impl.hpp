@@ -20,6 +20,8 @@
 #include <arbor/assert.hpp>
 #include <arbor/common_types.hpp>
 #include <arbor/cable_cell_param.hpp>
+#include <arbor/math.hpp>
+#include <arbor/morph/place_pwlin.hpp>
 #include <arbor/recipe.hpp>
 #include <arbor/util/any_visitor.hpp>
 
@@ -29,7 +31,6 @@
 #include "label_resolution.hpp"
 #include "matrix.hpp"
 #include "profile/profiler_macro.hpp"
-#include "sampler_map.hpp"
 #include "util/maputil.hpp"
 #include "util/meta.hpp"
 #include "util/range.hpp"
@@ -104,6 +105,18 @@ private:
     std::vector<mechanism_ptr> mechanisms_; // excludes reversal potential calculators.
     std::vector<mechanism_ptr> revpot_mechanisms_;
 
+    // Ions with concentrations written by one or more mechanisms, and the
+    // mechanisms that write ionic state. The concentrations of all other ions
+    // are constant after reset.
+    std::vector<std::string> written_ions_;
+    std::vector<mechanism*> ion_writers_;
+
+    // Reversal potential mechanisms that read written ion concentrations,
+    // updated every step, and those that read only constant concentrations,
+    // updated once on reset.
+    std::vector<mechanism*> revpot_dynamic_;
+    std::vector<mechanism*> revpot_static_;
+
     // Non-physical voltage check threshold, 0 => no check.
     value_type check_voltage_mV_ = 0;
 
@@ -149,7 +162,9 @@ private:
         const fvm_cv_discretization& D,
         const fvm_mechanism_data& M,
         const std::vector<target_handle>& handles,
-        const std::unordered_map<std::string, mechanism*>& mech_instance_by_name);
+        const std::unordered_map<std::string, mechanism*>& mech_instance_by_name,
+        std::vector<linear_probe_term>& linear_terms,
+        std::vector<fvm_index_type>& linear_divs);
 };
 
 template <typename Backend>
@@ -176,6 +191,9 @@ void fvm_lowered_cell_impl<Backend>::reset() {
         m->initialize();
     }
 
+    // Set all concentrations here: update_ion_state() subsequently touches
+    // only those ions that are written by mechanisms.
+    state_->ions_init_concentration();
     update_ion_state();
 
     state_->zero_currents();
@@ -190,6 +208,12 @@ void fvm_lowered_cell_impl<Backend>::reset() {
         m->initialize();
     }
 
+    // Reversal potentials that depend only on constant concentrations
+    // can be computed once, here, rather than every step.
+    for (auto m: revpot_static_) {
+        m->update_current();
+    }
+
     // NOTE: Threshold watcher reset must come after the voltage values are set,
     // as voltage is implicitly read by watcher to set initial state.
     threshold_watcher_.reset();
@@ -208,8 +232,11 @@ fvm_integration_result fvm_lowered_cell_impl<Backend>::integrate(
     PE(advance_integrate_setup);
     threshold_watcher_.clear_crossings();
 
-    auto n_samples = staged_samples.size();
-    if (sample_time_.size() < n_samples) {
+    // Samples for reduced samplers share offsets, so there may be fewer
+    // offsets than sample events.
+    sample_size_type n_samples = 0;
+    for (const auto& ev: staged_samples) n_samples = std::max(n_samples, ev.raw.offset+1);
+    if (sample_time_.size() < (std::size_t)n_samples) {
         sample_time_ = array(n_samples);
         sample_value_ = array(n_samples);
     }
@@ -228,7 +255,7 @@ fvm_integration_result fvm_lowered_cell_impl<Backend>::integrate(
     while (remaining_steps) {
         // Update any required reversal potentials based on ionic concs.
 
-        for (auto& m: revpot_mechanisms_) {
+        for (auto m: revpot_dynamic_) {
             m->update_current();
         }
 
@@ -346,8 +373,10 @@ fvm_integration_result fvm_lowered_cell_impl<Backend>::integrate(
 
 template <typename Backend>
 void fvm_lowered_cell_impl<Backend>::update_ion_state() {
-    state_->ions_init_concentration();
-    for (auto& m: mechanisms_) {
+    for (auto& ion: written_ions_) {
+        state_->ion_data.at(ion).init_concentration();
+    }
+    for (auto m: ion_writers_) {
         m->update_ions();
     }
 }
@@ -525,6 +554,30 @@ fvm_initialization_data fvm_lowered_cell_impl<Backend>::initialize(
     // Keep track of mechanisms by name for probe lookup.
     std::unordered_map<std::string, mechanism*> mechptr_by_name;
 
+    // Determine which ions have concentrations written by (non-revpot) mechanisms.
+    auto writes_ions = [](const mechanism_info& info) {
+        return util::any_of(info.ions, [](const auto& kv) {
+            const auto& dep = kv.second;
+            return dep.write_concentration_int || dep.write_concentration_ext || dep.write_reversal_potential;
+        });
+    };
+
+    std::unordered_set<std::string> written_ions;
+    for (auto& m: mech_data.mechanisms) {
+        if (m.second.kind==mechanismKind::revpot) continue;
+
+        for (const auto& [ion, dep]: (*catalogue)[m.first].ions) {
+            if (dep.write_concentration_int || dep.write_concentration_ext) {
+                written_ions.insert(ion);
+            }
+        }
+    }
+
+    written_ions_.assign(written_ions.begin(), written_ions.end());
+    ion_writers_.clear();
+    revpot_dynamic_.clear();
+    revpot_static_.clear();
+
     unsigned mech_id = 0;
     for (auto& m: mech_data.mechanisms) {
         auto& name = m.first;
@@ -585,10 +638,14 @@ fvm_initialization_data fvm_lowered_cell_impl<Backend>::initialize(
             minst.mech->set_parameter(pv.first, pv.second);
         }
 
+        mechanism_info info = (*catalogue)[name];
         if (config.kind==mechanismKind::revpot) {
+            bool dynamic = util::any_of(keys(info.ions), [&](const auto& ion) { return written_ions.count(ion); });
+            (dynamic? revpot_dynamic_: revpot_static_).push_back(minst.mech.get());
             revpot_mechanisms_.push_back(mechanism_ptr(minst.mech.release()));
         }
         else {
+            if (writes_ions(info)) ion_writers_.push_back(minst.mech.get());
             mechanisms_.push_back(mechanism_ptr(minst.mech.release()));
         }
     }
@@ -597,6 +654,8 @@ fvm_initialization_data fvm_lowered_cell_impl<Backend>::initialize(
     std::vector<index_type> detector_cv;
     std::vector<value_type> detector_threshold;
     std::vector<fvm_probe_data> probe_data;
+    std::vector<linear_probe_term> linear_terms;
+    std::vector<fvm_index_type> linear_divs = {0};
 
     for (auto cell_idx: make_span(ncell)) {
         cell_gid_type gid = gids[cell_idx];
@@ -611,7 +670,7 @@ fvm_initialization_data fvm_lowered_cell_impl<Backend>::initialize(
         for (cell_lid_type i: count_along(rec_probes)) {
             probe_info& pi = rec_probes[i];
             resolve_probe_address(probe_data, cells, cell_idx, std::move(pi.address),
-                D, mech_data, fvm_info.target_handles, mechptr_by_name);
+                D, mech_data, fvm_info.target_handles, mechptr_by_name, linear_terms, linear_divs);
 
             if (!probe_data.empty()) {
                 cell_member_type probe_id{gid, i};
@@ -624,6 +683,8 @@ fvm_initialization_data fvm_lowered_cell_impl<Backend>::initialize(
         }
     }
 
+    state_->configure_linear_probes(linear_terms, linear_divs);
+
     threshold_watcher_ = backend::voltage_watcher(*state_, detector_cv, detector_threshold, context_);
 
     reset();
@@ -736,6 +797,10 @@ struct probe_resolution_data {
     const std::vector<target_handle>& handles;
     const std::unordered_map<std::string, mechanism*>& mech_instance_by_name;
 
+    // Terms of back-end linear probes, collected over all probes.
+    std::vector<linear_probe_term>& linear_terms;
+    std::vector<fvm_index_type>& linear_divs;
+
     // Backend state data for a given mechanism and state variable.
     const fvm_value_type* mechanism_state(const std::string& name, const std::string& state_var) const {
         mechanism* m = util::value_by_key(mech_instance_by_name, name).value_or(nullptr);
@@ -755,6 +820,17 @@ struct probe_resolution_data {
         return opt_mm? opt_mm->support(): mextent{};
     };
 
+    // Add an interpolated probe, with a back-end linear probe giving its
+    // value for samplers that reduce samples in the back-end.
+    void add_interpolated(fvm_probe_interpolated p) {
+        for (unsigned i = 0; i<2; ++i) {
+            if (p.raw_handles[i]) linear_terms.push_back({p.raw_handles[i], p.coef[i]});
+        }
+        p.linear = linear_divs.size()-1;
+        linear_divs.push_back(linear_terms.size());
+        result.push_back(std::move(p));
+    }
+
     // Index into ion data from location.
     std::optional<fvm_index_type> ion_location_index(const std::string& ion, mlocation loc) const {
         if (state->ion_data.count(ion)) {
@@ -774,11 +850,14 @@ void fvm_lowered_cell_impl<Backend>::resolve_probe_address(
     const fvm_cv_discretization& D,
     const fvm_mechanism_data& M,
     const std::vector<target_handle>& handles,
-    const std::unordered_map<std::string, mechanism*>& mech_instance_by_name)
+    const std::unordered_map<std::string, mechanism*>& mech_instance_by_name,
+    std::vector<linear_probe_term>& linear_terms,
+    std::vector<fvm_index_type>& linear_divs)
 {
     probe_data.clear();
     probe_resolution_data<Backend> prd{
-        probe_data, state_.get(), cells[cell_idx], cell_idx, D, M, handles, mech_instance_by_name};
+        probe_data, state_.get(), cells[cell_idx], cell_idx, D, M, handles, mech_instance_by_name,
+        linear_terms, linear_divs};
 
     using V = util::any_visitor<
         cable_probe_membrane_voltage,
@@ -787,6 +866,7 @@ void fvm_lowered_cell_impl<Backend>::resolve_probe_address(
         cable_probe_total_ion_current_density,
         cable_probe_total_ion_current_cell,
         cable_probe_total_current_cell,
+        cable_probe_extracellular_potential,
         cable_probe_stimulus_current_cell,
         cable_probe_density_state,
         cable_probe_density_state_cell,
@@ -813,7 +893,7 @@ void resolve_probe(const cable_probe_membrane_voltage& p, probe_resolution_data<
     for (mlocation loc: thingify(p.locations, R.cell.provider())) {
         fvm_voltage_interpolant in = fvm_interpolate_voltage(R.cell, R.D, R.cell_idx, loc);
 
-        R.result.push_back(fvm_probe_interpolated{
+        R.add_interpolated(fvm_probe_interpolated{
             {data+in.proximal_cv, data+in.distal_cv},
             {in.proximal_coef, in.distal_coef},
             loc});
@@ -845,7 +925,7 @@ void resolve_probe(const cable_probe_axial_current& p, probe_resolution_data<B>&
     for (mlocation loc: thingify(p.locations, R.cell.provider())) {
         fvm_voltage_interpolant in = fvm_axial_current(R.cell, R.D, R.cell_idx, loc);
 
-        R.result.push_back(fvm_probe_interpolated{
+        R.add_interpolated(fvm_probe_interpolated{
             {data+in.proximal_cv, data+in.distal_cv},
             {in.proximal_coef, in.distal_coef},
             loc});
@@ -862,7 +942,7 @@ void resolve_probe(const cable_probe_total_ion_current_density& p, probe_resolut
         auto opt_i = util::binary_search_index(R.M.stimuli.cv_unique, cv);
         const double* stim_cv_ptr = opt_i? R.state->stim_data.accu_stim_.data()+*opt_i: nullptr;
 
-        R.result.push_back(fvm_probe_interpolated{
+        R.add_interpolated(fvm_probe_interpolated{
             {current_cv_ptr, stim_cv_ptr},
             {1., -1.},
             loc});
@@ -936,6 +1016,94 @@ void resolve_probe(const cable_probe_total_current_cell& p, probe_resolution_dat
     R.result.push_back(std::move(r));
 }
 
+template <typename B>
+void resolve_probe(const cable_probe_extracellular_potential& p, probe_resolution_data<B>& R) {
+    // The membrane current through each cable is a linear function of the CV
+    // voltages and stimulus currents (see fvm_probe_membrane_currents), as is
+    // then the potential at each electrode: precompute the weights, and leave
+    // the evaluation to the back-end as one linear probe per electrode.
+    fvm_probe_linear_response r;
+    std::vector<probe_handle> state_handles;
+
+    auto cell_cv_ival = R.D.geometry.cell_cv_interval(R.cell_idx);
+    auto cv0 = cell_cv_ival.first;
+    const auto n_cv = cell_cv_ival.second-cv0;
+    const auto n_electrode = p.electrodes.size();
+
+    const auto& stim_cvs = R.M.stimuli.cv_unique;
+    const fvm_value_type* stim_src = R.state->stim_data.accu_stim_.data();
+
+    // Response [MΩ] at each electrode to unit current [nA] from each CV,
+    // summing over the cables of the CV.
+    place_pwlin place(R.cell.morphology());
+    const double coef = 1/(4*math::pi<double>*p.sigma); // [Ω·m]
+    std::vector<double> cv_response(n_electrode*n_cv, 0.);
+
+    for (auto cv: R.D.geometry.cell_cvs(R.cell_idx)) {
+        state_handles.push_back(R.state->voltage.data()+cv);
+        double oo_cv_area = R.D.cv_area[cv]>0? 1./R.D.cv_area[cv]: 0;
+
+        for (auto cable: R.D.geometry.cables(cv)) {
+            double area = R.cell.embedding().integrate_area(cable); // [µm²]
+            if (area>0) {
+                mpoint m = place.at({cable.branch, 0.5*(cable.prox_pos+cable.dist_pos)});
+                for (std::size_t e = 0; e<n_electrode; ++e) {
+                    const mpoint& x = p.electrodes[e];
+                    double d = std::max(std::hypot(m.x-x.x, m.y-x.y, m.z-x.z), m.radius); // [µm]
+                    cv_response[e*n_cv+cv-cv0] += area*oo_cv_area*coef/d;
+                }
+            }
+        }
+    }
+
+    std::vector<fvm_index_type> stim_cv;
+    std::vector<double> stim_scale;
+    for (auto cv: R.D.geometry.cell_cvs(R.cell_idx)) {
+        auto opt_i = util::binary_search_index(stim_cvs, cv);
+        if (!opt_i) continue;
+
+        state_handles.push_back(stim_src+*opt_i);
+        stim_cv.push_back(cv-cv0);
+        stim_scale.push_back(0.001*R.D.cv_area[cv]); // Scale from [µm²·A/m²] to [nA].
+    }
+
+    // Axial current cond·(v[cv]-v[parent]) leaves the parent CV and enters
+    // the CV, leaving through its membrane; stimulus current enters the CV
+    // from inside, and does not cross its membrane.
+    const auto n_state = state_handles.size();
+    std::vector<double> weight(n_state);
+
+    for (std::size_t e = 0; e<n_electrode; ++e) {
+        const double* response = cv_response.data()+e*n_cv;
+        double* w = weight.data();
+        std::fill(weight.begin(), weight.end(), 0.);
+
+        for (auto cv: R.D.geometry.cell_cvs(R.cell_idx)) {
+            auto parent_cv = R.D.geometry.cv_parent[cv];
+            if (parent_cv+1==0) continue;
+
+            double k = R.D.face_conductance[cv]*(response[parent_cv-cv0]-response[cv-cv0]);
+            w[cv-cv0] += k;
+            w[parent_cv-cv0] -= k;
+        }
+
+        for (std::size_t i = 0; i<stim_cv.size(); ++i) {
+            w[n_cv+i] = -stim_scale[i]*response[stim_cv[i]];
+        }
+
+        for (std::size_t j = 0; j<n_state; ++j) {
+            if (w[j]) R.linear_terms.push_back({state_handles[j], w[j]});
+        }
+        r.raw_handles.push_back(nullptr);
+        r.linear.push_back(R.linear_divs.size()-1);
+        R.linear_divs.push_back(R.linear_terms.size());
+    }
+
+    r.metadata = p.electrodes;
+    r.shrink_to_fit();
+    R.result.push_back(std::move(r));
+}
+
 template <typename B>
 void resolve_probe(const cable_probe_stimulus_current_cell& p, probe_resolution_data<B>& R) {
     fvm_probe_weighted_multi r;
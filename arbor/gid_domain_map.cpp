@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <arbor/assert.hpp>
+
+#include "gid_domain_map.hpp"
+#include "util/strprintf.hpp"
+
+namespace arb {
+
+gid_domain_map::gid_domain_map(std::vector<run> runs, cell_size_type num_cells, unsigned num_domains) {
+    std::sort(runs.begin(), runs.end(), [](const run& a, const run& b) { return a.first<b.first; });
+
+    // Merge adjacent runs in the same domain.
+    std::vector<run> merged;
+    for (auto& r: runs) {
+        if (r.first==r.last) continue;
+        if (!merged.empty() && merged.back().last==r.first && merged.back().domain==r.domain) {
+            merged.back().last = r.last;
+        }
+        else {
+            merged.push_back(r);
+        }
+    }
+
+    // Test for the default division into blocks.
+    const cell_gid_type block = num_domains? num_cells/num_domains: 0;
+    const cell_gid_type num_large = num_cells-block*num_domains;
+    bool is_block = merged.size()==num_domains && block>0;
+    for (unsigned d = 0; is_block && d<num_domains; ++d) {
+        cell_gid_type first = d*block+std::min<cell_gid_type>(d, num_large);
+        cell_gid_type last = first+block+(d<num_large);
+        is_block = merged[d].first==first && merged[d].last==last && merged[d].domain==(int)d;
+    }
+
+    if (is_block) {
+        block_ = block;
+        num_large_ = num_large;
+        num_cells_ = num_cells;
+        return;
+    }
+
+    for (auto& r: merged) {
+        arb_assert(first_.empty() || r.first>=last_.back());
+        first_.push_back(r.first);
+        last_.push_back(r.last);
+        domain_.push_back(r.domain);
+    }
+}
+
+int gid_domain_map::operator()(cell_gid_type gid) const {
+    if (first_.empty()) {
+        if (gid>=num_cells_) {
+            throw std::out_of_range(util::pprintf("gid {} is not in any domain", gid));
+        }
+        cell_gid_type large_end = num_large_*(block_+1);
+        return gid<large_end? gid/(block_+1): num_large_+(gid-large_end)/block_;
+    }
+
+    auto i = std::upper_bound(first_.begin(), first_.end(), gid)-first_.begin();
+    if (i==0 || gid>=last_[i-1]) {
+        throw std::out_of_range(util::pprintf("gid {} is not in any domain", gid));
+    }
+    return domain_[i-1];
+}
+
+std::vector<cell_gid_type> gid_runs(const std::vector<cell_gid_type>& sorted_gids) {
+    std::vector<cell_gid_type> runs;
+    for (auto gid: sorted_gids) {
+        if (!runs.empty() && runs.back()==gid) {
+            ++runs.back();
+        }
+        else {
+            runs.push_back(gid);
+            runs.push_back(gid+1);
+        }
+    }
+    return runs;
+}
+
+} // namespace arb
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include <arbor/common_types.hpp>
+
+namespace arb {
+
+// Map from gid to the domain that holds it, stored in O(number of domains)
+// space when each domain holds a contiguous range of gids.
+//
+// The map is built from runs of consecutive gids held by the same domain.
+// If the runs are the blocks of the default division, in which domain d holds
+// n/D cells, plus one if d < n%D, the domain is computed in closed form;
+// otherwise it is found by binary search over the sorted runs, which is
+// compact for the ranges of a cost balanced division and no larger than the
+// number of gids for an irregular division.
+//
+// Gids not held by any domain throw std::out_of_range.
+
+class gid_domain_map {
+public:
+    struct run {
+        cell_gid_type first;
+        cell_gid_type last;    // One past the last gid of the run.
+        int domain;
+    };
+
+    gid_domain_map(std::vector<run> runs, cell_size_type num_cells, unsigned num_domains);
+
+    int operator()(cell_gid_type gid) const;
+
+    // Number of runs stored, or zero if the domain is computed in closed form.
+    std::size_t num_runs() const { return first_.size(); }
+
+private:
+    // Closed form block division.
+    cell_gid_type block_ = 0;
+    cell_gid_type num_large_ = 0;
+    cell_size_type num_cells_ = 0;
+
+    // Sorted runs, if not a block division.
+    std::vector<cell_gid_type> first_;
+    std::vector<cell_gid_type> last_;
+    std::vector<int> domain_;
+};
+
+// Runs of consecutive gids in a sorted list of gids, as flattened
+// pairs (first, one past last).
+std::vector<cell_gid_type> gid_runs(const std::vector<cell_gid_type>& sorted_gids);
+
+} // namespace arb
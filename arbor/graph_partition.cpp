@@ -0,0 +1,336 @@
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <utility>
+#include <vector>
+
+#include <arbor/assert.hpp>
+
+#include "graph_partition.hpp"
+#include "util/rangeutil.hpp"
+#include "util/span.hpp"
+
+namespace arb {
+
+using weight_type = weighted_graph::weight_type;
+using util::make_span;
+
+weighted_graph::weighted_graph(std::vector<weight_type> vw, const std::vector<unsigned>& a, const std::vector<unsigned>& b):
+    weighted_graph(std::move(vw), a, b, std::vector<weight_type>(a.size(), 1))
+{}
+
+weighted_graph::weighted_graph(std::vector<weight_type> vw, const std::vector<unsigned>& a, const std::vector<unsigned>& b, const std::vector<weight_type>& w):
+    vertex_weights(std::move(vw))
+{
+    arb_assert(a.size()==b.size() && a.size()==w.size());
+    const unsigned n = size();
+
+    std::vector<std::pair<std::pair<unsigned, unsigned>, weight_type>> edges;
+    edges.reserve(a.size());
+    for (auto i: make_span(a.size())) {
+        arb_assert(a[i]<n && b[i]<n);
+        if (a[i]!=b[i]) edges.push_back({{std::min(a[i], b[i]), std::max(a[i], b[i])}, w[i]});
+    }
+    util::sort(edges);
+
+    // Count the distinct edges from each vertex, then fill in both directions.
+    std::vector<unsigned> degree(n);
+    for (auto i: make_span(edges.size())) {
+        if (i && edges[i].first==edges[i-1].first) continue;
+        ++degree[edges[i].first.first];
+        ++degree[edges[i].first.second];
+    }
+
+    offsets.assign(n+1, 0);
+    for (auto v: make_span(n)) offsets[v+1] = offsets[v]+degree[v];
+    adjacency.resize(offsets[n]);
+    edge_weights.resize(offsets[n]);
+
+    std::vector<unsigned> fill(offsets.begin(), offsets.end()-1);
+    for (std::size_t i = 0; i<edges.size();) {
+        auto [u, v] = edges[i].first;
+        weight_type w = 0;
+        std::size_t j = i;
+        for (; j<edges.size() && edges[j].first==edges[i].first; ++j) w += edges[j].second;
+
+        adjacency[fill[u]] = v;
+        edge_weights[fill[u]++] = w;
+        adjacency[fill[v]] = u;
+        edge_weights[fill[v]++] = w;
+        i = j;
+    }
+}
+
+weight_type weighted_graph::total_weight() const {
+    return util::sum(vertex_weights, weight_type(0));
+}
+
+weight_type edge_cut(const weighted_graph& g, const std::vector<unsigned>& part) {
+    weight_type cut = 0;
+    for (auto v: make_span(g.size())) {
+        for (auto e: make_span(g.offsets[v], g.offsets[v+1])) {
+            if (part[v]!=part[g.adjacency[e]]) cut += g.edge_weights[e];
+        }
+    }
+    return cut/2;
+}
+
+namespace {
+
+// Minimal linear congruential generator, so that vertex visit orders are
+// the same on every platform.
+struct lcg {
+    std::uint64_t state;
+    explicit lcg(std::uint64_t seed): state(seed) {}
+
+    unsigned operator()(unsigned n) {
+        state = state*6364136223846793005ull + 1442695040888963407ull;
+        return (state>>33)%n;
+    }
+};
+
+std::vector<unsigned> shuffled_vertices(unsigned n, std::uint64_t seed) {
+    std::vector<unsigned> order(n);
+    for (auto i: make_span(n)) order[i] = i;
+
+    lcg rng(seed);
+    for (unsigned i = n; i>1; --i) std::swap(order[i-1], order[rng(i)]);
+    return order;
+}
+
+// Contract a heavy-edge matching of g: each vertex, in random order, is
+// matched with the unmatched neighbour to which it has the heaviest edge,
+// provided their combined weight is at most max_weight. Returns the coarse
+// graph and the coarse vertex of each vertex of g.
+std::pair<weighted_graph, std::vector<unsigned>> coarsen(const weighted_graph& g, weight_type max_weight, std::uint64_t seed) {
+    const unsigned n = g.size();
+    const unsigned unmatched = -1;
+
+    std::vector<unsigned> match(n, unmatched);
+    for (auto v: shuffled_vertices(n, seed)) {
+        if (match[v]!=unmatched) continue;
+
+        unsigned best = v;
+        weight_type best_weight = 0;
+        for (auto e: make_span(g.offsets[v], g.offsets[v+1])) {
+            auto u = g.adjacency[e];
+            if (match[u]==unmatched && g.edge_weights[e]>best_weight && g.vertex_weights[v]+g.vertex_weights[u]<=max_weight) {
+                best = u;
+                best_weight = g.edge_weights[e];
+            }
+        }
+        match[v] = best;
+        match[best] = v;
+    }
+
+    std::vector<unsigned> coarse_of(n, unmatched);
+    std::vector<std::pair<unsigned, unsigned>> members;
+    for (auto v: make_span(n)) {
+        if (coarse_of[v]!=unmatched) continue;
+        coarse_of[v] = coarse_of[match[v]] = members.size();
+        members.emplace_back(v, match[v]);
+    }
+
+    // Accumulate the edges of each coarse vertex, merging parallel edges.
+    const unsigned nc = members.size();
+    weighted_graph c;
+    c.vertex_weights.resize(nc);
+    c.offsets.assign(1, 0);
+
+    std::vector<weight_type> acc(nc, 0);
+    std::vector<unsigned> touched;
+    for (auto cv: make_span(nc)) {
+        auto [v, u] = members[cv];
+        c.vertex_weights[cv] = g.vertex_weights[v] + (u!=v? g.vertex_weights[u]: 0);
+
+        auto add_edges = [&](unsigned x) {
+            for (auto e: make_span(g.offsets[x], g.offsets[x+1])) {
+                auto cu = coarse_of[g.adjacency[e]];
+                if (cu==cv) continue;
+                if (!acc[cu]) touched.push_back(cu);
+                acc[cu] += g.edge_weights[e];
+            }
+        };
+        add_edges(v);
+        if (u!=v) add_edges(u);
+
+        for (auto cu: touched) {
+            c.adjacency.push_back(cu);
+            c.edge_weights.push_back(acc[cu]);
+            acc[cu] = 0;
+        }
+        touched.clear();
+        c.offsets.push_back(c.adjacency.size());
+    }
+
+    return {std::move(c), std::move(coarse_of)};
+}
+
+// Greedy graph growing: grow each part in turn from an unassigned seed
+// vertex, adding the unassigned vertex most strongly connected to the part
+// until the part has its share of the weight not yet assigned. The last
+// part takes the remaining vertices.
+std::vector<unsigned> grow_partition(const weighted_graph& g, unsigned num_parts) {
+    const unsigned n = g.size();
+    const unsigned unassigned = -1;
+
+    std::vector<unsigned> part(n, unassigned);
+    std::vector<weight_type> conn(n, 0);
+    weight_type remaining = g.total_weight();
+    unsigned next_seed = 0;
+
+    for (unsigned p = 0; p+1<num_parts; ++p) {
+        weight_type budget = remaining/(num_parts-p);
+        weight_type weight = 0;
+
+        std::priority_queue<std::pair<weight_type, unsigned>> q;
+        while (weight<budget) {
+            // Take the best connected vertex, or a new seed if the part's
+            // neighbourhood is exhausted.
+            unsigned v = unassigned;
+            while (!q.empty()) {
+                auto [w, u] = q.top();
+                q.pop();
+                if (part[u]==unassigned && w==conn[u]) {
+                    v = u;
+                    break;
+                }
+            }
+            if (v==unassigned) {
+                while (next_seed<n && part[next_seed]!=unassigned) ++next_seed;
+                if (next_seed==n) break;
+                v = next_seed;
+            }
+
+            // Stop if adding the vertex would take the part further from its budget.
+            weight_type vw = g.vertex_weights[v];
+            if (weight && weight+vw-budget>budget-weight) break;
+
+            part[v] = p;
+            weight += vw;
+            for (auto e: make_span(g.offsets[v], g.offsets[v+1])) {
+                auto u = g.adjacency[e];
+                if (part[u]==unassigned) {
+                    conn[u] += g.edge_weights[e];
+                    q.emplace(conn[u], u);
+                }
+            }
+        }
+        remaining -= weight;
+    }
+
+    for (auto& p: part) {
+        if (p==unassigned) p = num_parts-1;
+    }
+    return part;
+}
+
+// Greedy boundary refinement: move vertices to the neighbouring part to
+// which they are most strongly connected, if that reduces the edge cut
+// without overloading the part, keeps the cut and improves the balance, or
+// relieves an overloaded part. Parts are never emptied.
+void refine_partition(const weighted_graph& g, std::vector<unsigned>& part, unsigned num_parts, weight_type max_part_weight) {
+    const unsigned n = g.size();
+    const unsigned max_passes = 8;
+
+    std::vector<weight_type> part_weight(num_parts, 0);
+    std::vector<unsigned> part_size(num_parts, 0);
+    for (auto v: make_span(n)) {
+        part_weight[part[v]] += g.vertex_weights[v];
+        ++part_size[part[v]];
+    }
+
+    std::vector<weight_type> conn(num_parts, 0);
+    std::vector<unsigned> touched;
+    for (unsigned pass = 0; pass<max_passes; ++pass) {
+        unsigned moves = 0;
+        for (auto v: make_span(n)) {
+            unsigned p = part[v];
+            if (part_size[p]==1) continue;
+
+            for (auto e: make_span(g.offsets[v], g.offsets[v+1])) {
+                auto q = part[g.adjacency[e]];
+                if (!conn[q] && q!=p) touched.push_back(q);
+                conn[q] += g.edge_weights[e];
+            }
+
+            weight_type vw = g.vertex_weights[v];
+            bool overloaded = part_weight[p]>max_part_weight;
+            unsigned best = p;
+            weight_type best_gain = 0;
+            for (auto q: touched) {
+                weight_type gain = conn[q]-conn[p];
+                weight_type w = part_weight[q]+vw;
+                bool ok = (gain>0 && w<=max_part_weight) ||
+                          (gain==0 && w<part_weight[p]) ||
+                          (overloaded && w<=max_part_weight);
+                if (ok && (best==p || gain>best_gain || (gain==best_gain && part_weight[q]<part_weight[best]))) {
+                    best = q;
+                    best_gain = gain;
+                }
+            }
+
+            for (auto q: touched) conn[q] = 0;
+            conn[p] = 0;
+            touched.clear();
+
+            if (best!=p) {
+                part[v] = best;
+                part_weight[p] -= vw;
+                part_weight[best] += vw;
+                --part_size[p];
+                ++part_size[best];
+                ++moves;
+            }
+        }
+        if (!moves) break;
+    }
+}
+
+} // anonymous namespace
+
+std::vector<unsigned> partition_graph(const weighted_graph& g, unsigned num_parts, double imbalance) {
+    const unsigned n = g.size();
+    if (num_parts<=1) return std::vector<unsigned>(n, 0);
+    if (n<=num_parts) {
+        std::vector<unsigned> part(n);
+        for (auto v: make_span(n)) part[v] = v;
+        return part;
+    }
+
+    const weight_type total = g.total_weight();
+    const unsigned coarse_target = std::max(20*num_parts, 100u);
+    const weight_type max_vertex_weight = std::max<weight_type>(1, 1.5*total/coarse_target);
+
+    // Coarsen until the graph is small, or no longer shrinks appreciably.
+    std::vector<weighted_graph> graphs;
+    std::vector<std::vector<unsigned>> coarse_of;
+    const weighted_graph* current = &g;
+    while (current->size()>coarse_target) {
+        auto [c, map] = coarsen(*current, max_vertex_weight, graphs.size()+1);
+        if (c.size()>0.95*current->size()) break;
+
+        graphs.push_back(std::move(c));
+        coarse_of.push_back(std::move(map));
+        current = &graphs.back();
+    }
+
+    const weight_type max_part_weight = (1+imbalance)*total/num_parts;
+    auto part = grow_partition(*current, num_parts);
+    refine_partition(*current, part, num_parts, max_part_weight);
+
+    // Project back through each level, refining at each.
+    for (auto level = graphs.size(); level>0; --level) {
+        const auto& map = coarse_of[level-1];
+        const weighted_graph& finer = level>1? graphs[level-2]: g;
+
+        std::vector<unsigned> finer_part(finer.size());
+        for (auto v: make_span(finer.size())) finer_part[v] = part[map[v]];
+        part = std::move(finer_part);
+        refine_partition(finer, part, num_parts, max_part_weight);
+    }
+
+    return part;
+}
+
+} // namespace arb
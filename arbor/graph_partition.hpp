@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace arb {
+
+// Undirected graph with weighted vertices and edges, in compressed sparse
+// row form: the neighbours of vertex v are adjacency[offsets[v]..offsets[v+1]),
+// with edges of weight edge_weights[offsets[v]..offsets[v+1]). Each edge is
+// listed from both of its ends, and there are no self loops.
+
+struct weighted_graph {
+    using weight_type = std::int64_t;
+
+    std::vector<unsigned> offsets = {0};
+    std::vector<unsigned> adjacency;
+    std::vector<weight_type> edge_weights;
+    std::vector<weight_type> vertex_weights;
+
+    weighted_graph() = default;
+
+    // Build from a list of edges (a[i], b[i]) of unit weight between n
+    // vertices with the given weights. Edges may be given in either or both
+    // directions, and may be repeated: the weight of an edge in the graph is
+    // the number of times it occurs. Self loops are ignored.
+    weighted_graph(std::vector<weight_type> vertex_weights,
+                   const std::vector<unsigned>& a,
+                   const std::vector<unsigned>& b);
+
+    // As above, with edges (a[i], b[i]) of weight w[i]: the weight of an edge
+    // in the graph is the sum of the weights of its occurrences.
+    weighted_graph(std::vector<weight_type> vertex_weights,
+                   const std::vector<unsigned>& a,
+                   const std::vector<unsigned>& b,
+                   const std::vector<weight_type>& w);
+
+    unsigned size() const { return vertex_weights.size(); }
+
+    weight_type total_weight() const;
+};
+
+// Sum of the weights of edges between vertices in different parts.
+weighted_graph::weight_type edge_cut(const weighted_graph& g, const std::vector<unsigned>& part);
+
+// Divide the vertices of g into num_parts parts of near equal total vertex
+// weight, minimising the total weight of edges between parts, with a
+// multilevel scheme: the graph is coarsened by contracting heavy edges,
+// the coarsest graph is partitioned by greedy graph growing, and the
+// partition is projected back through each level with greedy boundary
+// refinement. Parts are kept within a factor (1+imbalance) of the mean
+// weight where the vertex weights allow.
+//
+// The result is deterministic: the same graph gives the same partition on
+// every rank. Returns the part of each vertex.
+std::vector<unsigned> partition_graph(const weighted_graph& g, unsigned num_parts, double imbalance = 0.03);
+
+} // namespace arb
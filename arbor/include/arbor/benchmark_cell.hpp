@@ -1,9 +1,28 @@
 #pragma once
 
+#include <cstddef>
+
 #include <arbor/schedule.hpp>
 
 namespace arb {
 
+// Optional cost profile for a benchmark cell, used to emulate the memory
+// traffic and event processing load of a "real" cell in addition to the
+// fixed compute cost set by the realtime ratio.
+
+struct benchmark_cost_profile {
+    // Number of bytes of cell state read and written each time step.
+    std::size_t bytes_per_step = 0;
+
+    // Size in bytes of the cell state over which the streamed bytes cycle.
+    // A working set smaller than bytes_per_step is reused within a step;
+    // it is at least one 64 byte cache line, and bytes_per_step if zero.
+    std::size_t working_set_bytes = 0;
+
+    // Time taken in µs to process each post-synaptic event delivered to the cell.
+    double event_cost_us = 0;
+};
+
 // Cell description returned by recipe::cell_description(gid) for cells with
 // recipe::cell_kind(gid) returning cell_kind::benchmark
 
@@ -18,11 +37,13 @@ struct benchmark_cell {
     // If equal to 1, then a single cell can be advanced in realtime 
     double realtime_ratio;
 
+    // Memory and event costs emulated in addition to the realtime ratio.
+    benchmark_cost_profile cost;
+
     benchmark_cell() = delete;
-    benchmark_cell(cell_tag_type source, cell_tag_type target, schedule seq, double ratio):
-        source(source), target(target), time_sequence(seq), realtime_ratio(ratio) {};
+    benchmark_cell(cell_tag_type source, cell_tag_type target, schedule seq, double ratio, benchmark_cost_profile cost = {}):
+        source(source), target(target), time_sequence(seq), realtime_ratio(ratio), cost(cost) {};
 };
 
 } // namespace arb
 
-
@@ -91,6 +91,18 @@ struct cable_probe_total_ion_current_cell {};
 // Sample metadata type: `mcable_list`
 struct cable_probe_total_current_cell {};
 
+// Extracellular potential [mV] at each of the `electrodes` due to the total
+// membrane current excluding stimulus currents, with each component of the cell
+// treated as a point source at its midpoint in a homogeneous medium of
+// conductivity `sigma` [S/m]. Distances from an electrode to a source are
+// bounded below by the cable radius at the source.
+// Sample value type: `cable_sample_range`
+// Sample metadata type: `std::vector<mpoint>`
+struct cable_probe_extracellular_potential {
+    std::vector<mpoint> electrodes;
+    double sigma = 0.3;
+};
+
 // Stimulus currents [nA] across components of the cell.
 // Sample value type: `cable_sample_range`
 // Sample metadata type: `mcable_list`
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 namespace arb {
 
@@ -25,6 +26,16 @@ struct proc_allocation {
     // See documenation for cuda[/hip]SetDevice and cuda[/hip]DeviceGetAttribute.
     int gpu_id;
 
+    // Logical cores to which the worker threads are bound: thread i is bound
+    // to thread_affinity[i%thread_affinity.size()], for example from the
+    // affinity mask given by arbenv::get_affinity(). If empty, threads are
+    // not bound. The calling thread, which runs as thread 0, is not bound by
+    // Arbor. When threads are bound, each cell group is assigned to one thread,
+    // until reassigned by simulation::rebalance, which builds it and advances
+    // it, unless another thread is idle while it is busy. The group's state is
+    // then allocated local to the core that updates it.
+    std::vector<int> thread_affinity;
+
     proc_allocation(): proc_allocation(1, -1) {}
 
     proc_allocation(unsigned threads, int gpu):
@@ -7,6 +7,7 @@
 #include <arbor/assert.hpp>
 #include <arbor/common_types.hpp>
 #include <arbor/context.hpp>
+#include <arbor/profile/timer.hpp>
 
 namespace arb {
 
@@ -51,6 +52,10 @@ struct domain_decomposition {
 
     /// Descriptions of the cell groups on the local domain
     std::vector<group_description> groups;
+
+    /// Time spent on the local domain in each phase of the load balancing
+    /// algorithm that generated the decomposition, if it records them.
+    profile::phase_times construction_times;
 };
 
 } // namespace arb
@@ -9,19 +9,54 @@
 
 namespace arb {
 
+// How cells are divided among domains, or among the cell groups of a kind.
+enum class partition_strategy {
+    // Domains are assigned equal numbers of cells, and cell groups hold
+    // cpu_group_size or gpu_group_size cells each.
+    count,
+    // Domains are assigned contiguous ranges of gids of near equal total
+    // cost, and the cells of a kind are divided into as many groups as
+    // for partition_strategy::count, of near equal total cost. The cost of
+    // a cell is given by recipe::get_cell_cost, or if that is not positive,
+    // estimated from the cell description and its connections.
+    cost,
+    // Domains are assigned cells by a multilevel partition of the graph of
+    // connections, minimising the number of connections between domains
+    // while balancing cost across domains; cells connected by gap junctions
+    // are kept together. The connection graph is gathered on every domain,
+    // so this strategy needs memory proportional to the total number of
+    // connections: above partition_graph_max_edges, domains are assigned
+    // cells as for partition_strategy::cost instead. Cell groups are formed
+    // as for partition_strategy::cost.
+    graph
+};
+
+// Largest number of edges in the connection graph gathered on every domain
+// by partition_strategy::graph, counted after each domain merges repeated
+// connections and contracts the gap junctions between its own cells.
+constexpr std::size_t partition_graph_max_edges = std::size_t(1)<<26;
+
 struct partition_hint {
     constexpr static std::size_t max_size = -1;
 
     std::size_t cpu_group_size = 1;
     std::size_t gpu_group_size = max_size;
     bool prefer_gpu = true;
+
+    // How the cells of the kind on a domain are divided into cell groups;
+    // partition_strategy::graph forms groups as partition_strategy::cost.
+    // The division of cells among domains is chosen separately.
+    partition_strategy strategy = partition_strategy::count;
 };
 
 using partition_hint_map = std::unordered_map<cell_kind, partition_hint>;
 
+// Cells are divided among domains by domain_strategy. This is a collective
+// operation: domain_strategy must be the same on every domain.
 domain_decomposition partition_load_balance(
     const recipe& rec,
     const context& ctx,
-    partition_hint_map hint_map = {});
+    partition_hint_map hint_map = {},
+    partition_strategy domain_strategy = partition_strategy::count);
 
 } // namespace arb
@@ -11,11 +11,16 @@
 namespace arb {
 
 struct morphology_impl;
+struct mprovider_cache;
 
 class morphology {
     // Hold an immutable copy of the morphology implementation.
     std::shared_ptr<const morphology_impl> impl_;
 
+    // Regions and locsets evaluated on the morphology, shared by its copies.
+    std::shared_ptr<mprovider_cache> cache_;
+    friend struct mprovider;
+
 public:
     morphology(segment_tree m);
     morphology();
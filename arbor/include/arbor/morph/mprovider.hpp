@@ -6,10 +6,15 @@
 #include <arbor/morph/embed_pwlin.hpp>
 #include <arbor/morph/primitives.hpp>
 #include <arbor/morph/label_dict.hpp>
+#include <arbor/morph/locset.hpp>
+#include <arbor/morph/region.hpp>
 #include <arbor/util/expected.hpp>
 
 namespace arb {
 
+class cable_cell;
+struct cv_policy;
+
 using concrete_embedding = embed_pwlin;
 
 struct mprovider {
@@ -20,6 +25,17 @@ struct mprovider {
     const mextent& region(const std::string& name) const;
     const mlocation_list& locset(const std::string& name) const;
 
+    // Concrete region or locset of an expression. Named regions and locsets,
+    // and these expressions, are evaluated once for all providers on copies
+    // of the same morphology with the same label dictionary.
+    mextent concrete_region(const arb::region&) const;
+    mlocation_list concrete_locset(const arb::locset&) const;
+
+    // Concrete CV boundary points given by a policy for a cell built on this
+    // provider, evaluated once for all such providers. Policies are
+    // identified by their printed form.
+    mlocation_list concrete_cv_boundary_points(const cv_policy&, const cable_cell&) const;
+
     // Read-only access to morphology and constructed embedding.
     const auto& morphology() const { return morphology_; }
     const auto& embedding() const { return embedding_; }
@@ -31,6 +47,9 @@ private:
     arb::morphology morphology_;
     concrete_embedding embedding_;
 
+    // Identifies the label dictionary in the morphology's cache.
+    unsigned dictionary_id_ = 0;
+
     struct circular_def {};
 
     // Maps are mutated only during initialization phase of mprovider.
@@ -38,6 +38,8 @@ private:
     std::vector<std::unique_ptr<meter>> meters_;
     std::vector<std::string> checkpoint_names_;
 
+    phase_times phases_;
+
 public:
     meter_manager();
     void start(const context& ctx);
@@ -47,6 +49,11 @@ public:
     const std::vector<std::string>& checkpoint_names() const;
     const std::vector<double>& times() const;
 
+    // Record the time taken by phases measured outside the checkpoints, such
+    // as domain_decomposition::construction_times. The same phases must be
+    // recorded, in the same order, on every domain.
+    void record_phases(const phase_times& phases);
+    const phase_times& phases() const;
 };
 
 // Simple type for gathering distributed meter information
@@ -56,6 +63,10 @@ struct meter_report {
     unsigned num_hosts;
     std::vector<measurement> meters;
     std::vector<std::string> hosts;
+    // Names of the recorded phases, and for each phase the time in s taken
+    // on each domain.
+    std::vector<std::string> phases;
+    std::vector<std::vector<double>> phase_times;
 };
 
 meter_report make_meter_report(const meter_manager& manager, const context& ctx);
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <string>
+#include <utility>
+#include <vector>
+
 #include <arbor/profile/clock.hpp>
 
 namespace arb {
@@ -16,5 +20,9 @@ struct timer {
     }
 };
 
+// Wall-clock time in seconds spent on this domain in each of a sequence of
+// named phases, in the order in which they ran.
+using phase_times = std::vector<std::pair<std::string, double>>;
+
 } // namespace profile
 } // namespace arb
@@ -83,6 +83,13 @@ public:
         return {};
     }
 
+    // Relative cost of simulating a cell, used by partition_load_balance
+    // with partition_strategy::cost. If not positive, the cost is estimated
+    // from the cell description and its connections.
+    virtual double get_cell_cost(cell_gid_type) const {
+        return 0;
+    }
+
     // Global property type will be specific to given cell kind.
     virtual std::any get_global_properties(cell_kind) const { return std::any{}; };
 
@@ -40,6 +40,44 @@ using sampler_function = std::function<
           const sample_record*  // pointer to first sample record
          )>;
 
+// Bulk samplers receive, in one call per cell group and integration epoch,
+// the samples of all probes in a sampler association that have scalar
+// sample values, laid out by column: the n_sample sample times and values
+// for the probe described by meta[k] are contiguous, starting at
+// time[k*n_sample] and value[k*n_sample] respectively.
+//
+// The time and value arrays are views into simulation state where
+// possible, and are only valid for the duration of the call.
+
+struct sample_columns {
+    std::size_t n_probe;
+    std::size_t n_sample;
+    const probe_metadata* meta;
+    const time_type* time;
+    const double* value;
+};
+
+using bulk_sampler_function = std::function<void (const sample_columns&)>;
+
+// Samplers may request that samples of probes with scalar sample values be
+// reduced before delivery: values are accumulated over windows of `window`
+// consecutive scheduled sample times, and one sample per completed window is
+// passed to the sampler, at the time of the last sample in the window.
+// Windows carry over from one call to `run` to the next.
+
+enum class sample_reduction {
+    decimate,   // last value in window
+    mean,
+    min,
+    max,
+    rms         // root mean square
+};
+
+struct sample_reducer {
+    sample_reduction op = sample_reduction::mean;
+    unsigned window = 1;
+};
+
 using sampler_association_handle = std::size_t;
 
 enum class sampling_policy {
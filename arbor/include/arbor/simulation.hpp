@@ -8,10 +8,12 @@
 #include <arbor/common_types.hpp>
 #include <arbor/context.hpp>
 #include <arbor/domain_decomposition.hpp>
+#include <arbor/profile/timer.hpp>
 #include <arbor/recipe.hpp>
 #include <arbor/sampling.hpp>
 #include <arbor/schedule.hpp>
 #include <arbor/spike.hpp>
+#include <arbor/spike_statistics.hpp>
 #include <arbor/util/handle_set.hpp>
 
 namespace arb {
@@ -35,6 +37,20 @@ public:
     sampler_association_handle add_sampler(cell_member_predicate probe_ids,
         schedule sched, sampler_function f, sampling_policy policy = sampling_policy::lax);
 
+    // Reduced samplers receive one sample per window of scheduled sample times
+    // for each matching probe with scalar values; other probes are ignored.
+    // Throws range_check_failure if the reducer window is zero.
+
+    sampler_association_handle add_sampler(cell_member_predicate probe_ids,
+        schedule sched, sampler_function f, sample_reducer reducer, sampling_policy policy = sampling_policy::lax);
+
+    // Bulk samplers receive, per cell group and integration epoch, the samples
+    // of all matching probes with scalar values, by column; other probes are
+    // ignored. The returned handle is removed with `remove_sampler`.
+
+    sampler_association_handle add_bulk_sampler(cell_member_predicate probe_ids,
+        schedule sched, bulk_sampler_function f, sampling_policy policy = sampling_policy::lax);
+
     void remove_sampler(sampler_association_handle);
 
     void remove_all_samplers();
@@ -56,6 +72,46 @@ public:
     // spike vector.
     void set_local_spike_callback(spike_export_function = spike_export_function{});
 
+    // Accumulate spike statistics for populations of cells from the local spikes
+    // of each epoch, replacing any previous statistics.
+    void set_spike_statistics(spike_statistics_config config);
+
+    // Return spike statistics over the simulated time, combined across ranks,
+    // ordered by the first gid of each population (not in configuration order).
+    // Collective: must be called on all ranks. Returns an empty vector if no
+    // statistics have been set.
+    std::vector<population_statistics> spike_statistics() const;
+
+    // Time in seconds spent advancing each local cell group since construction,
+    // indexed as the groups of the domain decomposition. Cell groups are
+    // advanced in decreasing order of the time taken in the previous epoch.
+    std::vector<double> group_costs() const;
+
+    // Time in seconds spent advancing each cell since construction, indexed
+    // by gid, where the time for a cell group is shared equally among its
+    // cells. These can be returned by recipe::get_cell_cost to build a new
+    // domain decomposition with partition_strategy::cost. Collective: must
+    // be called on all ranks.
+    std::vector<double> cell_costs() const;
+
+    // Thread that advances each local cell group, indexed as the groups of
+    // the domain decomposition, when the threads are bound to cores; empty
+    // otherwise.
+    std::vector<unsigned> group_threads() const;
+
+    // Time spent on this domain in each phase of construction: building the
+    // cell groups, the communicator, and the event generators.
+    profile::phase_times construction_times() const;
+
+    // Reassign local cell groups to threads by the time taken to advance
+    // them since construction or the last rebalance, when the threads are
+    // bound to cores. A group is only reassigned to threads on the NUMA node
+    // of the thread that constructed it, where its state was allocated. Returns the ratio of the largest total time of any rank
+    // to the mean over ranks for the same period, so that the caller can
+    // decide whether to build a new domain decomposition. Collective: must be
+    // called on all ranks, between calls to run.
+    double rebalance();
+
     // Add events directly to targets.
     // Must be called before calling simulation::run, and must contain events that
     // are to be delivered at or after the current simulation time.
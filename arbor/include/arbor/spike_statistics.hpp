@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <arbor/common_types.hpp>
+
+namespace arb {
+
+// Spike statistics for populations of cells, accumulated from local spikes as
+// a simulation runs; see `simulation::set_spike_statistics`.
+//
+// Populations are disjoint, half-open ranges of gids [first, second).
+// Statistics are reported in order of population, by first gid, whatever
+// the order of the populations in the configuration.
+
+struct spike_statistics_config {
+    std::vector<std::pair<cell_gid_type, cell_gid_type>> populations;
+    time_type bin_width = 1;          // [ms] width of peri-stimulus time histogram bins
+};
+
+struct population_statistics {
+    std::pair<cell_gid_type, cell_gid_type> population;
+    std::uint64_t n_spike = 0;
+
+    // Mean firing rate per cell [Hz] over the simulated time.
+    double rate = 0;
+
+    // Mean coefficient of variation of inter-spike intervals, over those
+    // cells with at least two intervals; NaN if there are no such cells.
+    double isi_cv = 0;
+    std::uint64_t n_isi_cv_cell = 0;
+
+    // Spike counts over bins of width bin_width, from t = 0 to the simulated time.
+    std::vector<std::uint64_t> histogram;
+};
+
+} // namespace arb
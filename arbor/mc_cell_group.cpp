@@ -1,6 +1,9 @@
+#include <cmath>
 #include <functional>
+#include <numeric>
 #include <optional>
 #include <unordered_set>
+#include <utility>
 #include <variant>
 #include <vector>
 
@@ -18,11 +21,11 @@
 #include "label_resolution.hpp"
 #include "mc_cell_group.hpp"
 #include "profile/profiler_macro.hpp"
-#include "sampler_map.hpp"
 #include "util/filter.hpp"
 #include "util/maputil.hpp"
 #include "util/partition.hpp"
 #include "util/range.hpp"
+#include "util/rangeutil.hpp"
 #include "util/span.hpp"
 
 namespace arb {
@@ -76,6 +79,9 @@ void mc_cell_group::reset() {
     sample_events_.clear();
     for (auto &entry: sampler_map_) {
         entry.second.sched.reset();
+        for (auto& w: entry.second.plan->windows) {
+            w = sample_window{};
+        }
     }
 
     for (auto& b: binners_) {
@@ -92,16 +98,16 @@ void mc_cell_group::set_binning_policy(binning_kind policy, time_type bin_interv
 
 // Probe-type specific sample data marshalling.
 
-struct sampler_call_info {
-    sampler_function sampler;
-    cell_member_type probe_id;
-    probe_tag tag;
-    unsigned index;
-    const fvm_probe_data* pdata_ptr;
+// One sampler call for one probe of a sampler plan: offsets are into
+// lowered cell sample time and value arrays.
 
-    // Offsets are into lowered cell sample time and event arrays.
+struct sampler_call_info {
+    const sampler_plan* plan;
+    std::size_t probe;
     sample_size_type begin_offset;
     sample_size_type end_offset;
+
+    const probe_metadata& meta() const { return plan->meta[probe]; }
 };
 
 // Working space for computing and collating data for samplers.
@@ -145,7 +151,7 @@ void run_samples(
        sample_records.push_back(sample_record{time_type(raw_times[i]), &raw_samples[i]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 void run_samples(
@@ -175,7 +181,7 @@ void run_samples(
         sample_records.push_back(sample_record{time_type(raw_times[offset]), &ctmp[j]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 void run_samples(
@@ -205,7 +211,7 @@ void run_samples(
         sample_records.push_back(sample_record{time_type(raw_times[offset]), &csample_ranges[j]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 void run_samples(
@@ -248,7 +254,7 @@ void run_samples(
         sample_records.push_back(sample_record{time_type(raw_times[offset]), &csample_ranges[j]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 void run_samples(
@@ -295,7 +301,7 @@ void run_samples(
         sample_records.push_back(sample_record{time_type(raw_times[offset]), &csample_ranges[j]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 void run_samples(
@@ -369,7 +375,39 @@ void run_samples(
         sample_records.push_back(sample_record{time_type(raw_times[offset]), &csample_ranges[j]});
     }
 
-    sc.sampler({sc.probe_id, sc.tag, sc.index, p.get_metadata_ptr()}, n_sample, sample_records.data());
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
+}
+
+void run_samples(
+    const fvm_probe_linear_response& p,
+    const sampler_call_info& sc,
+    const fvm_value_type* raw_times,
+    const fvm_value_type* raw_samples,
+    std::vector<sample_record>& sample_records,
+    fvm_probe_scratch& scratch)
+{
+    // Linear responses are evaluated by the back-end, one raw sample per value.
+    const sample_size_type n_raw_per_sample = p.raw_handles.size();
+    sample_size_type n_sample = (sc.end_offset-sc.begin_offset)/n_raw_per_sample;
+    arb_assert((sc.end_offset-sc.begin_offset)==n_sample*n_raw_per_sample);
+    arb_assert(p.metadata.size()==p.linear.size());
+
+    auto& sample_ranges = std::get<std::vector<cable_sample_range>>(scratch);
+    sample_ranges.clear();
+    sample_records.clear();
+
+    for (sample_size_type j = 0; j<n_sample; ++j) {
+        auto offset = j*n_raw_per_sample+sc.begin_offset;
+        sample_ranges.push_back({raw_samples+offset, raw_samples+offset+n_raw_per_sample});
+    }
+
+    const auto& csample_ranges = sample_ranges;
+    for (sample_size_type j = 0; j<n_sample; ++j) {
+        auto offset = j*n_raw_per_sample+sc.begin_offset;
+        sample_records.push_back(sample_record{time_type(raw_times[offset]), &csample_ranges[j]});
+    }
+
+    sc.plan->sampler(sc.meta(), n_sample, sample_records.data());
 }
 
 // Generic run_samples dispatches on probe info variant type.
@@ -380,7 +418,170 @@ void run_samples(
     std::vector<sample_record>& sample_records,
     fvm_probe_scratch& scratch)
 {
-    std::visit([&](auto& x) {run_samples(x, sc, raw_times, raw_samples, sample_records, scratch); }, sc.pdata_ptr->info);
+    std::visit([&](auto& x) {run_samples(x, sc, raw_times, raw_samples, sample_records, scratch); }, sc.plan->probes[sc.probe].pdata->info);
+}
+
+// Bulk samplers take probes with scalar sample values; samples for each
+// probe in a bulk call are assigned contiguous offsets, probe by probe.
+
+bool is_bulk_sampleable(const fvm_probe_data& pdata) {
+    return std::holds_alternative<fvm_probe_scalar>(pdata.info) ||
+           std::holds_alternative<fvm_probe_interpolated>(pdata.info);
+}
+
+void run_bulk_samples(
+    const scheduled_sampler& ss,
+    const fvm_value_type* raw_times,
+    const fvm_value_type* raw_samples,
+    std::vector<time_type>& time_scratch,
+    std::vector<double>& value_scratch)
+{
+    static_assert(std::is_same<time_type, fvm_value_type>::value, "require sample time translation");
+    static_assert(std::is_same<double, fvm_value_type>::value, "require sample value translation");
+
+    const sampler_plan& plan = *ss.plan;
+    const std::size_t n_probe = plan.meta.size();
+    const std::size_t n_times = ss.n_times;
+
+    if (plan.bulk_direct) {
+        plan.bulk_sampler({n_probe, n_times, plan.meta.data(), raw_times+ss.begin_offset, raw_samples+ss.begin_offset});
+        return;
+    }
+
+    time_scratch.clear();
+    value_scratch.clear();
+
+    auto offset = ss.begin_offset;
+    for (const sampler_plan_probe& probe: plan.probes) {
+        if (auto* p = std::get_if<fvm_probe_interpolated>(&probe.pdata->info)) {
+            for (std::size_t j = 0; j<n_times; ++j, offset += 2) {
+                time_scratch.push_back(raw_times[offset]);
+                value_scratch.push_back(p->coef[0]*raw_samples[offset] + p->coef[1]*raw_samples[offset+1]);
+            }
+        }
+        else {
+            for (std::size_t j = 0; j<n_times; ++j, ++offset) {
+                time_scratch.push_back(raw_times[offset]);
+                value_scratch.push_back(raw_samples[offset]);
+            }
+        }
+    }
+
+    plan.bulk_sampler({n_probe, n_times, plan.meta.data(), time_scratch.data(), value_scratch.data()});
+}
+
+// Reduced samplers take probes with scalar sample values, as for bulk samplers,
+// and are called per probe with one sample for each window completed in this
+// epoch. Samples are reduced by the back-end, which stores one value for each
+// window or part of a window in the epoch; the part of a window carried over
+// from the previous epoch is combined with the first of these.
+
+sample_store reduction_store(sample_reduction op) {
+    switch (op) {
+    case sample_reduction::mean:
+        return sample_store::sum;
+    case sample_reduction::min:
+        return sample_store::min;
+    case sample_reduction::max:
+        return sample_store::max;
+    case sample_reduction::rms:
+        return sample_store::sum_squares;
+    default:
+        return sample_store::copy;
+    }
+}
+
+// Sample event payload for a probe of a reduced sampler, without offset.
+raw_probe_info reduced_probe_info(const fvm_probe_data& pdata, sample_reduction op) {
+    raw_probe_info raw{nullptr, 0};
+    if (auto* p = std::get_if<fvm_probe_interpolated>(&pdata.info)) {
+        raw.linear = p->linear;
+    }
+    else {
+        raw.handle = *pdata.raw_handle_range().begin();
+    }
+    raw.store = reduction_store(op);
+    return raw;
+}
+
+// Number of windows, whole or part, with samples at n_times sample times
+// following those already in the window w.
+sample_size_type reduced_window_count(const sample_window& w, sample_size_type n_times, unsigned window) {
+    return (w.count+n_times-1)/window+1;
+}
+
+// Combine the back-end reduction v of n samples with the window w.
+void combine_sample(sample_reduction op, sample_window& w, double v, unsigned n) {
+    switch (op) {
+    case sample_reduction::decimate:
+        w.value = v;
+        break;
+    case sample_reduction::mean:
+    case sample_reduction::rms:
+        w.value += v;
+        break;
+    case sample_reduction::min:
+        w.value = w.count? std::min(w.value, v): v;
+        break;
+    case sample_reduction::max:
+        w.value = w.count? std::max(w.value, v): v;
+        break;
+    }
+    w.count += n;
+}
+
+double reduced_sample(sample_reduction op, const sample_window& w) {
+    switch (op) {
+    case sample_reduction::mean:
+        return w.value/w.count;
+    case sample_reduction::rms:
+        return std::sqrt(w.value/w.count);
+    default:
+        return w.value;
+    }
+}
+
+void run_reduced_samples(
+    const scheduled_sampler& ss,
+    const fvm_value_type* raw_times,
+    const fvm_value_type* raw_samples,
+    std::vector<time_type>& time_scratch,
+    std::vector<double>& value_scratch,
+    std::vector<sample_record>& sample_records)
+{
+    sampler_plan& plan = *ss.plan;
+    const sample_reducer& reducer = *plan.reducer;
+
+    auto offset = ss.begin_offset;
+    for (std::size_t i = 0; i<plan.probes.size(); ++i) {
+        sample_window& w = plan.windows[i];
+        auto n_windows = reduced_window_count(w, ss.n_times, reducer.window);
+
+        time_scratch.clear();
+        value_scratch.clear();
+
+        sample_size_type remaining = ss.n_times;
+        for (sample_size_type k = 0; k<n_windows; ++k, ++offset) {
+            unsigned n = std::min<sample_size_type>(remaining, reducer.window-w.count);
+            remaining -= n;
+
+            combine_sample(reducer.op, w, raw_samples[offset], n);
+            if (w.count==reducer.window) {
+                time_scratch.push_back(raw_times[offset]);
+                value_scratch.push_back(reduced_sample(reducer.op, w));
+                w = sample_window{};
+            }
+        }
+
+        if (value_scratch.empty()) continue;
+
+        sample_records.clear();
+        const double* values = value_scratch.data();
+        for (std::size_t k = 0; k<value_scratch.size(); ++k) {
+            sample_records.push_back(sample_record{time_scratch[k], values+k});
+        }
+        plan.sampler(plan.meta[i], sample_records.size(), sample_records.data());
+    }
 }
 
 void mc_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& event_lanes) {
@@ -438,65 +639,113 @@ void mc_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& e
     // For each (schedule, sampler, probe set) in the sampler association
     // map that will be triggered in this integration interval, create
     // sample events for the lowered cell, one or more for each scheduled
-    // sample time and probe in the probe set.
+    // sample time and probe in the association's sampling plan.
     //
     // Each event is associated with an offset into the sample data and
     // time buffers; these are assigned contiguously such that one call to
     // a sampler callback can be represented by a `sampler_call_info`
-    // value as defined below, grouping together all the samples of the
-    // same probe for this callback in this association.
+    // value as defined above, grouping together all the samples of the
+    // same probe for this callback in this association. Reduced samplers
+    // instead have one offset per probe and reduction window, shared by the
+    // events for the samples in the window.
 
     PE(advance_samplesetup);
-    std::vector<sampler_call_info> call_info;
+    scheduled_samplers_.clear();
+    sample_times_.clear();
+    exact_sampling_events_.clear();
 
-    std::vector<sample_event> sample_events;
     sample_size_type n_samples = 0;
+    sample_size_type n_events = 0;
     sample_size_type max_samples_per_call = 0;
 
-    std::vector<deliverable_event> exact_sampling_events;
-
     {
         std::lock_guard<std::mutex> guard(sampler_mex_);
 
         for (auto& sm_entry: sampler_map_) {
-            // Ignore sampler_association_handle, just need the association itself.
-            sampler_association& sa = sm_entry.second;
+            mc_sampler_association& sa = sm_entry.second;
 
-            auto sample_times = util::make_range(sa.sched.events(tstart, ep.t1));
-            if (sample_times.empty()) {
+            auto sample_times = sa.sched.events(tstart, ep.t1);
+            sample_size_type n_times = sample_times.second-sample_times.first;
+            if (!n_times || sa.plan->probes.empty()) {
                 continue;
             }
 
-            sample_size_type n_times = sample_times.size();
             max_samples_per_call = std::max(max_samples_per_call, n_times);
+            scheduled_samplers_.push_back({sa.plan, sample_size_type(sample_times_.size()), n_times, sa.policy, n_samples});
+            sample_times_.insert(sample_times_.end(), sample_times.first, sample_times.second);
+
+            // Reduced samplers take one sample event per probe and sample
+            // time, and have one offset per reduction window.
+            if (const auto& reducer = sa.plan->reducer) {
+                n_events += n_times*sa.plan->probes.size();
+                for (const sample_window& w: sa.plan->windows) {
+                    n_samples += reduced_window_count(w, n_times, reducer->window);
+                }
+            }
+            else {
+                n_events += n_times*sa.plan->n_raw;
+                n_samples += n_times*sa.plan->n_raw;
+            }
+        }
+    }
+
+    // Plans are shared with the sampler map, and sample times are copied
+    // from the schedule: both are unaffected by removal of the association
+    // during sampler callbacks or from other threads.
 
-            for (cell_member_type pid: sa.probe_ids) {
-                auto cell_index = gid_index_map_.at(pid.gid);
-
-                probe_tag tag = probe_map_.tag.at(pid);
-                unsigned index = 0;
-                for (const fvm_probe_data& pdata: probe_map_.data_on(pid)) {
-                    call_info.push_back({sa.sampler, pid, tag, index++, &pdata, n_samples, n_samples + n_times*pdata.n_raw()});
-                    auto intdom = cell_to_intdom_[cell_index];
-
-                    for (auto t: sample_times) {
-                        for (probe_handle h: pdata.raw_handle_range()) {
-                            sample_event ev{t, (cell_gid_type)intdom, {h, n_samples++}};
-                            sample_events.push_back(ev);
-                        }
-                        if (sa.policy==sampling_policy::exact) {
-                            target_handle h(-1, 0, intdom);
-                            exact_sampling_events.push_back({t, h, 0.f});
-                        }
+    std::vector<sample_event> sample_events;
+    sample_events.reserve(n_events);
+
+    for (const scheduled_sampler& ss: scheduled_samplers_) {
+        const sampler_plan& plan = *ss.plan;
+        sample_size_type offset = ss.begin_offset;
+        for (std::size_t i = 0; i<plan.probes.size(); ++i) {
+            const sampler_plan_probe& probe = plan.probes[i];
+            auto intdom = (cell_gid_type)probe.intdom;
+            auto handles = probe.pdata->raw_handle_range();
+            auto linear = probe.pdata->linear_index_range();
+
+            // Samples in one reduction window share an offset.
+            raw_probe_info reduced{nullptr, 0};
+            sample_size_type window_count = 0, window = 0;
+            if (plan.reducer) {
+                reduced = reduced_probe_info(*probe.pdata, plan.reducer->op);
+                window_count = plan.windows[i].count;
+                window = plan.reducer->window;
+            }
+
+            sample_size_type j = 0;
+            for (auto t: util::subrange_view(sample_times_, ss.times_offset, ss.times_offset+ss.n_times)) {
+                if (plan.reducer) {
+                    auto k = window_count+j;
+                    reduced.offset = offset+k/window;
+                    reduced.first = j==0 || k%window==0;
+                    sample_events.push_back(sample_event{t, intdom, reduced});
+                    ++j;
+                }
+                else if (linear.empty()) {
+                    for (probe_handle h: handles) {
+                        sample_events.push_back(sample_event{t, intdom, {h, offset++}});
                     }
                 }
+                else {
+                    for (fvm_index_type k: linear) {
+                        sample_events.push_back(sample_event{t, intdom, {nullptr, offset++, k}});
+                    }
+                }
+                if (ss.policy==sampling_policy::exact) {
+                    exact_sampling_events_.push_back({t, target_handle(-1, 0, intdom), 0.f});
+                }
+            }
+            if (plan.reducer) {
+                offset += reduced_window_count(plan.windows[i], ss.n_times, window);
             }
-            arb_assert(n_samples==call_info.back().end_offset);
         }
     }
+    arb_assert(n_events==(sample_size_type)sample_events.size());
 
     // Sort exact sampling events into staged events for delivery.
-    if (exact_sampling_events.size()) {
+    if (exact_sampling_events_.size()) {
         auto event_less =
             [](const auto& a, const auto& b) {
                  auto ai = event_index(a);
@@ -504,28 +753,31 @@ void mc_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& e
                  return ai<bi || (ai==bi && event_time(a)<event_time(b));
             };
 
-        util::sort(exact_sampling_events, event_less);
+        util::sort(exact_sampling_events_, event_less);
 
         std::vector<deliverable_event> merged;
-        merged.reserve(staged_events_.size()+exact_sampling_events.size());
+        merged.reserve(staged_events_.size()+exact_sampling_events_.size());
 
         std::merge(staged_events_.begin(), staged_events_.end(),
-                   exact_sampling_events.begin(), exact_sampling_events.end(),
+                   exact_sampling_events_.begin(), exact_sampling_events_.end(),
                    std::back_inserter(merged), event_less);
         std::swap(merged, staged_events_);
     }
 
-    // Sample events must be ordered by time for the lowered cell.
-    util::sort_by(sample_events, [](const sample_event& ev) { return event_time(ev); });
-    util::stable_sort_by(sample_events, [](const sample_event& ev) { return event_index(ev); });
+    // Sample events must be ordered by integration domain and time for the
+    // lowered cell. The sort is stable so that events for one probe at one
+    // time keep their consecutive handles and offsets, and can be taken with
+    // block copies.
+    util::stable_sort_by(sample_events, [](const sample_event& ev) { return std::make_pair(event_index(ev), event_time(ev)); });
     PL();
 
     // Run integration and collect samples, spikes.
     auto result = lowered_->integrate(ep.t1, dt, staged_events_, std::move(sample_events));
 
-    // For each sampler callback registered in `call_info`, construct the
-    // vector of sample entries from the lowered cell sample times and values
-    // and then call the callback.
+    // For each scheduled sampler, construct the vector of sample entries for
+    // each probe from the lowered cell sample times and values and then call
+    // the callback, or for bulk samplers, call the callback with all probes.
+    // Reduced samplers are called with the reduced samples of each probe.
 
     PE(advance_sampledeliver);
     std::vector<sample_record> sample_records;
@@ -534,9 +786,32 @@ void mc_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& e
     fvm_probe_scratch scratch;
     reserve_scratch(scratch, max_samples_per_call);
 
-    for (auto& sc: call_info) {
-        run_samples(sc, result.sample_time.data(), result.sample_value.data(), sample_records, scratch);
+    std::vector<time_type> time_scratch;
+    std::vector<double> value_scratch;
+
+    for (const scheduled_sampler& ss: scheduled_samplers_) {
+        const sampler_plan& plan = *ss.plan;
+        if (plan.bulk_sampler) {
+            run_bulk_samples(ss, result.sample_time.data(), result.sample_value.data(), time_scratch, value_scratch);
+            continue;
+        }
+        if (plan.reducer) {
+            run_reduced_samples(ss, result.sample_time.data(), result.sample_value.data(), time_scratch, value_scratch, sample_records);
+            continue;
+        }
+
+        sample_size_type n_times = ss.n_times;
+        for (std::size_t i = 0; i<plan.probes.size(); ++i) {
+            const sampler_plan_probe& probe = plan.probes[i];
+            sampler_call_info sc{&plan, i,
+                ss.begin_offset+n_times*probe.raw_offset,
+                ss.begin_offset+n_times*(probe.raw_offset+probe.pdata->n_raw())};
+
+            run_samples(sc, result.sample_time.data(), result.sample_value.data(), sample_records, scratch);
+        }
     }
+    scheduled_samplers_.clear();
+    sample_times_.clear();
     PL();
 
     // Copy out spike voltage threshold crossings from the back end, then
@@ -549,16 +824,66 @@ void mc_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& e
     }
 }
 
+std::shared_ptr<sampler_plan> mc_cell_group::make_sampler_plan(cell_member_predicate probe_ids, bool scalar_only) {
+    auto plan = std::make_shared<sampler_plan>();
+
+    for (cell_member_type pid: util::filter(util::keys(probe_map_.tag), probe_ids)) {
+        auto intdom = cell_to_intdom_[gid_index_map_.at(pid.gid)];
+        probe_tag tag = probe_map_.tag.at(pid);
+
+        unsigned index = 0;
+        for (const fvm_probe_data& pdata: probe_map_.data_on(pid)) {
+            probe_metadata meta{pid, tag, index++, pdata.get_metadata_ptr()};
+            if (scalar_only) {
+                if (!is_bulk_sampleable(pdata)) continue;
+                plan->bulk_direct &= pdata.n_raw()==1;
+            }
+
+            plan->probes.push_back({&pdata, intdom, plan->n_raw});
+            plan->meta.push_back(meta);
+            plan->n_raw += pdata.n_raw();
+        }
+    }
+    return plan;
+}
+
 void mc_cell_group::add_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
                                 schedule sched, sampler_function fn, sampling_policy policy)
 {
     std::lock_guard<std::mutex> guard(sampler_mex_);
 
-    std::vector<cell_member_type> probeset =
-        util::assign_from(util::filter(util::keys(probe_map_.tag), probe_ids));
+    auto plan = make_sampler_plan(std::move(probe_ids), false);
+    if (!plan->probes.empty()) {
+        plan->sampler = std::move(fn);
+        auto result = sampler_map_.insert({h, mc_sampler_association{std::move(sched), policy, std::move(plan)}});
+        arb_assert(result.second);
+    }
+}
+
+void mc_cell_group::add_bulk_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
+                                     schedule sched, bulk_sampler_function fn, sampling_policy policy)
+{
+    std::lock_guard<std::mutex> guard(sampler_mex_);
+
+    auto plan = make_sampler_plan(std::move(probe_ids), true);
+    if (!plan->probes.empty()) {
+        plan->bulk_sampler = std::move(fn);
+        auto result = sampler_map_.insert({h, mc_sampler_association{std::move(sched), policy, std::move(plan)}});
+        arb_assert(result.second);
+    }
+}
+
+void mc_cell_group::add_reduced_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
+                                        schedule sched, sampler_function fn, sample_reducer reducer, sampling_policy policy)
+{
+    std::lock_guard<std::mutex> guard(sampler_mex_);
 
-    if (!probeset.empty()) {
-        auto result = sampler_map_.insert({h, sampler_association{std::move(sched), std::move(fn), std::move(probeset), policy}});
+    auto plan = make_sampler_plan(std::move(probe_ids), true);
+    if (!plan->probes.empty()) {
+        plan->sampler = std::move(fn);
+        plan->reducer = reducer;
+        plan->windows.resize(plan->probes.size());
+        auto result = sampler_map_.insert({h, mc_sampler_association{std::move(sched), policy, std::move(plan)}});
         arb_assert(result.second);
     }
 }
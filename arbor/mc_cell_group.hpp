@@ -3,7 +3,9 @@
 #include <cstdint>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -19,10 +21,56 @@
 #include "event_queue.hpp"
 #include "fvm_lowered_cell.hpp"
 #include "label_resolution.hpp"
-#include "sampler_map.hpp"
 
 namespace arb {
 
+// Sampling plan for a sampler association, computed once when the association
+// is added: the probes sampled, in the order in which their samples are laid
+// out in the lowered cell sample buffers, with their integration domains.
+
+struct sampler_plan_probe {
+    const fvm_probe_data* pdata;
+    fvm_index_type intdom;
+    sample_size_type raw_offset;         // Raw samples per sample time of preceding probes.
+};
+
+// Accumulated value and sample count for one probe in the current reduction window.
+struct sample_window {
+    double value = 0;
+    unsigned count = 0;
+};
+
+struct sampler_plan {
+    sampler_function sampler;            // Set for regular and reduced sampler associations,
+    bulk_sampler_function bulk_sampler;  // or for bulk sampler associations.
+
+    std::vector<sampler_plan_probe> probes;
+    std::vector<probe_metadata> meta;    // Metadata for each probe.
+    sample_size_type n_raw = 0;          // Raw samples per sample time over all probes.
+    bool bulk_direct = true;             // True if every probe has one raw sample per value.
+
+    std::optional<sample_reducer> reducer;
+
+    // Reduction windows, one per probe, carried over between epochs. These are
+    // only accessed by the owning cell group while advancing or resetting.
+    std::vector<sample_window> windows;
+};
+
+struct mc_sampler_association {
+    schedule sched;
+    sampling_policy policy;
+    std::shared_ptr<sampler_plan> plan;
+};
+
+// Sampler associations with samples in the current epoch.
+struct scheduled_sampler {
+    std::shared_ptr<sampler_plan> plan;
+    sample_size_type times_offset;       // Offset of first sample time in the group's sample times.
+    sample_size_type n_times;            // Number of sample times in the epoch.
+    sampling_policy policy;
+    sample_size_type begin_offset;       // Offset of first raw sample in sample buffers.
+};
+
 class mc_cell_group: public cell_group {
 public:
     mc_cell_group() = default;
@@ -54,6 +102,12 @@ public:
     void add_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
                      schedule sched, sampler_function fn, sampling_policy policy) override;
 
+    void add_bulk_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
+                          schedule sched, bulk_sampler_function fn, sampling_policy policy) override;
+
+    void add_reduced_sampler(sampler_association_handle h, cell_member_predicate probe_ids,
+                             schedule sched, sampler_function fn, sample_reducer reducer, sampling_policy policy) override;
+
     void remove_sampler(sampler_association_handle h) override;
 
     void remove_all_samplers() override;
@@ -61,6 +115,9 @@ public:
     std::vector<probe_metadata> get_probe_metadata(cell_member_type probe_id) const override;
 
 private:
+    // Build sampling plan for probes matching predicate, optionally only those with scalar values.
+    std::shared_ptr<sampler_plan> make_sampler_plan(cell_member_predicate probe_ids, bool scalar_only);
+
     // List of the gids of the cells in the group.
     std::vector<cell_gid_type> gids_;
 
@@ -95,7 +152,13 @@ private:
     probe_association_map probe_map_;
 
     // Collection of samplers to be run against probes in this group.
-    sampler_association_map sampler_map_;
+    std::unordered_map<sampler_association_handle, mc_sampler_association> sampler_map_;
+
+    // Samplers scheduled in the current epoch, their sample times copied
+    // from the schedules, and sample event buffer.
+    std::vector<scheduled_sampler> scheduled_samplers_;
+    std::vector<time_type> sample_times_;
+    std::vector<deliverable_event> exact_sampling_events_;
 
     // Mutex for thread-safe access to sampler associations.
     std::mutex sampler_mex_;
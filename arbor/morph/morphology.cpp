@@ -10,6 +10,7 @@
 #include <arbor/morph/primitives.hpp>
 
 #include "io/sepval.hpp"
+#include "morph/mprovider_cache.hpp"
 #include "util/mergeview.hpp"
 #include "util/rangeutil.hpp"
 #include "util/span.hpp"
@@ -140,7 +141,8 @@ std::ostream& operator<<(std::ostream& o, const morphology_impl& m) {
 //
 
 morphology::morphology(segment_tree m):
-    impl_(std::make_shared<const morphology_impl>(std::move(m)))
+    impl_(std::make_shared<const morphology_impl>(std::move(m))),
+    cache_(std::make_shared<mprovider_cache>())
 {}
 
 morphology::morphology():
@@ -1,6 +1,16 @@
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
+#include <arbor/cable_cell.hpp>
+#include <arbor/cv_policy.hpp>
 #include <arbor/morph/label_dict.hpp>
 #include <arbor/morph/locset.hpp>
 #include <arbor/morph/morphexcept.hpp>
@@ -9,14 +19,103 @@
 #include <arbor/morph/region.hpp>
 #include <arbor/util/expected.hpp>
 
+#include "morph/mprovider_cache.hpp"
+
 namespace arb {
 
+namespace {
+// Stream buffer appending to a string, which is cleared rather than released
+// between keys, so that printing a key does not allocate once the string has
+// grown to hold it.
+struct key_buffer: std::streambuf {
+    std::string text;
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!traits_type::eq_int_type(c, traits_type::eof())) text.push_back(traits_type::to_char_type(c));
+        return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char* s, std::streamsize n) override {
+        text.append(s, n);
+        return n;
+    }
+};
+
+// Printed form of a key in a per-thread buffer, with enough digits to
+// distinguish any two values of the parameters of an expression. The
+// returned view is valid until the next key is printed on the thread.
+template <typename... Parts>
+std::string_view print_key(const Parts&... parts) {
+    struct printer {
+        key_buffer buf;
+        std::ostream out{&buf};
+        printer() { out.precision(std::numeric_limits<double>::max_digits10); }
+    };
+    thread_local printer p;
+
+    p.buf.text.clear();
+    (p.out << ... << parts);
+    return p.buf.text;
+}
+
+// Definitions of a label dictionary, printed in name order.
+template <typename Map>
+struct sorted_defs_printer {
+    const Map& map;
+
+    friend std::ostream& operator<<(std::ostream& o, const sorted_defs_printer& d) {
+        std::vector<const typename Map::value_type*> defs;
+        for (const auto& pair: d.map) defs.push_back(&pair);
+        std::sort(defs.begin(), defs.end(), [](auto a, auto b) { return a->first<b->first; });
+        for (auto def: defs) o << '"' << def->first << "\" " << def->second << '\n';
+        return o;
+    }
+};
+
+template <typename Map>
+sorted_defs_printer<Map> sorted_defs(const Map& map) { return {map}; }
+
+template <typename Expr>
+std::string_view expr_key(unsigned dictionary_id, const Expr& expr) {
+    return print_key(dictionary_id, ' ', expr);
+}
+
+// Look up key in the cache, or evaluate and insert it. Evaluation is done
+// without the lock held, as it may look up other expressions, and so print
+// other keys; concurrent evaluations of the same key give the same value.
+template <typename Value, typename Eval>
+Value cached(std::mutex& mutex, lru_cache<Value>& cache, std::string_view key, Eval&& eval) {
+    auto hash = std::hash<std::string_view>{}(key);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (auto p = cache.find(hash, key)) return *p;
+    }
+
+    std::string saved(key);
+    Value value = eval();
+    std::lock_guard<std::mutex> lock(mutex);
+    return cache.insert(hash, saved, std::move(value));
+}
+} // anonymous namespace
+
 void mprovider::init() {
     // Evaluate each named region or locset in provided dictionary
     // to populate concrete regions_, locsets_ maps.
 
     if (!label_dict_ptr) return;
 
+    // Identify the dictionary by its definitions.
+    auto key = print_key(sorted_defs(label_dict_ptr->regions()), '\n', sorted_defs(label_dict_ptr->locsets()));
+    auto hash = std::hash<std::string_view>{}(key);
+
+    auto& cache = *morphology_.cache_;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        auto p = cache.dictionaries.find(hash, key);
+        dictionary_id_ = p? *p: cache.dictionaries.insert(hash, key, cache.next_dictionary_id++);
+    }
+
     for (const auto& pair: label_dict_ptr->regions()) {
         (void)region(pair.first);
     }
@@ -36,8 +135,8 @@ void mprovider::init() {
 // label_dict_ptr will be null, and concrete regions/locsets will only be retrieved
 // from the maps established during initialization.
 
-template <typename RegOrLocMap, typename LabelDictMap>
-static const auto& try_lookup(const mprovider& provider, const std::string& name, RegOrLocMap& map, const LabelDictMap* dict_ptr) {
+template <typename RegOrLocMap, typename LabelDictMap, typename Eval>
+static const auto& try_lookup(const std::string& name, RegOrLocMap& map, const LabelDictMap* dict_ptr, Eval&& eval) {
     auto it = map.find(name);
     if (it==map.end()) {
         if (dict_ptr) {
@@ -48,7 +147,7 @@ static const auto& try_lookup(const mprovider& provider, const std::string& name
                 throw unbound_name(name);
             }
 
-            return (map[name] = thingify(it->second, provider)).value();
+            return (map[name] = eval(it->second)).value();
         }
         else {
             throw unbound_name(name);
@@ -62,15 +161,45 @@ static const auto& try_lookup(const mprovider& provider, const std::string& name
     }
 }
 
+// The value of a named region or locset is shared through the cache under the
+// key of the named expression, which evaluates to the same.
+
 const mextent& mprovider::region(const std::string& name) const {
     const auto* regions_ptr = label_dict_ptr? &(label_dict_ptr->regions()): nullptr;
-    return try_lookup(*this, name, regions_, regions_ptr);
+    auto& cache = *morphology_.cache_;
+    return try_lookup(name, regions_, regions_ptr,
+        [&](const arb::region& r) {
+            return cached(cache.mutex, cache.regions, expr_key(dictionary_id_, reg::named(name)),
+                [&] { return thingify(r, *this); });
+        });
 }
 
 const mlocation_list& mprovider::locset(const std::string& name) const {
     const auto* locsets_ptr = label_dict_ptr? &(label_dict_ptr->locsets()): nullptr;
-    return try_lookup(*this, name, locsets_, locsets_ptr);
+    auto& cache = *morphology_.cache_;
+    return try_lookup(name, locsets_, locsets_ptr,
+        [&](const arb::locset& l) {
+            return cached(cache.mutex, cache.locsets, expr_key(dictionary_id_, ls::named(name)),
+                [&] { return thingify(l, *this); });
+        });
+}
+
+mextent mprovider::concrete_region(const arb::region& r) const {
+    auto& cache = *morphology_.cache_;
+    return cached(cache.mutex, cache.regions, expr_key(dictionary_id_, r),
+        [&] { return thingify(r, *this); });
 }
 
+mlocation_list mprovider::concrete_locset(const arb::locset& l) const {
+    auto& cache = *morphology_.cache_;
+    return cached(cache.mutex, cache.locsets, expr_key(dictionary_id_, l),
+        [&] { return thingify(l, *this); });
+}
+
+mlocation_list mprovider::concrete_cv_boundary_points(const cv_policy& policy, const cable_cell& cell) const {
+    auto& cache = *morphology_.cache_;
+    return cached(cache.mutex, cache.cv_boundaries, print_key(dictionary_id_, ' ', policy),
+        [&] { return thingify(policy.cv_boundary_points(cell), *this); });
+}
 
 } // namespace arb
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include <arbor/morph/morphology.hpp>
+#include <arbor/morph/primitives.hpp>
+
+namespace arb {
+
+// Values of at most capacity keys, evicting the least recently used. Keys are
+// looked up by their hash, and compared in full only when the hashes match.
+template <typename Value>
+class lru_cache {
+public:
+    explicit lru_cache(std::size_t capacity): capacity_(capacity) {}
+
+    // Value held under key, which becomes the most recently used, or null.
+    const Value* find(std::size_t hash, std::string_view key) {
+        auto i = lookup(hash, key);
+        if (i==entries_.end()) return nullptr;
+        entries_.splice(entries_.begin(), entries_, i);
+        return &i->value;
+    }
+
+    // Insert value under key if the key is not present. Returns the value
+    // held under key.
+    const Value& insert(std::size_t hash, std::string_view key, Value value) {
+        if (auto p = find(hash, key)) return *p;
+
+        if (entries_.size()>=capacity_ && !entries_.empty()) {
+            auto& last = entries_.back();
+            auto [b, e] = index_.equal_range(last.hash);
+            for (; b!=e; ++b) {
+                if (&*b->second==&last) {
+                    index_.erase(b);
+                    break;
+                }
+            }
+            entries_.pop_back();
+        }
+
+        entries_.push_front({hash, std::string(key), std::move(value)});
+        index_.emplace(hash, entries_.begin());
+        return entries_.front().value;
+    }
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t capacity() const { return capacity_; }
+
+private:
+    struct entry {
+        std::size_t hash;
+        std::string key;
+        Value value;
+    };
+    using iterator = typename std::list<entry>::iterator;
+
+    std::size_t capacity_;
+    // Most recently used first.
+    std::list<entry> entries_;
+    std::unordered_multimap<std::size_t, iterator> index_;
+
+    iterator lookup(std::size_t hash, std::string_view key) {
+        auto [b, e] = index_.equal_range(hash);
+        for (; b!=e; ++b) {
+            if (b->second->key==key) return b->second;
+        }
+        return entries_.end();
+    }
+};
+
+// Concrete regions, locsets and CV boundary points evaluated on a morphology,
+// shared by the mproviders of all copies of the morphology.
+//
+// Label dictionaries are identified by an integer, assigned to each distinct
+// printed form of the dictionary and never reused. Expressions are keyed by
+// the dictionary against which they are evaluated and their printed form,
+// and CV policies likewise.
+// Each map holds at most mprovider_cache_capacity entries.
+
+constexpr std::size_t mprovider_cache_capacity = 4096;
+
+struct mprovider_cache {
+    std::mutex mutex;
+    unsigned next_dictionary_id = 1;
+    lru_cache<unsigned> dictionaries{mprovider_cache_capacity};
+    lru_cache<mextent> regions{mprovider_cache_capacity};
+    lru_cache<mlocation_list> locsets{mprovider_cache_capacity};
+    lru_cache<mlocation_list> cv_boundaries{mprovider_cache_capacity};
+};
+
+} // namespace arb
@@ -1,48 +1,297 @@
+#include <any>
+#include <cmath>
+#include <optional>
 #include <queue>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
 #include <arbor/arbexcept.hpp>
+#include <arbor/cable_cell.hpp>
+#include <arbor/cv_policy.hpp>
 #include <arbor/domain_decomposition.hpp>
 #include <arbor/load_balance.hpp>
+#include <arbor/profile/timer.hpp>
 #include <arbor/recipe.hpp>
 #include <arbor/symmetric_recipe.hpp>
 #include <arbor/context.hpp>
 
 #include "cell_group_factory.hpp"
+#include "domain_balance.hpp"
 #include "execution_context.hpp"
+#include "gid_domain_map.hpp"
 #include "gpu_context.hpp"
+#include "graph_partition.hpp"
+#include "profile/profiler_macro.hpp"
+#include "threading/threading.hpp"
 #include "util/maputil.hpp"
 #include "util/partition.hpp"
+#include "util/rangeutil.hpp"
 #include "util/span.hpp"
 #include "util/strprintf.hpp"
 
 namespace arb {
 
-domain_decomposition partition_load_balance(
+namespace {
+// Estimate the relative cost of simulating a cell, if not supplied by the
+// recipe. Cable cells cost in proportion to the number of CVs and density
+// mechanisms, plus the number of synapses; other cells have unit cost. Each
+// incoming connection adds unit cost for event delivery.
+double estimate_cell_cost(const recipe& rec, cell_gid_type gid, const std::optional<cv_policy>& global_discretization) {
+    double cost = rec.get_cell_cost(gid);
+    if (cost>0) return cost;
+
+    cost = 1;
+    if (rec.get_cell_kind(gid)==cell_kind::cable) {
+        cable_cell cell;
+        try {
+            cell = util::any_cast<cable_cell&&>(rec.get_cell_description(gid));
+        }
+        catch (std::bad_any_cast&) {
+            throw bad_cell_description(cell_kind::cable, gid);
+        }
+
+        const auto& dflt = cell.default_parameters();
+        cv_policy policy = dflt.discretization? *dflt.discretization:
+                           global_discretization? *global_discretization:
+                           default_cv_policy();
+        std::size_t n_cv = std::max<std::size_t>(1, cell.provider().concrete_cv_boundary_points(policy, cell).size());
+        std::size_t n_density = cell.region_assignments().get<mechanism_desc>().size();
+        std::size_t n_synapse = 0;
+        for (const auto& [name, synapses]: cell.synapses()) {
+            n_synapse += synapses.size();
+        }
+        cost = n_cv*(1+n_density) + n_synapse;
+    }
+    return cost + rec.connections_on(gid).size();
+}
+
+// Divide gids among domains in contiguous ranges of near equal total cost,
+// as by local_cost_divisions. Returns the gid divisions, or nothing if the
+// cells have no cost, or if the gathered divisions are inconsistent.
+std::optional<std::vector<cell_gid_type>> balance_domain_costs(
+    const std::vector<double>& local_costs,
+    cell_gid_type first,
+    cell_gid_type num_cells,
+    const distributed_context& dist)
+{
+    unsigned num_domains = dist.size();
+    auto totals = dist.gather_all(util::sum(local_costs, 0.));
+    if (!(util::sum(totals, 0.)>0)) return std::nullopt;
+
+    auto local_divisions = local_cost_divisions(totals, dist.id(), local_costs, first);
+    auto divisions = dist.gather_gids(local_divisions).values();
+    if (divisions.size()+1!=num_domains) return std::nullopt;
+
+    divisions.insert(divisions.begin(), 0);
+    divisions.push_back(num_cells);
+    if (!std::is_sorted(divisions.begin(), divisions.end())) return std::nullopt;
+    return divisions;
+}
+
+// Division of cells among domains by graph partition.
+struct graph_division {
+    // Domain of each gid.
+    std::vector<int> domains;
+    // Cost of each gid, as used for the partition.
+    std::vector<cell_gid_type> weights;
+};
+
+// Divide cells among domains by partitioning the graph of connections, with
+// cells connected by gap junctions contracted to single vertices, so as to
+// minimise the number of connections between domains while balancing cost.
+// Each domain supplies the costs of the cells [first, first+local_costs.size())
+// in a contiguous division of all cells, and contracts its part of the graph
+// before it is gathered on every domain, where it is partitioned identically.
+//
+// Vertex weights are costs scaled to integers, with the most costly cell
+// having weight 1000. Returns nothing if the cells have no cost, if the graph
+// has more than partition_graph_max_edges edges, or if the gathered graph is
+// inconsistent.
+std::optional<graph_division> partition_domain_graph(
     const recipe& rec,
-    const context& ctx,
-    partition_hint_map hint_map)
+    const std::vector<double>& local_costs,
+    cell_gid_type first,
+    cell_gid_type num_cells,
+    const distributed_context& dist,
+    threading::task_system* thread_pool)
 {
-    const bool gpu_avail = ctx->gpu->has_gpu();
+    constexpr double weight_scale = 1000;
+
+    double max_cost = dist.max(util::max_value(local_costs));
+    if (!(max_cost>0)) return std::nullopt;
+
+    const std::size_t n_local = local_costs.size();
+    std::vector<cell_gid_type> local_weights(n_local);
+    std::vector<std::vector<cell_gid_type>> sources(n_local), peers(n_local);
+    threading::parallel_for::apply(0, n_local, thread_pool,
+        [&](int i) {
+            cell_gid_type gid = first+i;
+            local_weights[i] = std::max<cell_gid_type>(1, std::lround(local_costs[i]*weight_scale/max_cost));
+            for (const auto& c: rec.connections_on(gid)) sources[i].push_back(c.source.gid);
+            for (const auto& gj: rec.gap_junctions_on(gid)) peers[i].push_back(gj.peer.gid);
+        });
+
+    auto local = make_local_cell_graph(first, sources, peers);
+    if (dist.sum(local.num_edges())>partition_graph_max_edges) return std::nullopt;
+
+    graph_division division;
+    division.weights = dist.gather_gids(local_weights).values();
+
+    local_cell_graph gathered;
+    gathered.roots = dist.gather_gids(local.roots).values();
+    gathered.source = dist.gather_gids(local.source).values();
+    gathered.target = dist.gather_gids(local.target).values();
+    gathered.weight = dist.gather_gids(local.weight).values();
+    gathered.peer = dist.gather_gids(local.peer).values();
+    gathered.cell = dist.gather_gids(local.cell).values();
+    if (division.weights.size()!=num_cells || gathered.roots.size()!=num_cells) return std::nullopt;
+
+    division.domains = partition_cell_graph(division.weights, gathered, dist.size());
+    return division;
+}
+} // namespace
 
-    struct partition_gid_domain {
-        partition_gid_domain(const gathered_vector<cell_gid_type>& divs, unsigned domains) {
-            auto rank_part = util::partition_view(divs.partition());
-            for (auto rank: count_along(rank_part)) {
-                for (auto gid: util::subrange_view(divs.values(), rank_part[rank])) {
-                    gid_map[gid] = rank;
-                }
-            }
+std::vector<cell_gid_type> local_cost_divisions(
+    const std::vector<double>& domain_totals,
+    unsigned domain_id,
+    const std::vector<double>& local_costs,
+    cell_gid_type first)
+{
+    unsigned num_domains = domain_totals.size();
+    double total = 0, offset = 0;
+    for (unsigned i = 0; i<num_domains; ++i) {
+        if (i==domain_id) offset = total;
+        total += domain_totals[i];
+    }
+
+    // Find the first gid of each domain whose share starts in our costs.
+    std::vector<cell_gid_type> divisions;
+    double end = offset + domain_totals[domain_id];
+    double cum = offset;
+    std::size_t i = 0;
+    for (unsigned d = 1; d<num_domains; ++d) {
+        double target = total*d/num_domains;
+        if (target<offset) continue;
+        if (target>=end) break;
+
+        while (i<local_costs.size() && cum+local_costs[i]/2<target) {
+            cum += local_costs[i++];
         }
+        divisions.push_back(first+i);
+    }
+    return divisions;
+}
 
-        int operator()(cell_gid_type gid) const {
-            return gid_map.at(gid);
+local_cell_graph make_local_cell_graph(
+    cell_gid_type first,
+    const std::vector<std::vector<cell_gid_type>>& sources,
+    const std::vector<std::vector<cell_gid_type>>& peers)
+{
+    const std::size_t n = sources.size();
+    auto is_local = [&](cell_gid_type gid) { return gid>=first && gid-first<n; };
+
+    // Contract local cells connected by gap junctions, labelling each
+    // component by its smallest gid.
+    local_cell_graph g;
+    auto& root = g.roots;
+    for (auto i: util::make_span(n)) root.push_back(first+i);
+    auto find = [&](cell_gid_type gid) {
+        while (root[gid-first]!=gid) gid = root[gid-first] = root[root[gid-first]-first];
+        return gid;
+    };
+    for (auto i: util::make_span(n)) {
+        for (auto peer: peers[i]) {
+            if (!is_local(peer)) {
+                g.peer.push_back(peer);
+                g.cell.push_back(first+i);
+                continue;
+            }
+            auto a = find(peer), b = find(first+i);
+            if (a!=b) root[std::max(a, b)-first] = std::min(a, b);
+        }
+    }
+    for (auto i: util::make_span(n)) root[i] = find(first+i);
+
+    // Merge repeated connections between contracted cells.
+    std::vector<std::pair<cell_gid_type, cell_gid_type>> edges;
+    for (auto i: util::make_span(n)) {
+        for (auto src: sources[i]) {
+            auto a = is_local(src)? root[src-first]: src;
+            if (a!=root[i]) edges.emplace_back(a, root[i]);
         }
+    }
+    util::sort(edges);
+    for (std::size_t k = 0; k<edges.size();) {
+        std::size_t j = k;
+        while (j<edges.size() && edges[j]==edges[k]) ++j;
+        g.source.push_back(edges[k].first);
+        g.target.push_back(edges[k].second);
+        g.weight.push_back(j-k);
+        k = j;
+    }
+    return g;
+}
 
-        std::unordered_map<cell_gid_type, int> gid_map;
+std::vector<int> partition_cell_graph(
+    const std::vector<cell_gid_type>& weights,
+    const local_cell_graph& gathered,
+    unsigned num_domains)
+{
+    const cell_gid_type num_cells = weights.size();
+
+    // Complete the contraction of cells connected by gap junctions, starting
+    // from the contraction within each domain.
+    std::vector<cell_gid_type> root = gathered.roots;
+    auto find = [&](cell_gid_type gid) {
+        while (root[gid]!=gid) gid = root[gid] = root[root[gid]];
+        return gid;
     };
+    for (auto k: util::make_span(gathered.peer.size())) {
+        if (gathered.peer[k]>=num_cells) continue;
+        auto a = find(gathered.peer[k]), b = find(gathered.cell[k]);
+        if (a!=b) root[std::max(a, b)] = std::min(a, b);
+    }
+
+    std::vector<unsigned> vertex(num_cells);
+    std::vector<weighted_graph::weight_type> vertex_weights;
+    for (auto gid: util::make_span(num_cells)) {
+        auto r = find(gid);
+        if (r==gid) {
+            vertex[gid] = vertex_weights.size();
+            vertex_weights.push_back(0);
+        }
+        else {
+            vertex[gid] = vertex[r];
+        }
+        vertex_weights[vertex[gid]] += weights[gid];
+    }
+
+    std::vector<unsigned> a, b;
+    std::vector<weighted_graph::weight_type> w;
+    for (auto k: util::make_span(gathered.source.size())) {
+        if (gathered.source[k]>=num_cells) continue;
+        a.push_back(vertex[gathered.source[k]]);
+        b.push_back(vertex[gathered.target[k]]);
+        w.push_back(gathered.weight[k]);
+    }
+
+    auto part = partition_graph(weighted_graph(std::move(vertex_weights), a, b, w), num_domains);
+
+    std::vector<int> domains(num_cells);
+    for (auto gid: util::make_span(num_cells)) {
+        domains[gid] = part[vertex[gid]];
+    }
+    return domains;
+}
+
+domain_decomposition partition_load_balance(
+    const recipe& rec,
+    const context& ctx,
+    partition_hint_map hint_map,
+    partition_strategy domain_strategy)
+{
+    const bool gpu_avail = ctx->gpu->has_gpu();
 
     struct cell_identifier {
         cell_gid_type id;
@@ -61,14 +310,138 @@ domain_decomposition partition_load_balance(
         return B + (dom<R);
     };
 
+    // Each phase is timed on this domain, whether or not it is profiled.
+    profile::phase_times times;
+    auto phase_start = profile::timer<>::tic();
+    auto end_phase = [&](const char* name) {
+        times.push_back({name, profile::timer<>::toc(phase_start)});
+        phase_start = profile::timer<>::tic();
+    };
+
     // Global load balance
 
+    PE(init_decompose_balance);
     std::vector<cell_gid_type> gid_divisions;
     auto gid_part = make_partition(
         gid_divisions, transform_view(make_span(num_domains), dom_size));
 
+    // With the cost or graph domain strategy, estimate the cost of the cells
+    // in the equal count division, and redivide the cells by cost, or by
+    // partition of the connection graph. The costs of local cells are kept
+    // for grouping, and are also needed if any kind is grouped by cost.
+
+    bool balance_graph = domain_strategy==partition_strategy::graph;
+    bool balance_cost = domain_strategy!=partition_strategy::count;
+    bool group_by_cost = std::any_of(hint_map.begin(), hint_map.end(),
+        [](const auto& h) { return h.second.strategy!=partition_strategy::count; });
+
+    std::optional<cv_policy> global_discretization;
+    if (balance_cost || group_by_cost) {
+        std::any rec_props = rec.get_global_properties(cell_kind::cable);
+        if (auto props = std::any_cast<cable_cell_global_properties>(&rec_props)) {
+            global_discretization = props->default_parameters.discretization;
+        }
+    }
+
+    auto thread_pool = ctx->thread_pool.get();
+    auto estimate_costs = [&](std::pair<cell_gid_type, cell_gid_type> range, const std::vector<double>& known, cell_gid_type known_first) {
+        std::vector<double> costs(range.second-range.first);
+        threading::parallel_for::apply(0, costs.size(), thread_pool,
+            [&](int i) {
+                cell_gid_type gid = range.first+i;
+                costs[i] = gid>=known_first && gid-known_first<known.size()?
+                    known[gid-known_first]:
+                    estimate_cell_cost(rec, gid, global_discretization);
+            });
+        return costs;
+    };
+
+    std::vector<double> local_costs;
+    std::optional<graph_division> graph;
+    if (balance_cost) {
+        auto count_range = gid_part[domain_id];
+        auto count_costs = estimate_costs(count_range, {}, 0);
+        if (balance_graph) {
+            graph = partition_domain_graph(rec, count_costs, count_range.first, num_global_cells, *ctx->distributed, thread_pool);
+        }
+        if (!graph) {
+            if (auto divisions = balance_domain_costs(count_costs, count_range.first, num_global_cells, *ctx->distributed)) {
+                gid_divisions = std::move(*divisions);
+                gid_part = util::partition_view(gid_divisions);
+            }
+            local_costs = estimate_costs(gid_part[domain_id], count_costs, count_range.first);
+        }
+    }
+    else if (group_by_cost) {
+        local_costs = estimate_costs(gid_part[domain_id], {}, 0);
+    }
+
+    // Cost of a cell, which may be outside the local range if it belongs to
+    // a super cell.
+    auto cell_cost = [&](cell_gid_type gid) -> double {
+        if (graph) return graph->weights[gid];
+
+        auto first = gid_part[domain_id].first;
+        return gid>=first && gid-first<local_costs.size()?
+            local_costs[gid-first]:
+            estimate_cell_cost(rec, gid, global_discretization);
+    };
+
+    // Cells assigned to this domain, and whether a gid is one of them.
+    auto is_domain_gid = [&](cell_gid_type gid) {
+        return graph?
+            graph->domains[gid]==(int)domain_id:
+            gid>=gid_part[domain_id].first && gid<gid_part[domain_id].second;
+    };
+
+    std::vector<cell_gid_type> domain_gids;
+    if (graph) {
+        for (auto gid: make_span(num_global_cells)) {
+            if (is_domain_gid(gid)) domain_gids.push_back(gid);
+        }
+    }
+    else {
+        util::assign(domain_gids, make_span(gid_part[domain_id]));
+    }
+    PL();
+    end_phase("init_decompose_balance");
+
     // Local load balance
 
+    // Query the recipe for the kind and gap junction peers of each cell in
+    // the domain in parallel; cells of super cells outside the domain are
+    // queried as they are found.
+    PE(init_decompose_query);
+    std::vector<cell_kind> domain_kinds(domain_gids.size());
+    std::vector<std::vector<cell_gid_type>> domain_peers(domain_gids.size());
+    threading::parallel_for::apply(0, domain_gids.size(), thread_pool,
+        [&](int i) {
+            domain_kinds[i] = rec.get_cell_kind(domain_gids[i]);
+            for (const auto& c: rec.gap_junctions_on(domain_gids[i])) {
+                domain_peers[i].push_back(c.peer.gid);
+            }
+        });
+    PL();
+    end_phase("init_decompose_query");
+
+    // Index of a gid in domain_gids, which is sorted, or -1 if not present.
+    auto domain_index = [&](cell_gid_type gid) -> std::ptrdiff_t {
+        auto it = std::lower_bound(domain_gids.begin(), domain_gids.end(), gid);
+        return it!=domain_gids.end() && *it==gid? it-domain_gids.begin(): -1;
+    };
+    auto gj_peers = [&](cell_gid_type gid) {
+        auto i = domain_index(gid);
+        if (i>=0) return domain_peers[i];
+        std::vector<cell_gid_type> peers;
+        for (const auto& c: rec.gap_junctions_on(gid)) peers.push_back(c.peer.gid);
+        return peers;
+    };
+    auto kind_of = [&](cell_gid_type gid) {
+        auto i = domain_index(gid);
+        return i>=0? domain_kinds[i]: rec.get_cell_kind(gid);
+    };
+
+    PE(init_decompose_group);
     std::vector<std::vector<cell_gid_type>> super_cells; //cells connected by gj
     std::vector<cell_gid_type> reg_cells; //independent cells
 
@@ -77,8 +450,9 @@ domain_decomposition partition_load_balance(
 
     // Connected components algorithm using BFS
     std::queue<cell_gid_type> q;
-    for (auto gid: make_span(gid_part[domain_id])) {
-        if (!rec.gap_junctions_on(gid).empty()) {
+    for (auto i: util::count_along(domain_gids)) {
+        auto gid = domain_gids[i];
+        if (!domain_peers[i].empty()) {
             // If cell hasn't been visited yet, must belong to new super_cell
             // Perform BFS starting from that cell
             if (!visited.count(gid)) {
@@ -90,11 +464,10 @@ domain_decomposition partition_load_balance(
                     q.pop();
                     cg.push_back(element);
                     // Adjacency list
-                    auto conns = rec.gap_junctions_on(element);
-                    for (auto c: conns) {
-                        if (!visited.count(c.peer.gid)) {
-                            visited.insert(c.peer.gid);
-                            q.push(c.peer.gid);
+                    for (auto peer: gj_peers(element)) {
+                        if (!visited.count(peer)) {
+                            visited.insert(peer);
+                            q.push(peer);
                         }
                     }
                 }
@@ -109,10 +482,10 @@ domain_decomposition partition_load_balance(
 
     // Sort super_cell groups and only keep those where the first element in the group belongs to domain
     super_cells.erase(std::remove_if(super_cells.begin(), super_cells.end(),
-            [gid_part, domain_id](std::vector<cell_gid_type>& cg)
+            [&is_domain_gid](std::vector<cell_gid_type>& cg)
             {
                 std::sort(cg.begin(), cg.end());
-                return cg.front() < gid_part[domain_id].first;
+                return !is_domain_gid(cg.front());
             }), super_cells.end());
 
     // Collect local gids that belong to this rank, and sort gids into kind lists
@@ -124,13 +497,13 @@ domain_decomposition partition_load_balance(
     std::unordered_map<cell_kind, std::vector<cell_identifier>> kind_lists;
     for (auto gid: reg_cells) {
         local_gids.push_back(gid);
-        kind_lists[rec.get_cell_kind(gid)].push_back({gid, false});
+        kind_lists[kind_of(gid)].push_back({gid, false});
     }
 
     for (unsigned i = 0; i < super_cells.size(); i++) {
-        auto kind = rec.get_cell_kind(super_cells[i].front());
+        auto kind = kind_of(super_cells[i].front());
         for (auto gid: super_cells[i]) {
-            if (rec.get_cell_kind(gid) != kind) {
+            if (kind_of(gid) != kind) {
                 throw gj_kind_mismatch(gid, super_cells[i].front());
             }
             local_gids.push_back(gid);
@@ -181,6 +554,58 @@ domain_decomposition partition_load_balance(
             group_size = hint.gpu_group_size;
         }
 
+        if (hint.strategy!=partition_strategy::count) {
+            // Divide the cells into as many groups as by count, with each
+            // cell or super cell assigned to the group in whose share of the
+            // total cost the midpoint of its cost lies.
+            const auto& cells = kind_lists[k];
+            std::vector<double> costs;
+            std::size_t n_cell = 0;
+            for (auto cell: cells) {
+                if (cell.is_super_cell) {
+                    double c = 0;
+                    for (auto gid: super_cells[cell.id]) c += cell_cost(gid);
+                    costs.push_back(c);
+                    n_cell += super_cells[cell.id].size();
+                }
+                else {
+                    costs.push_back(cell_cost(cell.id));
+                    ++n_cell;
+                }
+            }
+
+            std::size_t n_group = n_cell/group_size + (n_cell%group_size!=0);
+            n_group = std::min(std::max<std::size_t>(n_group, 1), cells.size());
+            double total = util::sum(costs, 0.);
+
+            std::vector<cell_gid_type> group_elements;
+            std::size_t group = 0;
+            double cum = 0;
+            for (auto i: make_span(cells.size())) {
+                std::size_t g = total>0?
+                    std::min<std::size_t>(n_group-1, std::floor((cum+costs[i]/2)*n_group/total)):
+                    i*n_group/cells.size();
+                cum += costs[i];
+
+                if (g!=group && !group_elements.empty()) {
+                    groups.push_back({k, std::move(group_elements), backend});
+                    group_elements.clear();
+                }
+                group = g;
+
+                if (cells[i].is_super_cell) {
+                    util::append(group_elements, super_cells[cells[i].id]);
+                }
+                else {
+                    group_elements.push_back(cells[i].id);
+                }
+            }
+            if (!group_elements.empty()) {
+                groups.push_back({k, std::move(group_elements), backend});
+            }
+            continue;
+        }
+
         std::vector<cell_gid_type> group_elements;
         // group_elements are sorted such that the gids of all members of a super_cell are consecutive.
         for (auto cell: kind_lists[k]) {
@@ -205,11 +630,10 @@ domain_decomposition partition_load_balance(
         }
     }
 
-    cell_size_type num_local_cells = local_gids.size();
+    PL();
+    end_phase("init_decompose_group");
 
-    // Exchange gid list with all other nodes
-    // global all-to-all to gather a local copy of the global gid list on each node.
-    auto global_gids = ctx->distributed->gather_gids(local_gids);
+    cell_size_type num_local_cells = local_gids.size();
 
     domain_decomposition d;
     d.num_domains = num_domains;
@@ -217,8 +641,39 @@ domain_decomposition partition_load_balance(
     d.num_local_cells = num_local_cells;
     d.num_global_cells = num_global_cells;
     d.groups = std::move(groups);
-    d.gid_domain = partition_gid_domain(global_gids, num_domains);
 
+    // Every domain holds the domain of each gid, as runs of consecutive gids
+    // in the same domain: from the graph partition, or by exchanging the runs
+    // of local gids with all other domains.
+    PE(init_decompose_domains);
+    std::vector<gid_domain_map::run> runs;
+    if (graph) {
+        for (auto gid: make_span(num_global_cells)) {
+            int dom = graph->domains[gid];
+            if (!runs.empty() && runs.back().last==gid && runs.back().domain==dom) {
+                ++runs.back().last;
+            }
+            else {
+                runs.push_back({gid, gid+1, dom});
+            }
+        }
+    }
+    else {
+        util::sort(local_gids);
+        auto global_runs = ctx->distributed->gather_gids(gid_runs(local_gids));
+        auto rank_part = util::partition_view(global_runs.partition());
+        for (auto rank: count_along(rank_part)) {
+            auto bounds = util::subrange_view(global_runs.values(), rank_part[rank]);
+            for (std::size_t i = 0; i+1<bounds.size(); i += 2) {
+                runs.push_back({bounds[i], bounds[i+1], (int)rank});
+            }
+        }
+    }
+    d.gid_domain = gid_domain_map(std::move(runs), num_global_cells, num_domains);
+    PL();
+    end_phase("init_decompose_domains");
+
+    d.construction_times = std::move(times);
     return d;
 }
 
@@ -99,6 +99,14 @@ const std::vector<double>& meter_manager::times() const {
     return times_;
 }
 
+void meter_manager::record_phases(const phase_times& phases) {
+    phases_.insert(phases_.end(), phases.begin(), phases.end());
+}
+
+const phase_times& meter_manager::phases() const {
+    return phases_;
+}
+
 // Build a report of meters, for use at the end of a simulation
 // for output to file or analysis.
 meter_report make_meter_report(const meter_manager& manager, const context& ctx) {
@@ -127,6 +135,14 @@ meter_report make_meter_report(const meter_manager& manager, const context& ctx)
     report.num_domains = ctx->distributed->size();
     report.num_hosts = num_hosts;
 
+    // Gather the time taken by each recorded phase.
+    std::vector<double> phase_readings;
+    for (const auto& [name, time]: manager.phases()) {
+        report.phases.push_back(name);
+        phase_readings.push_back(time);
+    }
+    report.phase_times = measurement("phase-time", "s", phase_readings, ctx).measurements;
+
     return report;
 }
 
@@ -196,6 +212,17 @@ std::ostream& operator<<(std::ostream& o, const meter_report& report) {
     }
     o << "\n";
 
+    // Print the mean and maximum time per rank taken by each phase.
+    if (!report.phases.empty()) {
+        o << "\n---- phases -------------------------------------------------------------------------------\n";
+        o << strprintf("phase%20s%16s%16s", "", "mean(s)", "max(s)");
+        o << "\n-------------------------------------------------------------------------------------------\n";
+        for (std::size_t i = 0; i<report.phases.size(); ++i) {
+            const auto& times = report.phase_times[i];
+            o << strprintf("%-25s%16.3f%16.3f\n", report.phases[i], mean(times), util::max_value(times));
+        }
+    }
+
     return o;
 }
 
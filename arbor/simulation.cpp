@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <set>
 #include <vector>
 
@@ -6,6 +9,8 @@
 #include <arbor/context.hpp>
 #include <arbor/domain_decomposition.hpp>
 #include <arbor/generic_event.hpp>
+#include <arbor/profile/clock.hpp>
+#include <arbor/profile/timer.hpp>
 #include <arbor/recipe.hpp>
 #include <arbor/schedule.hpp>
 #include <arbor/simulation.hpp>
@@ -15,11 +20,14 @@
 #include "communication/communicator.hpp"
 #include "execution_context.hpp"
 #include "merge_events.hpp"
+#include "spike_statistics.hpp"
+#include "thread_assignment.hpp"
 #include "thread_private_spike_store.hpp"
 #include "threading/threading.hpp"
 #include "util/filter.hpp"
 #include "util/maputil.hpp"
 #include "util/partition.hpp"
+#include "util/rangeutil.hpp"
 #include "util/span.hpp"
 #include "profile/profiler_macro.hpp"
 
@@ -98,6 +106,12 @@ public:
     sampler_association_handle add_sampler(cell_member_predicate probe_ids,
         schedule sched, sampler_function f, sampling_policy policy = sampling_policy::lax);
 
+    sampler_association_handle add_sampler(cell_member_predicate probe_ids,
+        schedule sched, sampler_function f, sample_reducer reducer, sampling_policy policy = sampling_policy::lax);
+
+    sampler_association_handle add_bulk_sampler(cell_member_predicate probe_ids,
+        schedule sched, bulk_sampler_function f, sampling_policy policy = sampling_policy::lax);
+
     void remove_sampler(sampler_association_handle);
 
     void remove_all_samplers();
@@ -115,6 +129,30 @@ public:
     spike_export_function global_export_callback_;
     spike_export_function local_export_callback_;
 
+    std::optional<spike_statistics_accumulator> spike_stats_;
+
+    std::vector<population_statistics> spike_statistics() const;
+
+    std::vector<double> group_costs() const {
+        return group_total_cost_;
+    }
+
+    std::vector<double> cell_costs() const;
+
+    std::vector<unsigned> group_threads() const {
+        std::vector<unsigned> threads(thread_groups_.size());
+        for (std::size_t t = 0; t+1<thread_bounds_.size(); ++t) {
+            for (auto k = thread_bounds_[t]; k<thread_bounds_[t+1]; ++k) threads[thread_groups_[k]] = t;
+        }
+        return threads;
+    }
+
+    const profile::phase_times& construction_times() const {
+        return construction_times_;
+    }
+
+    double rebalance();
+
 private:
     // Record last computed epoch (integration interval).
     epoch epoch_;
@@ -124,6 +162,31 @@ private:
 
     std::vector<cell_group_ptr> cell_groups_;
 
+    // Time in seconds taken to advance each cell group over the last epoch,
+    // and in total; groups are advanced in decreasing order of the cost of
+    // the last epoch, so that the largest groups are not left until last.
+    std::vector<double> group_cost_;
+    std::vector<double> group_total_cost_;
+    std::vector<unsigned> group_order_;
+
+    // Time taken to advance each cell group since the last rebalance.
+    std::vector<double> group_window_cost_;
+
+    cell_size_type num_global_cells_ = 0;
+
+    // When the threads are bound to cores, thread t advances the groups
+    // thread_groups_[thread_bounds_[t]..thread_bounds_[t+1]). Until the
+    // first rebalance, each thread takes a contiguous block of groups.
+    // A group's state is allocated by the thread that constructs it, and
+    // stays where it is: on rebalance, a group is only reassigned to threads
+    // on the NUMA node of the thread that constructed it, group_nodes_[i].
+    std::vector<unsigned> thread_groups_;
+    std::vector<std::size_t> thread_bounds_;
+    std::vector<int> group_nodes_;
+
+    // Time spent in each phase of construction.
+    profile::phase_times construction_times_;
+
     // One set of event_generators for each local cell
     std::vector<std::vector<event_generator>> event_generators_;
 
@@ -136,8 +199,18 @@ private:
 
     communicator communicator_;
 
+    distributed_context_handle distributed_;
+
     task_system_handle task_system_;
 
+    // Parallel loops for each epoch: over cell groups in the update task,
+    // over cells in the enqueue task, and over the update and exchange tasks
+    // themselves. These are kept for the lifetime of the simulation, so that
+    // no tasks are allocated for each epoch.
+    threading::parallel_loop update_loop_;
+    threading::parallel_loop enqueue_loop_;
+    threading::parallel_loop epoch_loop_;
+
     // Pending events to be delivered.
     std::vector<pse_vector> pending_events_;
     std::array<std::vector<pse_vector>, 2> event_lanes_;
@@ -156,25 +229,59 @@ private:
     // Sampler associations handles are managed by a helper class.
     util::handle_set<sampler_association_handle> sassoc_handles_;
 
+    // Apply a functional to each cell group index in parallel. If the threads
+    // are bound to cores, each cell group is handled by the thread to which it
+    // is assigned, from construction on, so that its state is allocated local
+    // to that core.
+    template <typename L>
+    void foreach_group_span(L&& fn) {
+        if (task_system_->bound()) {
+            threading::parallel_loop loop(task_system_.get());
+            loop.run_pinned(thread_groups_, thread_bounds_, [&](std::size_t i) { fn(i); });
+        }
+        else {
+            threading::parallel_for::apply(0, cell_groups_.size(), task_system_.get(), std::forward<L>(fn));
+        }
+    }
+
+    // Apply a functional to each cell group in parallel, supplying the cell
+    // group pointer reference and index, and starting with the groups that
+    // took longest over the last epoch. Groups pinned to threads are not
+    // reordered, but are taken by other threads once those have finished
+    // their own groups, so that the update still overlaps with the spike
+    // exchange running on one of the threads.
+    template <typename L>
+    void foreach_group_by_cost(L&& fn) {
+        auto body = [&](std::size_t i) { fn(cell_groups_[i], i); };
+        if (task_system_->bound()) {
+            update_loop_.run_affine(thread_groups_, thread_bounds_, body);
+            return;
+        }
+        std::stable_sort(group_order_.begin(), group_order_.end(),
+            [this](unsigned a, unsigned b) { return group_cost_[a]>group_cost_[b]; });
+        update_loop_.run_ordered(group_order_, body);
+    }
+
     // Apply a functional to each cell group in parallel.
     template <typename L>
     void foreach_group(L&& fn) {
-        threading::parallel_for::apply(0, cell_groups_.size(), task_system_.get(),
-            [&, fn = std::forward<L>(fn)](int i) { fn(cell_groups_[i]); });
+        foreach_group_span([&, fn = std::forward<L>(fn)](int i) { fn(cell_groups_[i]); });
     }
 
     // Apply a functional to each cell group in parallel, supplying
     // the cell group pointer reference and index.
     template <typename L>
     void foreach_group_index(L&& fn) {
-        threading::parallel_for::apply(0, cell_groups_.size(), task_system_.get(),
-            [&, fn = std::forward<L>(fn)](int i) { fn(cell_groups_[i], i); });
+        foreach_group_span([&, fn = std::forward<L>(fn)](int i) { fn(cell_groups_[i], i); });
     }
 
-    // Apply a functional to each local cell in parallel.
+    // Apply a functional to each local cell in parallel, in the enqueue task.
     template <typename L>
     void foreach_cell(L&& fn) {
-        threading::parallel_for::apply(0, communicator_.num_local_cells(), task_system_.get(), fn);
+        // Take cells in chunks, with several chunks per thread for balance.
+        std::size_t n = communicator_.num_local_cells();
+        std::size_t grain = std::max<std::size_t>(1, n/(8*task_system_->get_num_threads()));
+        enqueue_loop_.run(n, [&](std::size_t i) { fn(i); }, grain);
     }
 };
 
@@ -183,11 +290,34 @@ simulation_state::simulation_state(
         const domain_decomposition& decomp,
         execution_context ctx
     ):
+    distributed_(ctx.distributed),
     task_system_(ctx.thread_pool),
+    update_loop_(ctx.thread_pool.get()),
+    enqueue_loop_(ctx.thread_pool.get()),
+    epoch_loop_(ctx.thread_pool.get()),
     local_spikes_({thread_private_spike_store(ctx.thread_pool), thread_private_spike_store(ctx.thread_pool)})
 {
+    auto phase_start = profile::timer<>::tic();
+    auto end_phase = [&](const char* name) {
+        construction_times_.push_back({name, profile::timer<>::toc(phase_start)});
+        phase_start = profile::timer<>::tic();
+    };
+
     // Generate the cell groups in parallel, with one task per cell group.
+    PE(init_cellgroups);
     cell_groups_.resize(decomp.groups.size());
+    num_global_cells_ = decomp.num_global_cells;
+    if (task_system_->bound()) {
+        std::size_t n = cell_groups_.size(), n_thread = task_system_->get_num_threads();
+        thread_groups_.resize(n);
+        std::iota(thread_groups_.begin(), thread_groups_.end(), 0u);
+        for (std::size_t t = 0; t<=n_thread; ++t) {
+            thread_bounds_.push_back((t*n+n_thread-1)/n_thread);
+        }
+        for (std::size_t t = 0; t<n_thread; ++t) {
+            group_nodes_.resize(thread_bounds_[t+1], task_system_->numa_nodes()[t]);
+        }
+    }
     std::vector<cell_labels_and_gids> cg_sources(cell_groups_.size());
     std::vector<cell_labels_and_gids> cg_targets(cell_groups_.size());
     foreach_group_index(
@@ -201,11 +331,23 @@ simulation_state::simulation_state(
           cg_targets[i] = cell_labels_and_gids(std::move(targets), group_info.gids);
         });
 
+    group_cost_.assign(cell_groups_.size(), 0.);
+    group_total_cost_.assign(cell_groups_.size(), 0.);
+    group_window_cost_.assign(cell_groups_.size(), 0.);
+    group_order_.resize(cell_groups_.size());
+    std::iota(group_order_.begin(), group_order_.end(), 0u);
+    PL();
+    end_phase("init_cellgroups");
+
+    PE(init_communicator);
     cell_labels_and_gids local_sources, local_targets;
     for(const auto& i: util::make_span(cell_groups_.size())) {
         local_sources.append(cg_sources.at(i));
         local_targets.append(cg_targets.at(i));
     }
+    // Every domain gathers the source labels of all cells, not only of the
+    // sources of its connections: distributed_context has no collective for
+    // a targeted exchange.
     auto global_sources = ctx.distributed->gather_cell_labels_and_gids(local_sources);
 
     auto source_resolution_map = label_resolution_map(std::move(global_sources));
@@ -218,21 +360,32 @@ simulation_state::simulation_state(
     // Use half minimum delay of the network for max integration interval.
     t_interval_ = communicator_.min_delay()/2;
 
+    PL();
+    end_phase("init_communicator");
+
+    PE(init_eventgenerators);
     // Initialize empty buffers for pending events for each local cell
     pending_events_.resize(num_local_cells);
 
     event_generators_.resize(num_local_cells);
-    cell_size_type lidx = 0;
+    std::vector<cell_gid_type> local_gids;
+    local_gids.reserve(num_local_cells);
     cell_size_type grpidx = 0;
-
-    auto target_resolution_map_ptr = std::make_shared<label_resolution_map>(std::move(target_resolution_map));
     for (const auto& group_info: decomp.groups) {
         for (auto gid: group_info.gids) {
             // Store mapping of gid to local cell index.
-            gid_to_local_[gid] = gid_local_info{lidx, grpidx};
+            gid_to_local_[gid] = gid_local_info{cell_size_type(local_gids.size()), grpidx};
+            local_gids.push_back(gid);
+        }
+        ++grpidx;
+    }
 
-            // Resolve event_generator targets.
-            // Each event generator gets their own resolver state.
+    // Set up the event generators for each cell in parallel, resolving their
+    // targets. Each event generator gets their own resolver state.
+    auto target_resolution_map_ptr = std::make_shared<label_resolution_map>(std::move(target_resolution_map));
+    threading::parallel_for::apply(0, num_local_cells, task_system_.get(),
+        [&](int lidx) {
+            auto gid = local_gids[lidx];
             auto event_gens = rec.event_generators(gid);
             for (auto& g: event_gens) {
                 g.resolve_label([target_resolution_map_ptr, event_resolver=resolver(target_resolution_map_ptr.get()), gid]
@@ -240,20 +393,16 @@ simulation_state::simulation_state(
                         return event_resolver.resolve({gid, label});
                     });
             }
-
-            // Set up the event generators for cell gid.
-            event_generators_[lidx] = event_gens;
-
-            ++lidx;
-        }
-        ++grpidx;
-    }
+            event_generators_[lidx] = std::move(event_gens);
+        });
 
     // Create event lane buffers.
     // One buffer is consumed by cell group updates while the other is filled with events for
     // the following epoch. In each buffer there is one lane for each local cell.
     event_lanes_[0].resize(num_local_cells);
     event_lanes_[1].resize(num_local_cells);
+    PL();
+    end_phase("init_eventgenerators");
 
     epoch_.reset();
 }
@@ -288,6 +437,10 @@ void simulation_state::reset() {
         spikes.clear();
     }
 
+    if (spike_stats_) {
+        spike_stats_->reset();
+    }
+
     epoch_.reset();
 }
 
@@ -345,11 +498,18 @@ time_type simulation_state::run(time_type tfinal, time_type dt) {
     // Update task: advance cell groups to end of current epoch and store spikes in local_spikes_.
     auto update = [this, dt](epoch current) {
         local_spikes(current.id).clear();
-        foreach_group_index(
+        foreach_group_by_cost(
             [&](cell_group_ptr& group, int i) {
+                using clock = profile::default_clock;
+                auto start = clock::now();
+
                 auto queues = util::subrange_view(event_lanes(current.id), communicator_.group_queue_range(i));
                 group->advance(current, dt, queues);
 
+                group_cost_[i] = (clock::now()-start)*clock::seconds_per_tick();
+                group_total_cost_[i] += group_cost_[i];
+                group_window_cost_[i] += group_cost_[i];
+
                 PE(advance_spikes);
                 local_spikes(current.id).insert(group->spikes());
                 group->clear_spikes();
@@ -375,6 +535,9 @@ time_type simulation_state::run(time_type tfinal, time_type dt) {
         if (global_export_callback_) {
             global_export_callback_(global_spikes.values());
         }
+        if (spike_stats_) {
+            spike_stats_->update(all_local_spikes);
+        }
         PL();
 
         // Append events formed from global spikes to per-cell pending event queues.
@@ -400,7 +563,19 @@ time_type simulation_state::run(time_type tfinal, time_type dt) {
             });
     };
 
-    threading::task_group g(task_system_.get());
+    // Run the update task for one epoch concurrently with the exchange and
+    // enqueue tasks for its neighbours.
+    auto update_and_exchange = [&](epoch prev, epoch current, epoch next) {
+        epoch_loop_.run(2, [&](std::size_t k) {
+            if (k==0) {
+                update(current);
+            }
+            else {
+                exchange(prev);
+                if (!next.empty()) enqueue(next);
+            }
+        });
+    };
 
     epoch prev = epoch_;
     epoch current = next_epoch(prev, t_interval_);
@@ -414,9 +589,10 @@ time_type simulation_state::run(time_type tfinal, time_type dt) {
     else {
         enqueue(current);
 
-        g.run([&]() { enqueue(next); });
-        g.run([&]() { update(current); });
-        g.wait();
+        epoch_loop_.run(2, [&](std::size_t k) {
+            if (k==0) update(current);
+            else enqueue(next);
+        });
 
         for (;;) {
             prev = current;
@@ -424,14 +600,10 @@ time_type simulation_state::run(time_type tfinal, time_type dt) {
             next = next_epoch(next, t_interval_);
             if (next.empty()) break;
 
-            g.run([&]() { exchange(prev); enqueue(next); });
-            g.run([&]() { update(current); });
-            g.wait();
+            update_and_exchange(prev, current, next);
         }
 
-        g.run([&]() { exchange(prev); });
-        g.run([&]() { update(current); });
-        g.wait();
+        update_and_exchange(prev, current, next);
 
         exchange(current);
     }
@@ -455,6 +627,110 @@ sampler_association_handle simulation_state::add_sampler(
     return h;
 }
 
+sampler_association_handle simulation_state::add_sampler(
+        cell_member_predicate probe_ids,
+        schedule sched,
+        sampler_function f,
+        sample_reducer reducer,
+        sampling_policy policy)
+{
+    if (!reducer.window) {
+        throw range_check_failure("sample reducer window must be positive", reducer.window);
+    }
+
+    sampler_association_handle h = sassoc_handles_.acquire();
+
+    foreach_group(
+        [&](cell_group_ptr& group) { group->add_reduced_sampler(h, probe_ids, sched, f, reducer, policy); });
+
+    return h;
+}
+
+sampler_association_handle simulation_state::add_bulk_sampler(
+        cell_member_predicate probe_ids,
+        schedule sched,
+        bulk_sampler_function f,
+        sampling_policy policy)
+{
+    sampler_association_handle h = sassoc_handles_.acquire();
+
+    foreach_group(
+        [&](cell_group_ptr& group) { group->add_bulk_sampler(h, probe_ids, sched, f, policy); });
+
+    return h;
+}
+
+thread_assignment assign_groups_by_cost(
+    const std::vector<double>& costs,
+    const std::vector<int>& group_nodes,
+    const std::vector<int>& thread_nodes)
+{
+    std::vector<unsigned> order(costs.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(),
+        [&costs](unsigned a, unsigned b) { return costs[a]>costs[b]; });
+
+    const std::size_t n_thread = thread_nodes.size();
+    std::vector<double> thread_cost(n_thread, 0.);
+    std::vector<std::vector<unsigned>> assigned(n_thread);
+    for (auto i: order) {
+        // Least loaded thread on the group's node, or on any node if there
+        // is no thread on the group's node.
+        std::size_t t = n_thread, any = 0;
+        for (std::size_t k = 0; k<n_thread; ++k) {
+            if (thread_cost[k]<thread_cost[any]) any = k;
+            if (thread_nodes[k]==group_nodes[i] && (t==n_thread || thread_cost[k]<thread_cost[t])) t = k;
+        }
+        if (t==n_thread) t = any;
+
+        thread_cost[t] += costs[i];
+        assigned[t].push_back(i);
+    }
+
+    thread_assignment result;
+    result.bounds.assign(1, 0);
+    for (auto& groups: assigned) {
+        result.groups.insert(result.groups.end(), groups.begin(), groups.end());
+        result.bounds.push_back(result.groups.size());
+    }
+    return result;
+}
+
+double simulation_state::rebalance() {
+    // Reassign groups to threads by their cost since the last rebalance.
+    if (task_system_->bound()) {
+        auto assignment = assign_groups_by_cost(group_window_cost_, group_nodes_, task_system_->numa_nodes());
+        thread_groups_ = std::move(assignment.groups);
+        thread_bounds_ = std::move(assignment.bounds);
+    }
+
+    // Compare the total cost on each rank with the mean over all ranks.
+    double local_cost = util::sum(group_window_cost_, 0.);
+    std::fill(group_window_cost_.begin(), group_window_cost_.end(), 0.);
+
+    auto costs = distributed_->gather_all(local_cost);
+    double mean = util::sum(costs, 0.)/costs.size();
+    double max = *std::max_element(costs.begin(), costs.end());
+    return mean>0? max/mean: 1.;
+}
+
+std::vector<double> simulation_state::cell_costs() const {
+    std::vector<std::size_t> group_size(cell_groups_.size());
+    for (const auto& [gid, info]: gid_to_local_) ++group_size[info.group_index];
+
+    // Each rank fills in the costs of its own cells, and zero elsewhere.
+    std::vector<double> costs(num_global_cells_, 0.);
+    for (const auto& [gid, info]: gid_to_local_) {
+        costs[gid] = group_total_cost_[info.group_index]/group_size[info.group_index];
+    }
+    return distributed_->sum(costs);
+}
+
+std::vector<population_statistics> simulation_state::spike_statistics() const {
+    if (!spike_stats_) return {};
+    return spike_stats_->reduce(*distributed_, epoch_.t1);
+}
+
 void simulation_state::remove_sampler(sampler_association_handle h) {
     foreach_group(
         [h](cell_group_ptr& group) { group->remove_sampler(h); });
@@ -526,6 +802,25 @@ sampler_association_handle simulation::add_sampler(
     return impl_->add_sampler(std::move(probe_ids), std::move(sched), std::move(f), policy);
 }
 
+sampler_association_handle simulation::add_sampler(
+    cell_member_predicate probe_ids,
+    schedule sched,
+    sampler_function f,
+    sample_reducer reducer,
+    sampling_policy policy)
+{
+    return impl_->add_sampler(std::move(probe_ids), std::move(sched), std::move(f), reducer, policy);
+}
+
+sampler_association_handle simulation::add_bulk_sampler(
+    cell_member_predicate probe_ids,
+    schedule sched,
+    bulk_sampler_function f,
+    sampling_policy policy)
+{
+    return impl_->add_bulk_sampler(std::move(probe_ids), std::move(sched), std::move(f), policy);
+}
+
 void simulation::remove_sampler(sampler_association_handle h) {
     impl_->remove_sampler(h);
 }
@@ -554,6 +849,34 @@ void simulation::set_local_spike_callback(spike_export_function export_callback)
     impl_->local_export_callback_ = std::move(export_callback);
 }
 
+void simulation::set_spike_statistics(spike_statistics_config config) {
+    impl_->spike_stats_.emplace(std::move(config));
+}
+
+std::vector<population_statistics> simulation::spike_statistics() const {
+    return impl_->spike_statistics();
+}
+
+std::vector<double> simulation::group_costs() const {
+    return impl_->group_costs();
+}
+
+std::vector<double> simulation::cell_costs() const {
+    return impl_->cell_costs();
+}
+
+std::vector<unsigned> simulation::group_threads() const {
+    return impl_->group_threads();
+}
+
+profile::phase_times simulation::construction_times() const {
+    return impl_->construction_times();
+}
+
+double simulation::rebalance() {
+    return impl_->rebalance();
+}
+
 void simulation::inject_events(const cse_vector& events) {
     impl_->inject_events(events);
 }
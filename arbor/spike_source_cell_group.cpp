@@ -1,4 +1,5 @@
 #include <exception>
+#include <utility>
 
 #include <arbor/arbexcept.hpp>
 #include <arbor/recipe.hpp>
@@ -9,6 +10,8 @@
 #include "label_resolution.hpp"
 #include "profile/profiler_macro.hpp"
 #include "spike_source_cell_group.hpp"
+#include "threading/threading.hpp"
+#include "util/range.hpp"
 #include "util/span.hpp"
 
 namespace arb {
@@ -17,8 +20,12 @@ spike_source_cell_group::spike_source_cell_group(
     const std::vector<cell_gid_type>& gids,
     const recipe& rec,
     cell_label_range& cg_sources,
-    cell_label_range& cg_targets):
-    gids_(gids)
+    cell_label_range& cg_targets,
+    task_system_handle thread_pool):
+    gids_(gids),
+    thread_pool_(std::move(thread_pool)),
+    spans_(gids.size()),
+    offsets_(gids.size()+1)
 {
     for (auto gid: gids_) {
         if (!rec.get_probes(gid).empty()) {
@@ -45,16 +52,48 @@ cell_kind spike_source_cell_group::get_cell_kind() const {
     return cell_kind::spike_source;
 }
 
+template <typename F>
+void spike_source_cell_group::foreach_cell(F&& f) {
+    const int n = gids_.size();
+    const int nthread = thread_pool_? thread_pool_->get_num_threads(): 1;
+
+    if (nthread<2 || n<2) {
+        for (int i = 0; i<n; ++i) f(i);
+        return;
+    }
+
+    // Split cells into a few batches per thread: schedules are cheap to query
+    // individually, so one task per cell would be dominated by overhead.
+    const int batch_size = (n+4*nthread-1)/(4*nthread);
+    threading::parallel_for::apply(0, n, batch_size, thread_pool_.get(), f);
+}
+
 void spike_source_cell_group::advance(epoch ep, time_type dt, const event_lane_subrange& event_lanes) {
     PE(advance_sscell);
 
-    for (auto i: util::count_along(gids_)) {
-        const auto gid = gids_[i];
+    const auto n = gids_.size();
 
-        for (auto t: util::make_range(time_sequences_[i].events(ep.t0, ep.t1))) {
-            spikes_.push_back({{gid, 0u}, t});
-        }
+    // Query each schedule for the epoch. Schedules have independent state,
+    // and returned spans remain valid until the next call to events().
+    foreach_cell([&](int i) {
+        spans_[i] = time_sequences_[i].events(ep.t0, ep.t1);
+    });
+
+    // Reserve space for all spikes of the epoch in one go, then write
+    // each cell's spikes into its own slice of the buffer.
+    offsets_[0] = spikes_.size();
+    for (std::size_t i = 0; i<n; ++i) {
+        offsets_[i+1] = offsets_[i] + (spans_[i].second-spans_[i].first);
     }
+    spikes_.resize(offsets_[n]);
+
+    foreach_cell([&](int i) {
+        const cell_member_type source{gids_[i], 0u};
+        auto out = spikes_.begin()+offsets_[i];
+        for (auto t: util::make_range(spans_[i])) {
+            *out++ = spike(source, t);
+        }
+    });
 
     PL();
 };
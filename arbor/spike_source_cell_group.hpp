@@ -11,12 +11,13 @@
 #include "cell_group.hpp"
 #include "epoch.hpp"
 #include "label_resolution.hpp"
+#include "threading/threading.hpp"
 
 namespace arb {
 
 class spike_source_cell_group: public cell_group {
 public:
-    spike_source_cell_group(const std::vector<cell_gid_type>& gids, const recipe& rec, cell_label_range& cg_sources, cell_label_range& cg_targets);
+    spike_source_cell_group(const std::vector<cell_gid_type>& gids, const recipe& rec, cell_label_range& cg_sources, cell_label_range& cg_targets, task_system_handle thread_pool = {});
 
     cell_kind get_cell_kind() const override;
 
@@ -40,6 +41,19 @@ private:
     std::vector<spike> spikes_;
     std::vector<cell_gid_type> gids_;
     std::vector<schedule> time_sequences_;
+
+    // Optional thread pool for querying schedules in parallel across cells.
+    task_system_handle thread_pool_;
+
+    // Per-cell scratch storage, allocated once at construction:
+    // event spans returned by each schedule for the current epoch, and
+    // the offsets of each cell's spikes in spikes_ (partition of size n+1).
+    std::vector<time_event_span> spans_;
+    std::vector<std::size_t> offsets_;
+
+    // Apply f(i) to each cell index i, in batches over the thread pool if available.
+    template <typename F>
+    void foreach_cell(F&& f);
 };
 
 } // namespace arb
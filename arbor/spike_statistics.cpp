@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <arbor/arbexcept.hpp>
+#include <arbor/common_types.hpp>
+#include <arbor/spike.hpp>
+#include <arbor/spike_statistics.hpp>
+
+#include "distributed_context.hpp"
+#include "spike_statistics.hpp"
+#include "util/rangeutil.hpp"
+#include "util/strprintf.hpp"
+
+namespace arb {
+
+spike_statistics_accumulator::spike_statistics_accumulator(spike_statistics_config config):
+    config_(std::move(config))
+{
+    if (!(config_.bin_width>0)) {
+        throw arbor_exception(util::pprintf("spike statistics bin width {} is not positive", config_.bin_width));
+    }
+
+    auto& pops = config_.populations;
+    util::sort(pops);
+    for (std::size_t i = 0; i<pops.size(); ++i) {
+        if (pops[i].first>=pops[i].second) {
+            throw arbor_exception(util::pprintf("spike statistics population [{}, {}) is empty", pops[i].first, pops[i].second));
+        }
+        if (i && pops[i].first<pops[i-1].second) {
+            throw arbor_exception(util::pprintf("spike statistics populations [{}, {}) and [{}, {}) overlap",
+                pops[i-1].first, pops[i-1].second, pops[i].first, pops[i].second));
+        }
+    }
+    populations_.resize(pops.size());
+}
+
+int spike_statistics_accumulator::population_of(cell_gid_type gid) const {
+    const auto& pops = config_.populations;
+    auto it = std::upper_bound(pops.begin(), pops.end(), gid,
+        [](cell_gid_type gid, const auto& p) { return gid<p.first; });
+
+    if (it==pops.begin() || gid>=(--it)->second) return -1;
+    return it-pops.begin();
+}
+
+void spike_statistics_accumulator::update(const std::vector<spike>& local_spikes) {
+    // Intervals are taken between consecutive spikes of a cell, so spikes in a
+    // batch are visited in time order.
+    sorted_.assign(local_spikes.begin(), local_spikes.end());
+    util::sort_by(sorted_, [](const spike& s) { return s.time; });
+
+    for (const spike& s: sorted_) {
+        int p = population_of(s.source.gid);
+        if (p<0) continue;
+
+        population_state& pop = populations_[p];
+        ++pop.n_spike;
+
+        std::size_t bin = s.time/config_.bin_width;
+        if (bin>=pop.histogram.size()) {
+            pop.histogram.resize(bin+1, 0);
+        }
+        ++pop.histogram[bin];
+
+        auto ins = cells_.insert({s.source.gid, cell_isi{s.time}});
+        if (!ins.second) {
+            cell_isi& c = ins.first->second;
+            double isi = s.time-c.last;
+            double delta = isi-c.mean;
+            c.mean += delta/++c.n;
+            c.m2 += delta*(isi-c.mean);
+            c.last = s.time;
+        }
+    }
+}
+
+void spike_statistics_accumulator::reset() {
+    for (auto& pop: populations_) {
+        pop = population_state{};
+    }
+    cells_.clear();
+}
+
+std::vector<population_statistics> spike_statistics_accumulator::reduce(const distributed_context& ctx, time_type t) const {
+    const std::size_t n_pop = populations_.size();
+    const std::size_t n_bin = t>0? std::ceil(t/config_.bin_width): 0;
+
+    // All local terms are packed into one vector and summed across ranks in
+    // one collective. For each population: spike count, number of cells
+    // with a CV, sum of cell CVs, then the histogram. Counts are held as
+    // doubles, which are exact up to 2^53.
+    const std::size_t stride = 3+n_bin;
+    std::vector<double> terms(n_pop*stride, 0.);
+
+    for (std::size_t p = 0; p<n_pop; ++p) {
+        const population_state& pop = populations_[p];
+        double* x = terms.data()+p*stride;
+
+        x[0] = pop.n_spike;
+        for (std::size_t i = 0; i<std::min(n_bin, pop.histogram.size()); ++i) {
+            x[3+i] = pop.histogram[i];
+        }
+    }
+
+    // Each cell is local to one rank, so per-cell CVs are summed locally first.
+    for (const auto& [gid, c]: cells_) {
+        if (c.n<2 || !(c.mean>0)) continue;
+
+        double* x = terms.data()+population_of(gid)*stride;
+        x[1] += 1;
+        x[2] += std::sqrt(c.m2/c.n)/c.mean;
+    }
+
+    terms = ctx.sum(std::move(terms));
+
+    std::vector<population_statistics> result(n_pop);
+    for (std::size_t p = 0; p<n_pop; ++p) {
+        population_statistics& stats = result[p];
+        const double* x = terms.data()+p*stride;
+
+        stats.population = config_.populations[p];
+        stats.n_spike = x[0];
+        stats.histogram.assign(x+3, x+stride);
+
+        auto n_cell = stats.population.second-stats.population.first;
+        stats.rate = t>0? stats.n_spike/(n_cell*t*1e-3): 0;
+
+        stats.n_isi_cv_cell = x[1];
+        stats.isi_cv = stats.n_isi_cv_cell? x[2]/stats.n_isi_cv_cell: std::numeric_limits<double>::quiet_NaN();
+    }
+    return result;
+}
+
+} // namespace arb
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <arbor/common_types.hpp>
+#include <arbor/spike.hpp>
+#include <arbor/spike_statistics.hpp>
+
+#include "distributed_context.hpp"
+
+namespace arb {
+
+// Accumulates population spike counts, histograms and per-cell inter-spike
+// interval moments from the local spikes of successive epochs. Statistics
+// are combined across ranks only when requested.
+
+class spike_statistics_accumulator {
+public:
+    // Throws arbor_exception if populations overlap or are empty, or if the bin width is not positive.
+    explicit spike_statistics_accumulator(spike_statistics_config config);
+
+    // Spikes in each call must not precede those in earlier calls.
+    void update(const std::vector<spike>& local_spikes);
+
+    void reset();
+
+    // Collective: combine statistics from all ranks for simulated time [0, t).
+    std::vector<population_statistics> reduce(const distributed_context& ctx, time_type t) const;
+
+private:
+    // Running inter-spike interval mean and sum of squared deviations (Welford).
+    struct cell_isi {
+        time_type last = 0;
+        std::uint64_t n = 0;
+        double mean = 0;
+        double m2 = 0;
+    };
+
+    struct population_state {
+        std::uint64_t n_spike = 0;
+        std::vector<std::uint64_t> histogram;
+    };
+
+    // Index of population containing gid, or -1.
+    int population_of(cell_gid_type gid) const;
+
+    spike_statistics_config config_;   // Populations sorted by first gid.
+    std::vector<population_state> populations_;
+    std::unordered_map<cell_gid_type, cell_isi> cells_;
+    std::vector<spike> sorted_;
+};
+
+} // namespace arb
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+namespace arb {
+
+// Assignment of cell groups to threads: thread t advances the groups
+// groups[bounds[t]..bounds[t+1]), in that order.
+struct thread_assignment {
+    std::vector<unsigned> groups;
+    std::vector<std::size_t> bounds;
+};
+
+// Assign groups to threads by longest processing time first: in decreasing
+// order of cost, each group goes to the thread with least total cost so far
+// among the threads on the same NUMA node as the group, taking the lowest
+// numbered thread on ties. A group goes to a thread on any node only if no
+// thread is on its node. Each thread then advances its groups in decreasing
+// order of cost. group_nodes and thread_nodes give the NUMA node of each
+// group's state and of each thread.
+thread_assignment assign_groups_by_cost(
+    const std::vector<double>& costs,
+    const std::vector<int>& group_nodes,
+    const std::vector<int>& thread_nodes);
+
+} // namespace arb
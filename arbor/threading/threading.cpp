@@ -1,4 +1,17 @@
+#include <algorithm>
 #include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 #include <arbor/assert.hpp>
 #include <arbor/util/scope_exit.hpp>
@@ -78,6 +91,147 @@ bool notification_queue::empty() {
     return true;
 }
 
+// ws_deque:
+//
+// After Lê, Pop, Cohen and Zappa Nardelli, "Correct and efficient work-stealing
+// for weak memory models", PPoPP 2013.
+
+ws_deque::ws_deque(): top_(0), bottom_(0) {
+    rings_.emplace_back(new ring(64));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+}
+
+ws_deque::~ws_deque() {
+    while (task* t = pop()) {
+        if (!is_borrowed_task(t)) delete t;
+    }
+}
+
+ws_deque::ring* ws_deque::grow(ring* r, std::int64_t top, std::int64_t bottom) {
+    rings_.emplace_back(new ring(2*r->capacity));
+    ring* bigger = rings_.back().get();
+    for (auto i = top; i<bottom; ++i) {
+        bigger->put(i, r->get(i));
+    }
+    ring_.store(bigger, std::memory_order_release);
+    return bigger;
+}
+
+void ws_deque::push(task* t) {
+    auto b = bottom_.load(std::memory_order_relaxed);
+    auto tp = top_.load(std::memory_order_acquire);
+    ring* r = ring_.load(std::memory_order_relaxed);
+
+    if (b-tp>r->capacity-1) {
+        r = grow(r, tp, b);
+    }
+    r->put(b, t);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b+1, std::memory_order_relaxed);
+}
+
+task* ws_deque::pop() {
+    auto b = bottom_.load(std::memory_order_relaxed)-1;
+    ring* r = ring_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto tp = top_.load(std::memory_order_relaxed);
+
+    if (tp>b) {
+        // Empty.
+        bottom_.store(b+1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    task* t = r->get(b);
+    if (tp==b) {
+        // Last task: race against thieves for it.
+        if (!top_.compare_exchange_strong(tp, tp+1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            t = nullptr;
+        }
+        bottom_.store(b+1, std::memory_order_relaxed);
+    }
+    return t;
+}
+
+task* ws_deque::steal() {
+    auto tp = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = bottom_.load(std::memory_order_acquire);
+
+    if (tp>=b) return nullptr;
+
+    ring* r = ring_.load(std::memory_order_acquire);
+    task* t = r->get(tp);
+    if (!top_.compare_exchange_strong(tp, tp+1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return nullptr;
+    }
+    return t;
+}
+
+bool ws_deque::maybe_nonempty() const {
+    return bottom_.load(std::memory_order_seq_cst)>top_.load(std::memory_order_seq_cst);
+}
+
+// task_system:
+
+namespace {
+// Back-off limits for idle worker threads: number of polling rounds
+// spent spinning, and then yielding, before sleeping.
+constexpr unsigned spin_rounds = 32;
+constexpr unsigned yield_rounds = 64;
+
+inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+priority_task take_task(task* t, int priority) {
+    if (is_borrowed_task(t)) {
+        return priority_task{task(*borrowed_task(t)), priority};
+    }
+    std::unique_ptr<task> owned(t);
+    return priority_task{std::move(*owned), priority};
+}
+
+// Bind the calling thread to the given logical cores. Binding is only
+// supported on Linux: elsewhere, set_thread_affinity does nothing and
+// returns false.
+bool set_thread_affinity(const std::vector<int>& cpus) {
+#ifdef __linux__
+    if (cpus.empty()) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c: cpus) CPU_SET(c, &set);
+    return !pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    return false;
+#endif
+}
+
+// NUMA node of a logical core, as reported by sysfs on Linux, else 0.
+int cpu_numa_node(int cpu) {
+    int node = 0;
+#ifdef __linux__
+    std::string path = "/sys/devices/system/cpu/cpu"+std::to_string(cpu);
+    if (DIR* dir = opendir(path.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name.size()>4 && name.compare(0, 4, "node")==0 &&
+                std::all_of(name.begin()+4, name.end(), [](char c) { return c>='0' && c<='9'; }))
+            {
+                node = std::stoi(name.substr(4));
+                break;
+            }
+        }
+        closedir(dir);
+    }
+#endif
+    return node;
+}
+} // anonymous namespace
+
 void task_system::run(priority_task ptsk) {
     arb_assert(ptsk);
     auto guard = util::on_scope_exit([pri = current_task_priority_] { current_task_priority_ = pri; });
@@ -86,66 +240,177 @@ void task_system::run(priority_task ptsk) {
     ptsk.run();
 }
 
+unsigned task_system::owned_queue() const {
+    return current_task_system_==this && current_task_queue_<count_? current_task_queue_: -1;
+}
+
+priority_task task_system::find_task(unsigned i, bool owned, int lowest_priority) {
+    for (int pri = n_priority-1; pri>=lowest_priority; --pri) {
+        if (owned) {
+            if (task* t = deques_[i][pri].pop()) return take_task(t, pri);
+        }
+        for (unsigned n = owned; n<count_; ++n) {
+            if (task* t = deques_[(i+n)%count_][pri].steal()) return take_task(t, pri);
+        }
+        if (n_pinned_[i].load(std::memory_order_relaxed)) {
+            if (auto ptsk = pinned_[i].try_pop(pri)) {
+                --n_pinned_[i];
+                return ptsk;
+            }
+        }
+        if (n_injected_.load(std::memory_order_relaxed)) {
+            if (auto ptsk = injected_.try_pop(pri)) {
+                --n_injected_;
+                return ptsk;
+            }
+        }
+    }
+    return {};
+}
+
+void task_system::wake_locked(std::size_t k) {
+    unsigned i = sleeping_[k];
+    sleeping_[k] = sleeping_.back();
+    sleeping_.pop_back();
+
+    ++wake_count_[i];
+    sleep_cv_[i].notify_one();
+}
+
+void task_system::notify_sleepers() {
+    // Pairs with the fence in wait_for_task: either the pusher sees the
+    // sleeper, or the sleeper sees the pushed task.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (n_sleeping_.load(std::memory_order_relaxed)) {
+        lock l{sleep_mutex_};
+        if (!sleeping_.empty()) wake_locked(sleeping_.size()-1);
+    }
+}
+
+void task_system::notify_thread(unsigned i) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (n_sleeping_.load(std::memory_order_relaxed)) {
+        lock l{sleep_mutex_};
+        auto k = std::find(sleeping_.begin(), sleeping_.end(), i)-sleeping_.begin();
+        if (k<(std::ptrdiff_t)sleeping_.size()) wake_locked(k);
+    }
+}
+
+void task_system::wait_for_task(unsigned i) {
+    unsigned wake;
+    {
+        lock l{sleep_mutex_};
+        n_sleeping_.fetch_add(1);
+        sleeping_.push_back(i);
+        wake = wake_count_[i];
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    bool available = n_injected_.load(std::memory_order_relaxed) || n_pinned_[i].load(std::memory_order_relaxed);
+    for (auto& dq: deques_) {
+        for (auto& d: dq) available |= d.maybe_nonempty();
+    }
+
+    {
+        lock l{sleep_mutex_};
+        if (!available) {
+            sleep_cv_[i].wait(l, [&] { return wake_count_[i]!=wake || quit_.load(); });
+        }
+
+        // Leave the list of sleepers, unless removed by the thread that woke us.
+        auto k = std::find(sleeping_.begin(), sleeping_.end(), i);
+        if (k!=sleeping_.end()) {
+            *k = sleeping_.back();
+            sleeping_.pop_back();
+        }
+    }
+    n_sleeping_.fetch_sub(1);
+}
+
 void task_system::run_tasks_loop(int i) {
-    auto guard = util::on_scope_exit([] { current_task_queue_ = -1; });
+    auto guard = util::on_scope_exit([] { current_task_queue_ = -1; current_task_system_ = nullptr; });
     current_task_queue_ = i;
+    current_task_system_ = this;
 
+    unsigned idle_rounds = 0;
     while (true) {
-        priority_task ptsk;
-        // Loop over the levels of priority starting from highest to lowest
-        for (int pri = n_priority-1; pri>=0; --pri) {
-            // Loop over the threads trying to pop a task of the requested priority.
-            for (unsigned n = 0; n<count_; ++n) {
-                ptsk = q_[(i + n) % count_].try_pop(pri);
-                if (ptsk) break;
-            }
-            if (ptsk) break;
+        if (auto ptsk = find_task(i, true, 0)) {
+            idle_rounds = 0;
+            run(std::move(ptsk));
+            continue;
         }
-        // If a task can not be acquired, force a pop from the queue. This is a blocking action.
-        if (!ptsk) ptsk = q_[i].pop();
-        if (!ptsk) break;
+        if (quit_.load(std::memory_order_acquire)) break;
 
-        run(std::move(ptsk));
+        if (idle_rounds<spin_rounds) {
+            for (unsigned k = 0; k<(1u<<(idle_rounds/4)); ++k) cpu_relax();
+            ++idle_rounds;
+        }
+        else if (idle_rounds<yield_rounds) {
+            std::this_thread::yield();
+            ++idle_rounds;
+        }
+        else {
+            wait_for_task(i);
+            idle_rounds = 0;
+        }
     }
 }
 
 void task_system::try_run_task(int lowest_priority) {
-    unsigned i = current_task_queue_+1==0? 0: current_task_queue_;
-    arb_assert(i>=0 && i<count_);
+    unsigned i = owned_queue();
+    bool owned = i+1!=0;
+    if (!owned) i = 0;
 
-    // Loop over the levels of priority starting from highest to lowest_priority
-    for (int pri = n_priority-1; pri>=lowest_priority; --pri) {
-        // Loop over the threads trying to pop a task of the requested priority.
-        for (unsigned n = 0; n != count_; n++) {
-            if (auto ptsk = q_[(i + n) % count_].try_pop(pri)) {
-                run(std::move(ptsk));
-                return;
-            }
-        }
+    if (auto ptsk = find_task(i, owned, lowest_priority)) {
+        run(std::move(ptsk));
     }
 }
 
 thread_local int task_system::current_task_priority_ = -1;
 thread_local unsigned task_system::current_task_queue_ = -1;
+thread_local const task_system* task_system::current_task_system_ = nullptr;
 
 // Default construct with one thread.
 task_system::task_system(): task_system(1) {}
 
-task_system::task_system(int nthreads): count_(nthreads), q_(nthreads) {
+task_system::task_system(int nthreads): task_system(nthreads, {}) {}
+
+task_system::task_system(int nthreads, std::vector<int> affinity):
+    count_(nthreads),
+    deques_(nthreads > 0? nthreads: 0),
+    sleep_cv_(nthreads > 0? nthreads: 0),
+    wake_count_(nthreads > 0? nthreads: 0),
+    pinned_(nthreads > 0? nthreads: 0),
+    n_pinned_(nthreads > 0? nthreads: 0)
+{
     if (nthreads <= 0)
         throw std::runtime_error("Non-positive number of threads in thread pool");
 
-    for (unsigned p = 0; p<n_priority; ++p) {
-        index_[p] = 0;
+#ifdef __linux__
+    for (int c: affinity) {
+        if (c<0 || c>=CPU_SETSIZE) {
+            throw std::runtime_error("Invalid logical core "+std::to_string(c)+" in thread affinity");
+        }
     }
+    for (unsigned i = 0; i < count_ && !affinity.empty(); i++) {
+        cpus_.push_back(affinity[i%affinity.size()]);
+        numa_nodes_.push_back(cpu_numa_node(cpus_.back()));
+    }
+#endif
 
     // Main thread
     auto tid = std::this_thread::get_id();
     thread_ids_[tid] = 0;
     current_task_queue_ = 0;
+    current_task_system_ = this;
 
     for (unsigned i = 1; i < count_; i++) {
-        threads_.emplace_back([this, i]{run_tasks_loop(i);});
+        // Worker threads bind themselves before taking any task, so that
+        // memory first touched by a worker is local to its core.
+        threads_.emplace_back([this, i]{
+            if (bound()) set_thread_affinity({cpus_[i]});
+            run_tasks_loop(i);
+        });
         tid = threads_.back().get_id();
         thread_ids_[tid] = i;
     }
@@ -154,7 +419,13 @@ task_system::task_system(int nthreads): count_(nthreads), q_(nthreads) {
 task_system::~task_system() {
     current_task_priority_ = -1;
     current_task_queue_ = -1;
-    for (auto& e: q_) e.quit();
+    current_task_system_ = nullptr;
+
+    quit_.store(true);
+    {
+        lock l{sleep_mutex_};
+        for (auto& cv: sleep_cv_) cv.notify_all();
+    }
     for (auto& e: threads_) e.join();
 }
 
@@ -163,16 +434,200 @@ void task_system::async(priority_task ptsk) {
         run(std::move(ptsk));
     }
     else {
-        arb_assert(ptsk.priority < (int)index_.size());
-        auto i = index_[ptsk.priority]++;
+        unsigned i = owned_queue();
+        if (i+1!=0) {
+            deques_[i][ptsk.priority].push(new task(ptsk.release()));
+        }
+        else {
+            injected_.push(std::move(ptsk));
+            ++n_injected_;
+        }
+        notify_sleepers();
+    }
+}
 
-        for (unsigned n = 0; n != count_; n++) {
-            if (q_[(i + n) % count_].try_push(ptsk)) return;
+void task_system::async_borrowed(const task* t, int priority) {
+    if (priority>=n_priority) {
+        run(priority_task{task(*t), priority});
+    }
+    else {
+        unsigned i = owned_queue();
+        if (i+1!=0) {
+            deques_[i][priority].push(borrow_task(t));
         }
-        q_[i % count_].push(std::move(ptsk));
+        else {
+            injected_.push(priority_task{task(*t), priority});
+            ++n_injected_;
+        }
+        notify_sleepers();
+    }
+}
+
+bool task_system::queue_drained(int priority) const {
+    if (priority>=n_priority) return true;
+
+    unsigned i = owned_queue();
+    if (i+1!=0) return !deques_[i][priority].maybe_nonempty();
+    return !n_injected_.load(std::memory_order_relaxed);
+}
+
+void task_system::async_on(unsigned i, priority_task ptsk) {
+    arb_assert(i<count_);
+    if (ptsk.priority>=n_priority) {
+        run(std::move(ptsk));
+    }
+    else {
+        pinned_[i].push(std::move(ptsk));
+        ++n_pinned_[i];
+        // Only thread i may take the task.
+        notify_thread(i);
     }
 }
 
 std::unordered_map<std::thread::id, std::size_t> task_system::get_thread_ids() const {
     return thread_ids_;
 };
+
+// parallel_loop:
+
+void parallel_loop::call(std::size_t i) {
+    call_(body_, order_? order_[i]: i);
+}
+
+void parallel_loop::set_exception(std::exception_ptr ex) {
+    {
+        lock l{exception_mutex_};
+        if (!exception_) exception_ = std::move(ex);
+    }
+    error_.store(true, std::memory_order_relaxed);
+}
+
+void parallel_loop::work() {
+    while (!error_.load(std::memory_order_relaxed)) {
+        std::size_t b = next_.fetch_add(grain_, std::memory_order_relaxed);
+        if (b>=n_) break;
+
+        std::size_t e = std::min(n_, b+grain_);
+        try {
+            for (std::size_t i = b; i<e; ++i) call(i);
+        }
+        catch (...) {
+            set_exception(std::current_exception());
+        }
+    }
+}
+
+// By default, thread t is assigned the indices i with i*n_thread/n == t.
+static std::size_t even_block_begin(std::size_t t, std::size_t n, std::size_t n_thread) {
+    return (t*n+n_thread-1)/n_thread;
+}
+
+std::size_t parallel_loop::block_begin(std::size_t t) const {
+    return bounds_? bounds_[t]: even_block_begin(t, n_, task_system_->get_num_threads());
+}
+
+void parallel_loop::work_block(unsigned t) {
+    if (steal_) {
+        unsigned n_thread = task_system_->get_num_threads();
+        for (unsigned k = 0; k<n_thread; ++k) {
+            work_remaining((t+k)%n_thread);
+        }
+        return;
+    }
+
+    std::size_t e = block_begin(t+1);
+    try {
+        for (std::size_t i = block_begin(t); i<e && !error_.load(std::memory_order_relaxed); ++i) {
+            call(i);
+        }
+    }
+    catch (...) {
+        set_exception(std::current_exception());
+    }
+}
+
+void parallel_loop::work_remaining(unsigned b) {
+    std::size_t e = block_begin(b+1);
+    try {
+        while (!error_.load(std::memory_order_relaxed)) {
+            std::size_t i = block_next_[b].fetch_add(1, std::memory_order_relaxed);
+            if (i>=e) break;
+            call(i);
+        }
+    }
+    catch (...) {
+        set_exception(std::current_exception());
+    }
+}
+
+void parallel_loop::run_shared(std::size_t n, const unsigned* order, std::size_t grain) {
+    if (!n) return;
+
+    n_ = n;
+    order_ = order;
+    grain_ = std::max<std::size_t>(grain, 1);
+    next_.store(0, std::memory_order_relaxed);
+
+    // Tasks with priority above max_async_task_priority would be run
+    // synchronously: in that case the calling thread does all the work.
+    int priority = task_system::get_task_priority()+1;
+    std::size_t n_chunk = (n_+grain_-1)/grain_;
+    std::size_t n_helper = priority<=max_async_task_priority?
+        std::min<std::size_t>(task_system_->get_num_threads()-1, n_chunk-1): 0;
+
+    pending_.store(n_helper, std::memory_order_relaxed);
+    for (std::size_t k = 0; k<n_helper; ++k) {
+        task_system_->async_borrowed(&helper_, priority);
+    }
+
+    task_system_->run(priority_task{[this] { work(); }, priority});
+    wait(priority);
+}
+
+void parallel_loop::run_pinned(std::size_t n, const unsigned* order, const std::size_t* bounds, bool steal) {
+    if (!n) return;
+
+    n_ = n;
+    order_ = order;
+    bounds_ = bounds;
+    steal_ = steal;
+
+    unsigned n_thread = task_system_->get_num_threads();
+    if (pinned_helpers_.empty()) {
+        for (unsigned t = 0; t<n_thread; ++t) {
+            pinned_helpers_.emplace_back([this, t] { work_block(t); finish(); });
+        }
+    }
+    if (steal_) {
+        if (!block_next_) block_next_.reset(new std::atomic<std::size_t>[n_thread]);
+        for (unsigned t = 0; t<n_thread; ++t) {
+            block_next_[t].store(block_begin(t), std::memory_order_relaxed);
+        }
+    }
+
+    // Only threads with a non-empty block are given a task.
+    auto has_block = [&](unsigned t) { return block_begin(t)<block_begin(t+1); };
+
+    unsigned n_helper = 0;
+    for (unsigned t = 0; t<n_thread; ++t) n_helper += has_block(t);
+
+    int priority = task_system::get_task_priority()+1;
+    pending_.store(n_helper, std::memory_order_relaxed);
+    for (unsigned t = 0; t<n_thread; ++t) {
+        if (has_block(t)) task_system_->async_on(t, priority_task{task(pinned_helpers_[t]), priority});
+    }
+    wait(priority);
+}
+
+void parallel_loop::wait(int priority) {
+    while (pending_.load(std::memory_order_acquire)) {
+        task_system_->try_run_task(priority);
+    }
+
+    error_.store(false, std::memory_order_relaxed);
+    if (exception_) {
+        auto ex = std::move(exception_);
+        exception_ = nullptr;
+        std::rethrow_exception(ex);
+    }
+}
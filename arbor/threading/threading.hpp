@@ -5,11 +5,15 @@
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
+#include <cstdint>
 #include <deque>
+#include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 #include <unordered_map>
 #include <utility>
@@ -118,6 +122,69 @@ private:
     bool quit_ = false;
 };
 
+// Tasks in the work-stealing deques are held by pointer. Tasks pushed with
+// task_system::async are owned by the deque, and deleted once taken; borrowed
+// tasks, pushed with task_system::async_borrowed, are copied when taken and
+// never deleted. Borrowed tasks are marked in the low bit of the pointer.
+inline task* borrow_task(const task* t) {
+    return reinterpret_cast<task*>(reinterpret_cast<std::uintptr_t>(t)|1u);
+}
+
+inline bool is_borrowed_task(const task* t) {
+    return reinterpret_cast<std::uintptr_t>(t)&1u;
+}
+
+inline const task* borrowed_task(const task* t) {
+    return reinterpret_cast<const task*>(reinterpret_cast<std::uintptr_t>(t)&~std::uintptr_t(1));
+}
+
+// Chase-Lev work-stealing deque of tasks. Only the owning thread may push
+// and pop, at the bottom of the deque (LIFO); any thread may steal from the
+// top (FIFO). Tasks are held by pointer; the circular buffer grows as
+// required, and retired buffers are kept until the deque is destroyed, as
+// thieves may still be reading from them.
+class ws_deque {
+public:
+    ws_deque();
+    ~ws_deque();
+
+    ws_deque(const ws_deque&) = delete;
+    ws_deque& operator=(const ws_deque&) = delete;
+
+    // Owner only: push a non-null task.
+    void push(task* t);
+
+    // Owner only: pop the most recently pushed task, or return nullptr if empty.
+    task* pop();
+
+    // Steal the least recently pushed task. Returns nullptr if the deque is
+    // empty or if the steal lost a race with another thread.
+    task* steal();
+
+    // True if the deque appeared to hold tasks when inspected.
+    bool maybe_nonempty() const;
+
+private:
+    struct ring {
+        std::int64_t capacity;
+        std::unique_ptr<std::atomic<task*>[]> items;
+
+        explicit ring(std::int64_t capacity):
+            capacity(capacity), items(new std::atomic<task*>[capacity])
+        {}
+
+        task* get(std::int64_t i) const { return items[i&(capacity-1)].load(std::memory_order_relaxed); }
+        void put(std::int64_t i, task* t) { items[i&(capacity-1)].store(t, std::memory_order_relaxed); }
+    };
+
+    ring* grow(ring* r, std::int64_t top, std::int64_t bottom);
+
+    alignas(64) std::atomic<std::int64_t> top_;
+    alignas(64) std::atomic<std::int64_t> bottom_;
+    std::atomic<ring*> ring_;
+    std::vector<std::unique_ptr<ring>> rings_;
+};
+
 }// namespace impl
 
 class task_system {
@@ -139,20 +206,66 @@ private:
     // threads_.
     static thread_local unsigned current_task_queue_;
 
-    // Number of priority levels in notification queues.
+    // Task system owning the queue given by current_task_queue_, if any.
+    static thread_local const task_system* current_task_system_;
+
+    // Number of priority levels in task queues.
     static constexpr int n_priority = max_async_task_priority+1;
 
-    // Notification queues containing n_priority deques representing
-    // different priority levels.
-    std::vector<impl::notification_queue> q_;
+    // Work-stealing deques, one per thread for each priority level. Tasks
+    // pushed by a thread in the pool go on its own deques.
+    std::vector<std::array<impl::ws_deque, n_priority>> deques_;
+
+    // Tasks pushed by threads outside the pool, and their number.
+    impl::notification_queue injected_;
+    std::atomic<std::size_t> n_injected_{0};
 
     // Map from thread id to index in the vector of threads.
     std::unordered_map<std::thread::id, std::size_t> thread_ids_;
 
-    // Total number of tasks pushed in each priority level.
-    // Used to index which notification queue to enqueue tasks on to,
-    // to balance the workload among the queues.
-    std::array<std::atomic<unsigned>, n_priority> index_;
+    // Idle worker threads back off from polling for tasks to sleeping, each
+    // on its own condition variable; pushing a task wakes a sleeper if there
+    // are any, and pushing a pinned task wakes only the thread it is pinned to.
+    // The list of sleeping threads and the wake counts are guarded by sleep_mutex_.
+    std::atomic<bool> quit_{false};
+    std::atomic<unsigned> n_sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::vector<condition_variable> sleep_cv_;
+    std::vector<unsigned> wake_count_;
+    std::vector<unsigned> sleeping_;
+
+    // Tasks that must be run by a given thread, and their number, per thread.
+    // Tasks pinned to thread 0 may also be run by threads outside the pool.
+    std::vector<impl::notification_queue> pinned_;
+    std::vector<std::atomic<std::size_t>> n_pinned_;
+
+    // Logical cores to which threads are bound, by thread index; empty if
+    // threads are not bound. Thread 0, the constructing thread, is not bound.
+    std::vector<int> cpus_;
+
+    // NUMA node of each core in cpus_.
+    std::vector<int> numa_nodes_;
+
+    // Index of the calling thread's deques, or -1 if not a thread in the pool.
+    unsigned owned_queue() const;
+
+    // Take a task of at least the given priority, highest priority first:
+    // from the deques of thread i if owned, by stealing from other threads,
+    // or from injected tasks.
+    priority_task find_task(unsigned i, bool owned, int lowest_priority);
+
+    // Wake a sleeping worker, if any, after a push.
+    void notify_sleepers();
+
+    // Wake worker i, if sleeping, after a push to its pinned queue.
+    void notify_thread(unsigned i);
+
+    // Wake the worker sleeping_[k], removing it from the list; sleep_mutex_
+    // must be held.
+    void wake_locked(std::size_t k);
+
+    // Sleep until woken by a push, unless tasks are already available to thread i.
+    void wait_for_task(unsigned i);
 
 public:
     // Create zero new threads. Only worker thread is the main thread.
@@ -161,17 +274,22 @@ public:
     // Create nthreads-1 new std::threads running run_tasks_loop(tid)
     task_system(int nthreads);
 
+    // As above, and bind each new thread i to logical core
+    // affinity[i%affinity.size()]. The calling thread, which runs as thread 0,
+    // keeps its affinity: affinity[0] is the core intended for it, and callers
+    // that want it bound do so themselves. Threads are not bound if affinity
+    // is empty, or on platforms without support for thread affinity.
+    task_system(int nthreads, std::vector<int> affinity);
+
     task_system(const task_system&) = delete;
     task_system& operator=(const task_system&) = delete;
 
-    // Quits the notification queues. Joins the threads. Resets thread_depth_.
-    // Won't wait for the existing tasks in the notification queues to be executed.
+    // Signals the worker threads to quit and joins them.
+    // Won't wait for tasks remaining in the deques to be executed.
     ~task_system();
 
-    // Pushes tasks into a notification queue, on a deque of the requested priority.
-    // Will first attempt to push on all the notification queues, round-robin, starting
-    // with the notification queue at index_[priority]. If unsuccessful, forces a push
-    // onto the notification queue at index_[priority].
+    // Pushes tasks onto the calling thread's deque of the requested priority, or
+    // if the calling thread is not in the pool, onto the shared injection queue.
 
     // Public interface: run task asynchronously if priority <= max_async_task_priority,
     // else equivalent to task_system::run(priority_task) below.
@@ -180,38 +298,57 @@ public:
     // Public interface: run task synchronously with current task priority set.
     void run(priority_task ptsk);
 
+    // Public interface: run a copy of the task asynchronously, as async(), without
+    // allocating: the task is pushed by pointer, and copied when it is taken
+    // to be run. The task must outlive its execution, and should be cheap to
+    // copy, e.g. a lambda capturing a pointer.
+    void async_borrowed(const task* t, int priority);
+
+    // Public interface: run task asynchronously on thread i; unlike tasks
+    // pushed with async(), the task is not stolen by other threads. As with
+    // async(), tasks with priority above max_async_task_priority are run
+    // synchronously by the calling thread.
+    void async_on(unsigned i, priority_task ptsk);
+
     // Convenience interfaces with priority parameter:
     void async(task t, int priority) { async({std::move(t), priority}); }
     void run(task t, int priority) { run({std::move(t), priority}); }
 
     // The main function that all worker std::threads execute.
-    // It will try to acquire a task of the highest possible of priority from all
-    // of the notification queues. If unsuccessful it will force pop any task from
-    // the thread's personal queue, trying again from highest to lowest priority.
-    // Note on stack overflow possibility: the force pop can seem like it could cause
-    // an issue in cases when the personal queue only has low priority tasks that
-    // spawn higher priority tasks that end up on other queues. In that case the thread
-    // can end up in a situation where it keeps executing low priority tasks as it
-    // waits for higher priority tasks to finish, causing a stack overflow. The key
-    // point here is that while the thread is waiting for other tasks to finish, it
-    // is not executing the run_tasks_loop, but the task_group::wait() loop which
-    // doesn't use pop but always try_pop.
-    // `i` is the thread idx, used to select the thread's personal notification queue.
+    // It will try to acquire a task of the highest possible priority: first from
+    // its own deque, newest first, then by stealing the oldest task from the
+    // deques of other threads, then from the injection queue. If no task is
+    // found, it backs off: spinning, then yielding, then sleeping until a task
+    // is pushed.
+    // `i` is the thread idx, used to select the thread's own deques.
     void run_tasks_loop(int i);
 
     // Public interface: try to dequeue and run a single task with at least the
     // requested priority level. Will return without executing a task if no tasks
-    // are available or if the lock can't be acquired.
+    // are available, or if it loses a race for the available tasks.
     //
-    // Will start with queue corresponding to calling thread, if one exists.
+    // Will start with the deques of the calling thread, if one exists.
     void try_run_task(int lowest_priority);
 
     // Number of threads in pool, including master thread.
-    // Equivalently, number of notification queues.
+    // Equivalently, number of sets of deques.
     int get_num_threads() const { return (int)count_; }
 
     static int get_task_priority() { return current_task_priority_; }
 
+    // True if all tasks of the given priority pushed by the calling thread
+    // appear to have been taken by some thread: the calling thread's deque
+    // is empty or, for a thread outside the pool, the injection queue is.
+    bool queue_drained(int priority) const;
+
+    // True if the threads are bound to cores.
+    bool bound() const { return !cpus_.empty(); }
+
+    // NUMA node of the core to which each thread is bound, or intended for
+    // thread 0, by thread index; empty if the threads are not bound. Nodes
+    // are 0 where the platform does not report them.
+    const std::vector<int>& numa_nodes() const { return numa_nodes_; }
+
     // Returns the thread_id map
     std::unordered_map<std::thread::id, std::size_t> get_thread_ids() const;
 };
@@ -348,6 +485,14 @@ public:
         task_system_->async(priority_task{make_wrapped_function(std::forward<F>(f), in_flight_, exception_status_), priority});
     }
 
+    // Adds a new task to be executed by thread i of the task system.
+    template<typename F>
+    void run_on(unsigned i, F&& f) {
+        running_ = true;
+        ++in_flight_;
+        task_system_->async_on(i, priority_task{make_wrapped_function(std::forward<F>(f), in_flight_, exception_status_), task_system::get_task_priority()+1});
+    }
+
     // Wait till all tasks in this group are done.
     // While waiting the thread will participate in executing the tasks.
     // It's necessary that the waiting thread participate in execution:
@@ -373,29 +518,257 @@ public:
     }
 };
 
+// A parallel loop over an index range, which can be run repeatedly without
+// allocating tasks. The calling thread, and at most one helper task for each
+// other thread, take chunks of indices from a shared counter until the range
+// is exhausted. Helper tasks are held by the loop and pushed to the task
+// system as borrowed tasks. Helpers run with priority one higher than that of
+// the calling thread, as for a task_group.
+//
+// A parallel_loop must not be run concurrently with itself; distinct loops
+// may be nested, or run concurrently.
+class parallel_loop {
+public:
+    explicit parallel_loop(task_system* ts): task_system_(ts) {}
+
+    parallel_loop(const parallel_loop&) = delete;
+    parallel_loop& operator=(const parallel_loop&) = delete;
+
+    // Call f(i) for each i in [0, n), taking indices grain at a time.
+    template <typename F>
+    void run(std::size_t n, F&& f, std::size_t grain = 1) {
+        bind(std::forward<F>(f));
+        run_shared(n, nullptr, grain);
+    }
+
+    // Call f(order[k]) for each k, with indices started in order: indices
+    // early in the order are started first, whichever threads run them.
+    template <typename F>
+    void run_ordered(const std::vector<unsigned>& order, F&& f) {
+        bind(std::forward<F>(f));
+        run_shared(order.size(), order.data(), 1);
+    }
+
+    // Call f(i) for each i in [0, n), with the range divided into contiguous
+    // blocks of near equal size, each run by a fixed thread of the task system.
+    // Repeated calls over the same range run each index on the same thread.
+    template <typename F>
+    void run_pinned(std::size_t n, F&& f) {
+        bind(std::forward<F>(f));
+        run_pinned(n, nullptr, nullptr, false);
+    }
+
+    // Call f(order[k]) for each k in [bounds[t], bounds[t+1]) on thread t of
+    // the task system, where bounds has one more entry than there are threads.
+    template <typename F>
+    void run_pinned(const std::vector<unsigned>& order, const std::vector<std::size_t>& bounds, F&& f) {
+        bind(std::forward<F>(f));
+        run_pinned(order.size(), order.data(), bounds.data(), false);
+    }
+
+    // As run_pinned, but a thread that has finished its own block takes the
+    // remaining indices of other blocks, so that a thread busy with other
+    // work does not hold up the loop. Indices are taken from the start of
+    // each block, so each stays with its thread while the load is balanced.
+    template <typename F>
+    void run_affine(const std::vector<unsigned>& order, const std::vector<std::size_t>& bounds, F&& f) {
+        bind(std::forward<F>(f));
+        run_pinned(order.size(), order.data(), bounds.data(), true);
+    }
+
+private:
+    task_system* task_system_;
+
+    // Type-erased loop body: call_(body_, i) calls f(i).
+    void (*call_)(void*, std::size_t) = nullptr;
+    void* body_ = nullptr;
+
+    std::size_t n_ = 0;
+    std::size_t grain_ = 1;
+    const unsigned* order_ = nullptr;
+    const std::size_t* bounds_ = nullptr;
+
+    std::atomic<std::size_t> next_{0};
+    std::atomic<unsigned> pending_{0};
+
+    // Next index in each thread's block, for pinned iteration with stealing.
+    bool steal_ = false;
+    std::unique_ptr<std::atomic<std::size_t>[]> block_next_;
+
+    std::atomic<bool> error_{false};
+    std::exception_ptr exception_;
+    std::mutex exception_mutex_;
+
+    // Borrowed helper tasks: one for shared iteration, and one per thread for
+    // pinned iteration, created on first use.
+    task helper_ = [this] { work(); finish(); };
+    std::vector<task> pinned_helpers_;
+
+    template <typename F>
+    void bind(F&& f) {
+        using body_type = std::remove_reference_t<F>;
+        body_ = const_cast<void*>(static_cast<const void*>(&f));
+        call_ = [](void* b, std::size_t i) { (*static_cast<body_type*>(b))(i); };
+    }
+
+    void run_shared(std::size_t n, const unsigned* order, std::size_t grain);
+    void run_pinned(std::size_t n, const unsigned* order, const std::size_t* bounds, bool steal);
+
+    // Take chunks of indices from the shared counter until exhausted.
+    void work();
+
+    // Thread i runs the indices [block_begin(i), block_begin(i+1)), and if
+    // stealing, then the remaining indices of the other blocks.
+    std::size_t block_begin(std::size_t i) const;
+    void work_block(unsigned i);
+    void work_remaining(unsigned b);
+
+    void call(std::size_t i);
+    void set_exception(std::exception_ptr ex);
+
+    // Signal completion of a helper task; this is the last access to the
+    // loop by the helper.
+    void finish() { pending_.fetch_sub(1, std::memory_order_release); }
+
+    // Participate in running tasks until all helpers have finished, then
+    // rethrow the first exception raised in the body, if any.
+    void wait(int priority);
+};
+
 ///////////////////////////////////////////////////////////////////////
 // algorithms
 ///////////////////////////////////////////////////////////////////////
+namespace impl {
+// Lazy binary splitting of an index range. Each task runs its range grain
+// indices at a time, and whenever the tasks of the given priority pushed by
+// its thread have all been taken, suggesting that other threads are idle,
+// splits off the upper half of its remaining range as a new task. The number
+// of tasks thus adapts to the demand for work: when all threads are busy,
+// ranges are run without further splitting.
+//
+// Each task creates local state with init(), calls body(local, i) for each
+// index in its range, then calls finish(local).
+template <typename Init, typename Body, typename Finish>
+struct range_splitter {
+    int grain;
+    int priority;
+    task_group& group;
+    task_system* ts;
+    Init& init;
+    Body& body;
+    Finish& finish;
+
+    void operator()(int left, int right) {
+        auto local = init();
+        while (left < right) {
+            if (right-left > grain && ts->queue_drained(priority)) {
+                int mid = left + (right-left)/2;
+                group.run([this, mid, right] { (*this)(mid, right); }, priority);
+                right = mid;
+            }
+            int end = right-left > grain? left+grain: right;
+            for (; left < end; ++left) {
+                body(local, left);
+            }
+        }
+        finish(local);
+    }
+};
+
+// Run [left, right) with a range_splitter on the calling thread and wait for
+// all split tasks, rethrowing the first exception raised by any of them.
+template <typename Init, typename Body, typename Finish>
+void split_range(int left, int right, int grain, task_system* ts, Init init, Body body, Finish finish) {
+    task_group g(ts);
+    range_splitter<Init, Body, Finish> split{std::max(grain, 1), task_system::get_task_priority()+1, g, ts, init, body, finish};
+    try {
+        split(left, right);
+    }
+    catch (...) {
+        try { g.wait(); } catch (...) {}
+        throw;
+    }
+    g.wait();
+}
+} // namespace impl
+
 struct parallel_for {
-    // Creates a task group, enqueues tasks and waits for their completion.
-    // If a batching size if not specified, a default batch size of 1 is used.
+    // Runs f(i) for i in [left, right) on the task system and waits for
+    // their completion, taking indices batch_size at a time.
     template <typename F>
     static void apply(int left, int right, int batch_size, task_system* ts, F f) {
-        task_group g(ts);
-        for (int i = left; i < right; i += batch_size) {
-            g.run([=] {
-                int r = i + batch_size < right ? i + batch_size : right;
-                for (int j = i; j < r; ++j) {
-                    f(j);
-                }
-            });
+        if (right <= left) return;
+        parallel_loop loop(ts);
+        loop.run(right-left, [&](std::size_t i) { f(left+(int)i); }, batch_size);
+    }
+
+    // As above, but with the range split adaptively: the range is divided
+    // in halves only while other threads are idle, and indices are run
+    // grain at a time between checks for idle threads.
+    template <typename F>
+    static void apply(int left, int right, task_system* ts, F f, int grain = 1) {
+        if (right <= left) return;
+        if (serial(ts)) {
+            for (int i = left; i < right; ++i) {
+                f(i);
+            }
+            return;
         }
-        g.wait();
+        impl::split_range(left, right, grain, ts,
+            [] { return 0; },
+            [&](int, int i) { f(i); },
+            [](int) {});
+    }
+
+    // As apply, but with the indices started in the order given by `order`.
+    template <typename F>
+    static void apply_ordered(const std::vector<unsigned>& order, task_system* ts, F f) {
+        parallel_loop loop(ts);
+        loop.run_ordered(order, f);
     }
 
+    // As apply, but with each index run on a fixed thread, dividing the
+    // range into contiguous blocks of near equal size, one per thread.
+    // Repeated calls over the same range run each index on the same thread.
     template <typename F>
-    static void apply(int left, int right, task_system* ts, F f) {
-        apply(left, right, 1, ts, std::move(f));
+    static void apply_pinned(int left, int right, task_system* ts, F f) {
+        if (right <= left) return;
+        parallel_loop loop(ts);
+        loop.run_pinned(right-left, [&](std::size_t i) { f(left+(int)i); });
+    }
+
+    // True if tasks would not run in parallel: with a single thread, or with
+    // nesting so deep that tasks are run synchronously.
+    static bool serial(task_system* ts) {
+        return ts->get_num_threads()==1 || task_system::get_task_priority()+1 > max_async_task_priority;
+    }
+};
+
+struct parallel_reduce {
+    // Returns the reduction with combine of f(i) for i in [left, right),
+    // starting from identity, with the range split as for parallel_for::apply.
+    // Each task reduces its own indices in order, and the partial results of
+    // tasks are combined in an unspecified order: combine must be associative
+    // and commutative.
+    template <typename T, typename F, typename C>
+    static T apply(int left, int right, task_system* ts, T identity, F f, C combine, int grain = 1) {
+        if (parallel_for::serial(ts)) {
+            for (int i = left; i < right; ++i) {
+                identity = combine(std::move(identity), f(i));
+            }
+            return identity;
+        }
+
+        T result = identity;
+        std::mutex m;
+        impl::split_range(left, right, grain, ts,
+            [&] { return identity; },
+            [&](T& partial, int i) { partial = combine(std::move(partial), f(i)); },
+            [&](T& partial) {
+                std::lock_guard<std::mutex> l(m);
+                result = combine(std::move(result), std::move(partial));
+            });
+        return result;
     }
 };
 } // namespace threading
@@ -0,0 +1,107 @@
+#pragma once
+
+// Binary spike files hold a time-sorted spike record, as written on each rank
+// from a local spike callback by a `spike_writer`. Per-rank files are merged
+// into one globally time-sorted file with `merge_spike_files`, and read back
+// through a memory map by a `spike_reader`.
+//
+// File layout, in host byte order:
+//   header:  one spike_file_header
+//   spikes:  n_spike arb::spike records, ordered by time, then source
+//
+// While a file is being written, its size may exceed that given by the
+// header by the preallocated capacity; n_spike is kept current.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arbor/arbexcept.hpp>
+#include <arbor/simulation.hpp>
+#include <arbor/spike.hpp>
+
+namespace arborio {
+
+struct spike_file_error: public arb::arbor_exception {
+    explicit spike_file_error(const std::string& msg);
+};
+
+struct spike_file_header {
+    char magic[8];              // "ARBSPIKE"
+    std::uint32_t version;
+    std::uint32_t record_size;  // sizeof(arb::spike)
+    std::uint64_t n_spike;
+};
+
+// Spikes are copied into a memory-mapped file, preallocated with room for
+// `capacity` spikes and grown by doubling as required. Each batch of spikes
+// is sorted in place.
+//
+// The spikes passed to a local spike callback do not precede those of the
+// previous call, unless the simulation has been reset. A call to
+// `start_segment`, as after a reset, closes the current file and starts a
+// new segment, written to `path.1`, `path.2`, and so on; each segment is a
+// time-sorted spike file. A batch that begins before the last spike written
+// to the current segment throws spike_file_error, and is not written.
+// The spike_writer must outlive any simulation using its callback.
+
+class spike_writer {
+public:
+    explicit spike_writer(const std::string& path, std::size_t capacity = 1<<20);
+    ~spike_writer();
+
+    spike_writer(const spike_writer&) = delete;
+    spike_writer& operator=(const spike_writer&) = delete;
+
+    arb::spike_export_function callback();
+
+    void append(const std::vector<arb::spike>& spikes);
+
+    // Close the current segment; subsequent spikes are written to a new one.
+    void start_segment();
+
+    // Paths of the segments written so far, in order.
+    std::vector<std::string> segments() const;
+
+    // Number of spikes in the current segment.
+    std::size_t size() const;
+
+    // Truncate the file to the spikes written; throws spike_file_error on I/O failure.
+    void close();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+class spike_reader {
+public:
+    explicit spike_reader(const std::string& path);
+    ~spike_reader();
+
+    spike_reader(spike_reader&&);
+    spike_reader& operator=(spike_reader&&);
+
+    const spike_file_header& header() const;
+
+    std::size_t size() const;
+    const arb::spike* data() const;
+
+    const arb::spike* begin() const { return data(); }
+    const arb::spike* end() const { return data()+size(); }
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+// Merge time-sorted spike files into one time-sorted file at `output`,
+// returning the number of spikes written. The output is divided into
+// `n_thread` time intervals which are merged concurrently; if zero, the
+// hardware concurrency is used.
+
+std::size_t merge_spike_files(const std::vector<std::string>& inputs, const std::string& output, unsigned n_thread = 0);
+
+} // namespace arborio
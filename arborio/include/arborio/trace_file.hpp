@@ -0,0 +1,105 @@
+#pragma once
+
+// Binary trace files hold samples from many probes, as written from a bulk
+// sampler by a `trace_writer`, and are read back lazily by a `trace_reader`
+// through a memory map. One file is written per rank.
+//
+// File layout, in host byte order:
+//   header:      one trace_file_header
+//   blocks:      n_record records, in blocks of block_size trace_record
+//                entries; the last block is zero padded
+//   probe table: n_probe trace_probe entries, at probe_table_offset
+//
+// Records from one probe appear in time order; records from different
+// probes are interleaved in the order in which samples were delivered.
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arbor/arbexcept.hpp>
+#include <arbor/common_types.hpp>
+#include <arbor/sampling.hpp>
+
+namespace arborio {
+
+struct trace_error: public arb::arbor_exception {
+    explicit trace_error(const std::string& msg);
+};
+
+struct trace_file_header {
+    char magic[8];                    // "ARBTRACE"
+    std::uint32_t version;
+    std::uint32_t record_size;        // sizeof(trace_record)
+    std::uint64_t block_size;         // records per block
+    std::uint64_t n_record;           // records, excluding block padding
+    std::uint64_t n_probe;
+    std::uint64_t probe_table_offset; // (bytes) from start of file
+};
+
+struct trace_probe {
+    arb::cell_gid_type gid;  // probe id
+    arb::cell_lid_type lid;
+    std::uint32_t index;     // index of probe source within those supplied by probe id
+    arb::probe_tag tag;
+};
+
+struct trace_record {
+    std::uint64_t probe;     // index into probe table
+    double time;
+    double value;
+};
+
+// Samples are copied into one of two in-memory buffers by the bulk sampler
+// returned by `sampler()`; a background thread writes out the other. Once
+// the sampler has filled a block, it waits for the writer to finish the
+// previous one, so memory use is bounded by about two blocks.
+// The trace_writer must outlive any simulation using its sampler.
+
+class trace_writer {
+public:
+    explicit trace_writer(const std::string& path, std::size_t block_size = 1<<14);
+    ~trace_writer();
+
+    trace_writer(const trace_writer&) = delete;
+    trace_writer& operator=(const trace_writer&) = delete;
+
+    arb::bulk_sampler_function sampler();
+
+    // Write remaining samples and the probe table; throws trace_error on I/O failure.
+    void close();
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+class trace_reader {
+public:
+    explicit trace_reader(const std::string& path);
+    ~trace_reader();
+
+    trace_reader(trace_reader&&);
+    trace_reader& operator=(trace_reader&&);
+
+    const trace_file_header& header() const;
+
+    std::size_t num_probes() const;
+    const trace_probe* probes() const;
+
+    std::size_t num_records() const;
+    const trace_record* records() const;
+
+    // Collect (time, value) samples for one entry of the probe table, through
+    // an index of the records of each probe built when the file is opened.
+    std::vector<std::pair<double, double>> trace(std::size_t probe) const;
+
+private:
+    struct impl;
+    std::unique_ptr<impl> impl_;
+};
+
+} // namespace arborio
@@ -0,0 +1,371 @@
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <arbor/simulation.hpp>
+#include <arbor/spike.hpp>
+
+#include <arborio/spike_file.hpp>
+
+namespace arborio {
+
+static_assert(std::is_trivially_copyable<spike_file_header>::value, "spike file header must be trivially copyable");
+static_assert(std::is_trivially_copyable<arb::spike>::value, "spike must be trivially copyable");
+
+static constexpr char spike_magic[8] = {'A', 'R', 'B', 'S', 'P', 'I', 'K', 'E'};
+static constexpr std::uint32_t spike_version = 1;
+
+spike_file_error::spike_file_error(const std::string& msg):
+    arbor_exception("spike file: "+msg)
+{}
+
+static std::size_t file_size(std::size_t n_spike) {
+    return sizeof(spike_file_header)+n_spike*sizeof(arb::spike);
+}
+
+static spike_file_header make_header(std::size_t n_spike) {
+    spike_file_header h;
+    std::memcpy(h.magic, spike_magic, sizeof(h.magic));
+    h.version = spike_version;
+    h.record_size = sizeof(arb::spike);
+    h.n_spike = n_spike;
+    return h;
+}
+
+// Spike order in files: by time, then by source.
+static bool spike_before(const arb::spike& a, const arb::spike& b) {
+    return a.time<b.time || (a.time==b.time && a.source<b.source);
+}
+
+// spike_writer:
+
+struct spike_writer::impl {
+    std::string base_path;
+    std::vector<std::string> segments;
+    std::string path;
+    int fd = -1;
+    char* base = nullptr;
+    std::size_t initial_capacity = 0;
+    std::size_t capacity = 0;
+    std::size_t n_spike = 0;
+    std::mutex mex;
+
+    impl(const std::string& path, std::size_t capacity):
+        base_path(path), initial_capacity(std::max<std::size_t>(capacity, 1))
+    {
+        open_segment();
+    }
+
+    ~impl() {
+        try { close(); } catch (...) {}
+    }
+
+    arb::spike* spikes() const {
+        return reinterpret_cast<arb::spike*>(base+sizeof(spike_file_header));
+    }
+
+    // Open the file for the next segment: the first is written to the path
+    // given on construction, and segment k to that path with suffix `.k`.
+    void open_segment() {
+        path = segments.empty()? base_path: base_path+"."+std::to_string(segments.size());
+        fd = ::open(path.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+        if (fd<0) throw spike_file_error("unable to open "+path+" for writing");
+
+        capacity = 0;
+        n_spike = 0;
+        try {
+            remap(initial_capacity);
+        }
+        catch (...) {
+            ::close(fd);
+            fd = -1;
+            throw;
+        }
+        spike_file_header h = make_header(0);
+        std::memcpy(base, &h, sizeof(h));
+        segments.push_back(path);
+    }
+
+    // Grow the file to hold `new_capacity` spikes, and map it afresh.
+    void remap(std::size_t new_capacity) {
+        if (base) {
+            ::munmap(base, file_size(capacity));
+            base = nullptr;
+        }
+        if (::ftruncate(fd, file_size(new_capacity))) {
+            throw spike_file_error("unable to extend "+path);
+        }
+
+        void* p = ::mmap(nullptr, file_size(new_capacity), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p==MAP_FAILED) throw spike_file_error("unable to map "+path);
+
+        base = static_cast<char*>(p);
+        capacity = new_capacity;
+    }
+
+    void append(const std::vector<arb::spike>& batch) {
+        std::lock_guard<std::mutex> guard(mex);
+        if (fd<0) throw spike_file_error(path+" is closed");
+        if (batch.empty()) return;
+
+        auto earliest = *std::min_element(batch.begin(), batch.end(), spike_before);
+        if (n_spike && spike_before(earliest, spikes()[n_spike-1])) {
+            // The spike source has been rewound, as by a simulation reset,
+            // without a new segment being started.
+            throw spike_file_error("spikes precede those already written to "+path+"; call start_segment after a reset");
+        }
+
+        if (n_spike+batch.size()>capacity) {
+            remap(std::max(2*capacity, n_spike+batch.size()));
+        }
+
+        arb::spike* first = spikes()+n_spike;
+        std::memcpy(first, batch.data(), batch.size()*sizeof(arb::spike));
+        std::sort(first, first+batch.size(), spike_before);
+
+        n_spike += batch.size();
+        reinterpret_cast<spike_file_header*>(base)->n_spike = n_spike;
+    }
+
+    void start_segment() {
+        std::lock_guard<std::mutex> guard(mex);
+        if (fd<0) throw spike_file_error(path+" is closed");
+
+        close_segment();
+        open_segment();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> guard(mex);
+        close_segment();
+    }
+
+    // Truncate and close the current segment file.
+    void close_segment() {
+        if (fd<0) return;
+
+        ::munmap(base, file_size(capacity));
+        base = nullptr;
+
+        bool failed = ::ftruncate(fd, file_size(n_spike));
+        failed |= ::close(fd)!=0;
+        fd = -1;
+
+        if (failed) throw spike_file_error("error writing to "+path);
+    }
+};
+
+spike_writer::spike_writer(const std::string& path, std::size_t capacity):
+    impl_(new impl(path, capacity))
+{}
+
+spike_writer::~spike_writer() = default;
+
+arb::spike_export_function spike_writer::callback() {
+    impl* p = impl_.get();
+    return [p](const std::vector<arb::spike>& spikes) { p->append(spikes); };
+}
+
+void spike_writer::append(const std::vector<arb::spike>& spikes) {
+    impl_->append(spikes);
+}
+
+void spike_writer::start_segment() {
+    impl_->start_segment();
+}
+
+std::vector<std::string> spike_writer::segments() const {
+    std::lock_guard<std::mutex> guard(impl_->mex);
+    return impl_->segments;
+}
+
+std::size_t spike_writer::size() const {
+    std::lock_guard<std::mutex> guard(impl_->mex);
+    return impl_->n_spike;
+}
+
+void spike_writer::close() {
+    impl_->close();
+}
+
+// spike_reader:
+
+struct spike_reader::impl {
+    void* map = nullptr;
+    std::size_t size = 0;
+
+    const spike_file_header* header = nullptr;
+    const arb::spike* spikes = nullptr;
+
+    explicit impl(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd<0) throw spike_file_error("unable to open "+path);
+
+        struct stat st;
+        if (::fstat(fd, &st) || st.st_size<(off_t)sizeof(spike_file_header)) {
+            ::close(fd);
+            throw spike_file_error(path+" is not a spike file");
+        }
+
+        size = st.st_size;
+        map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map==MAP_FAILED) {
+            map = nullptr;
+            throw spike_file_error("unable to map "+path);
+        }
+
+        const char* base = static_cast<const char*>(map);
+        header = reinterpret_cast<const spike_file_header*>(base);
+
+        bool valid =
+            !std::memcmp(header->magic, spike_magic, sizeof(spike_magic)) &&
+            header->version==spike_version &&
+            header->record_size==sizeof(arb::spike) &&
+            file_size(header->n_spike)<=size;
+
+        if (!valid) {
+            ::munmap(map, size);
+            map = nullptr;
+            throw spike_file_error(path+" is not a valid spike file");
+        }
+
+        spikes = reinterpret_cast<const arb::spike*>(base+sizeof(spike_file_header));
+    }
+
+    ~impl() {
+        if (map) ::munmap(map, size);
+    }
+};
+
+spike_reader::spike_reader(const std::string& path):
+    impl_(new impl(path))
+{}
+
+spike_reader::~spike_reader() = default;
+spike_reader::spike_reader(spike_reader&&) = default;
+spike_reader& spike_reader::operator=(spike_reader&&) = default;
+
+const spike_file_header& spike_reader::header() const {
+    return *impl_->header;
+}
+
+std::size_t spike_reader::size() const {
+    return impl_->header->n_spike;
+}
+
+const arb::spike* spike_reader::data() const {
+    return impl_->spikes;
+}
+
+// merge_spike_files:
+
+using spike_range = std::pair<const arb::spike*, const arb::spike*>;
+
+// k-way merge of sorted ranges with a heap keyed on the head of each range.
+static void merge_ranges(std::vector<spike_range> ranges, arb::spike* out) {
+    ranges.erase(std::remove_if(ranges.begin(), ranges.end(),
+                     [](const spike_range& r) { return r.first==r.second; }),
+                 ranges.end());
+
+    auto later = [](const spike_range& a, const spike_range& b) { return spike_before(*b.first, *a.first); };
+    std::make_heap(ranges.begin(), ranges.end(), later);
+
+    while (!ranges.empty()) {
+        std::pop_heap(ranges.begin(), ranges.end(), later);
+        spike_range& r = ranges.back();
+        *out++ = *r.first++;
+
+        if (r.first==r.second) {
+            ranges.pop_back();
+        }
+        else {
+            std::push_heap(ranges.begin(), ranges.end(), later);
+        }
+    }
+}
+
+std::size_t merge_spike_files(const std::vector<std::string>& inputs, const std::string& output, unsigned n_thread) {
+    std::vector<spike_reader> readers;
+    std::size_t n_spike = 0;
+    for (const auto& path: inputs) {
+        readers.emplace_back(path);
+        n_spike += readers.back().size();
+    }
+
+    // Split the time range into intervals with roughly equal spike counts,
+    // using quantiles of the largest input; each interval is bounded in each
+    // input by binary search, and merged into its own part of the output.
+
+    constexpr std::size_t min_spikes_per_thread = 1<<16;
+    if (!n_thread) n_thread = std::max(1u, std::thread::hardware_concurrency());
+    n_thread = std::max<std::size_t>(1, std::min<std::size_t>(n_thread, n_spike/min_spikes_per_thread));
+
+    std::vector<double> split_times;
+    if (n_thread>1) {
+        auto& largest = *std::max_element(readers.begin(), readers.end(),
+            [](const spike_reader& a, const spike_reader& b) { return a.size()<b.size(); });
+
+        for (unsigned i = 1; i<n_thread; ++i) {
+            split_times.push_back(largest.data()[i*largest.size()/n_thread].time);
+        }
+    }
+
+    auto time_less = [](const arb::spike& s, double t) { return s.time<t; };
+
+    std::vector<std::vector<spike_range>> parts(n_thread);
+    std::vector<std::size_t> part_offset(n_thread+1, 0);
+    for (unsigned i = 0; i<n_thread; ++i) {
+        for (const spike_reader& r: readers) {
+            auto b = i==0? r.begin(): std::lower_bound(r.begin(), r.end(), split_times[i-1], time_less);
+            auto e = i+1==n_thread? r.end(): std::lower_bound(r.begin(), r.end(), split_times[i], time_less);
+            parts[i].push_back({b, e});
+            part_offset[i+1] += e-b;
+        }
+        part_offset[i+1] += part_offset[i];
+    }
+
+    int fd = ::open(output.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+    if (fd<0) throw spike_file_error("unable to open "+output+" for writing");
+
+    if (::ftruncate(fd, file_size(n_spike))) {
+        ::close(fd);
+        throw spike_file_error("unable to extend "+output);
+    }
+
+    void* map = ::mmap(nullptr, file_size(n_spike), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map==MAP_FAILED) {
+        ::close(fd);
+        throw spike_file_error("unable to map "+output);
+    }
+
+    char* base = static_cast<char*>(map);
+    spike_file_header h = make_header(n_spike);
+    std::memcpy(base, &h, sizeof(h));
+    arb::spike* out = reinterpret_cast<arb::spike*>(base+sizeof(spike_file_header));
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i<n_thread; ++i) {
+        threads.emplace_back([&, i] { merge_ranges(parts[i], out+part_offset[i]); });
+    }
+    merge_ranges(parts[0], out);
+    for (auto& t: threads) t.join();
+
+    bool failed = ::munmap(map, file_size(n_spike));
+    failed |= ::close(fd)!=0;
+    if (failed) throw spike_file_error("error writing to "+output);
+
+    return n_spike;
+}
+
+} // namespace arborio
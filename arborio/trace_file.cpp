@@ -0,0 +1,308 @@
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <arbor/common_types.hpp>
+#include <arbor/sampling.hpp>
+
+#include <arborio/trace_file.hpp>
+
+namespace arborio {
+
+static_assert(std::is_trivially_copyable<trace_file_header>::value, "trace file header must be trivially copyable");
+static_assert(std::is_trivially_copyable<trace_probe>::value, "trace probe must be trivially copyable");
+static_assert(std::is_trivially_copyable<trace_record>::value, "trace record must be trivially copyable");
+
+static constexpr char trace_magic[8] = {'A', 'R', 'B', 'T', 'R', 'A', 'C', 'E'};
+static constexpr std::uint32_t trace_version = 1;
+
+trace_error::trace_error(const std::string& msg):
+    arbor_exception("trace file: "+msg)
+{}
+
+// trace_writer:
+
+struct trace_writer::impl {
+    std::FILE* out = nullptr;
+    std::string path;
+    std::size_t block_size;
+
+    std::mutex mex;
+    std::condition_variable cv;
+    std::thread thread;
+
+    // Samples are appended to front under the mutex; back is written
+    // by the writer thread when pending is set.
+    std::vector<trace_record> front, back;
+    bool pending = false;
+    bool closing = false;
+    bool closed = false;
+    bool io_failed = false;
+    std::uint64_t n_record = 0;
+
+    std::map<std::tuple<arb::cell_gid_type, arb::cell_lid_type, unsigned>, std::uint64_t> probe_index;
+    std::vector<trace_probe> probes;
+
+    impl(const std::string& path, std::size_t block_size): path(path), block_size(block_size) {
+        if (!block_size) throw trace_error("block size must be positive");
+
+        out = std::fopen(path.c_str(), "wb");
+        if (!out) throw trace_error("unable to open "+path+" for writing");
+
+        // Header is rewritten with final counts on close.
+        trace_file_header h = make_header();
+        write(&h, sizeof(h));
+
+        front.reserve(block_size);
+        back.reserve(block_size);
+        thread = std::thread([this] { run(); });
+    }
+
+    ~impl() {
+        try { close(); } catch (...) {}
+    }
+
+    trace_file_header make_header() const {
+        trace_file_header h;
+        std::memcpy(h.magic, trace_magic, sizeof(h.magic));
+        h.version = trace_version;
+        h.record_size = sizeof(trace_record);
+        h.block_size = block_size;
+        h.n_record = n_record;
+        h.n_probe = probes.size();
+        h.probe_table_offset = 0;
+        return h;
+    }
+
+    void write(const void* p, std::size_t n) {
+        if (n && std::fwrite(p, 1, n, out)!=n) io_failed = true;
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mex);
+        for (;;) {
+            cv.wait(lock, [this] { return pending || closing; });
+            if (!pending) break;
+
+            lock.unlock();
+            write(back.data(), back.size()*sizeof(trace_record));
+            lock.lock();
+
+            back.clear();
+            pending = false;
+            cv.notify_all();
+        }
+    }
+
+    void append(const arb::sample_columns& cols) {
+        std::unique_lock<std::mutex> lock(mex);
+        if (closing) return;
+
+        for (std::size_t k = 0; k<cols.n_probe; ++k) {
+            const arb::probe_metadata& pm = cols.meta[k];
+            auto key = std::make_tuple(pm.id.gid, pm.id.index, pm.index);
+            auto ins = probe_index.insert({key, probes.size()});
+            if (ins.second) {
+                probes.push_back({pm.id.gid, pm.id.index, pm.index, pm.tag});
+            }
+
+            std::uint64_t probe = ins.first->second;
+            const double* time = cols.time+k*cols.n_sample;
+            const double* value = cols.value+k*cols.n_sample;
+            for (std::size_t j = 0; j<cols.n_sample; ++j) {
+                front.push_back({probe, time[j], value[j]});
+            }
+        }
+        n_record += cols.n_probe*cols.n_sample;
+
+        // Hand over the front buffer once it holds at least one block. If the
+        // writer thread is still busy with the last one, wait for it, so that
+        // the front buffer never holds more than a block and one batch.
+        if (front.size()>=block_size) {
+            cv.wait(lock, [this] { return !pending; });
+            std::swap(front, back);
+            pending = true;
+            cv.notify_all();
+        }
+    }
+
+    void close() {
+        {
+            std::unique_lock<std::mutex> lock(mex);
+            if (closed) return;
+            closed = true;
+            cv.wait(lock, [this] { return !pending; });
+            closing = true;
+            cv.notify_all();
+        }
+        thread.join();
+
+        // Remaining samples, padding to a whole number of blocks, probe table.
+        write(front.data(), front.size()*sizeof(trace_record));
+        front.clear();
+
+        std::uint64_t n_padded = (n_record+block_size-1)/block_size*block_size;
+        std::vector<trace_record> padding(n_padded-n_record, trace_record{0, 0., 0.});
+        write(padding.data(), padding.size()*sizeof(trace_record));
+
+        trace_file_header h = make_header();
+        h.probe_table_offset = sizeof(trace_file_header)+n_padded*sizeof(trace_record);
+        write(probes.data(), probes.size()*sizeof(trace_probe));
+
+        if (std::fseek(out, 0, SEEK_SET)) io_failed = true;
+        write(&h, sizeof(h));
+        if (std::fclose(out)) io_failed = true;
+        out = nullptr;
+
+        if (io_failed) throw trace_error("error writing to "+path);
+    }
+};
+
+trace_writer::trace_writer(const std::string& path, std::size_t block_size):
+    impl_(new impl(path, block_size))
+{}
+
+trace_writer::~trace_writer() = default;
+
+arb::bulk_sampler_function trace_writer::sampler() {
+    impl* p = impl_.get();
+    return [p](const arb::sample_columns& cols) { p->append(cols); };
+}
+
+void trace_writer::close() {
+    impl_->close();
+}
+
+// trace_reader:
+
+struct trace_reader::impl {
+    void* map = nullptr;
+    std::size_t size = 0;
+
+    const trace_file_header* header = nullptr;
+    const trace_record* records = nullptr;
+    const trace_probe* probes = nullptr;
+
+    // Indices of the records of each probe, in file order: those of probe p
+    // are probe_records[probe_divs[p]..probe_divs[p+1]).
+    std::vector<std::uint64_t> probe_divs;
+    std::vector<std::uint64_t> probe_records;
+
+    explicit impl(const std::string& path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd<0) throw trace_error("unable to open "+path);
+
+        struct stat st;
+        if (::fstat(fd, &st) || st.st_size<(off_t)sizeof(trace_file_header)) {
+            ::close(fd);
+            throw trace_error(path+" is not a trace file");
+        }
+
+        size = st.st_size;
+        map = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (map==MAP_FAILED) {
+            map = nullptr;
+            throw trace_error("unable to map "+path);
+        }
+
+        const char* base = static_cast<const char*>(map);
+        header = reinterpret_cast<const trace_file_header*>(base);
+
+        bool valid =
+            !std::memcmp(header->magic, trace_magic, sizeof(trace_magic)) &&
+            header->version==trace_version &&
+            header->record_size==sizeof(trace_record) &&
+            header->block_size>0 &&
+            header->probe_table_offset>=sizeof(trace_file_header)+header->n_record*sizeof(trace_record) &&
+            header->probe_table_offset+header->n_probe*sizeof(trace_probe)<=size;
+
+        if (!valid) {
+            ::munmap(map, size);
+            map = nullptr;
+            throw trace_error(path+" is not a valid trace file");
+        }
+
+        records = reinterpret_cast<const trace_record*>(base+sizeof(trace_file_header));
+        probes = reinterpret_cast<const trace_probe*>(base+header->probe_table_offset);
+
+        const std::uint64_t n_record = header->n_record, n_probe = header->n_probe;
+        probe_divs.assign(n_probe+1, 0);
+        for (std::uint64_t i = 0; i<n_record; ++i) {
+            if (records[i].probe>=n_probe) {
+                ::munmap(map, size);
+                map = nullptr;
+                throw trace_error(path+" is not a valid trace file");
+            }
+            ++probe_divs[records[i].probe+1];
+        }
+        for (std::uint64_t p = 0; p<n_probe; ++p) probe_divs[p+1] += probe_divs[p];
+
+        probe_records.resize(n_record);
+        std::vector<std::uint64_t> fill(probe_divs.begin(), probe_divs.end()-1);
+        for (std::uint64_t i = 0; i<n_record; ++i) {
+            probe_records[fill[records[i].probe]++] = i;
+        }
+    }
+
+    ~impl() {
+        if (map) ::munmap(map, size);
+    }
+};
+
+trace_reader::trace_reader(const std::string& path):
+    impl_(new impl(path))
+{}
+
+trace_reader::~trace_reader() = default;
+trace_reader::trace_reader(trace_reader&&) = default;
+trace_reader& trace_reader::operator=(trace_reader&&) = default;
+
+const trace_file_header& trace_reader::header() const {
+    return *impl_->header;
+}
+
+std::size_t trace_reader::num_probes() const {
+    return impl_->header->n_probe;
+}
+
+const trace_probe* trace_reader::probes() const {
+    return impl_->probes;
+}
+
+std::size_t trace_reader::num_records() const {
+    return impl_->header->n_record;
+}
+
+const trace_record* trace_reader::records() const {
+    return impl_->records;
+}
+
+std::vector<std::pair<double, double>> trace_reader::trace(std::size_t probe) const {
+    std::vector<std::pair<double, double>> result;
+    if (probe>=num_probes()) return result;
+
+    const trace_record* r = records();
+    const auto& divs = impl_->probe_divs;
+    result.reserve(divs[probe+1]-divs[probe]);
+    for (auto k = divs[probe]; k<divs[probe+1]; ++k) {
+        const trace_record& x = r[impl_->probe_records[k]];
+        result.push_back({x.time, x.value});
+    }
+    return result;
+}
+
+} // namespace arborio
@@ -36,6 +36,9 @@ struct bench_params {
         double spike_freq_hz = 10;   // Frequency in hz that cell will generate (poisson) spikes.
         double realtime_ratio = 0.1; // Integration speed relative to real time, e.g. 10 implies
                                      // that a cell is integrated 10 times slower than real time.
+        std::size_t bytes_per_step = 0;    // Bytes of cell state streamed per time step.
+        std::size_t working_set_bytes = 0; // Size of cell state cycled over by streaming.
+        double event_cost_us = 0;          // Time in µs to process each post-synaptic event.
     };
     struct network_params {
         unsigned fan_in = 5000;      // Number of incoming connections on each cell.
@@ -44,6 +47,7 @@ struct bench_params {
     std::string name = "default";    // Name of the model.
     unsigned num_cells = 1000;       // Number of cells in model.
     arb::time_type duration = 100;          // Simulation duration in ms.
+    arb::time_type dt = 0.01;        // Simulation time step in ms.
 
     cell_params cell;                // Cell parameters for all cells in model.
     network_params network;          // Description of the network.
@@ -70,6 +74,14 @@ struct bench_params {
     unsigned expected_events_per_interval() const {
         return expected_spikes_per_interval() * network.fan_in;
     }
+    // Total bytes of cell state streamed over simulation.
+    double expected_bytes_streamed() const {
+        return double(cell.bytes_per_step) * duration/dt * num_cells;
+    }
+    // Time to process all post-synaptic events, if only event costs are counted.
+    double expected_event_time() const {
+        return cell.event_cost_us*1e-6 * expected_events();
+    }
 };
 
 bench_params read_options(int argc, char** argv);
@@ -95,7 +107,12 @@ public:
         // different MPI ranks and threads.
         auto sched = arb::poisson_schedule(1e-3*params_.cell.spike_freq_hz, rng);
 
-        return arb::benchmark_cell("src", "tgt", sched, params_.cell.realtime_ratio);
+        arb::benchmark_cost_profile cost;
+        cost.bytes_per_step = params_.cell.bytes_per_step;
+        cost.working_set_bytes = params_.cell.working_set_bytes;
+        cost.event_cost_us = params_.cell.event_cost_us;
+
+        return arb::benchmark_cell("src", "tgt", sched, params_.cell.realtime_ratio, cost);
     }
 
     arb::cell_kind get_cell_kind(arb::cell_gid_type gid) const override {
@@ -175,10 +192,12 @@ int main(int argc, char** argv) {
 
         // Construct the model.
         arb::simulation sim(recipe, decomp, context);
+        meters.record_phases(decomp.construction_times);
+        meters.record_phases(sim.construction_times());
         meters.checkpoint("model-build", context);
 
-        // Run the simulation for 100 ms, with time steps of 0.01 ms.
-        sim.run(params.duration, 0.01);
+        // Run the simulation.
+        sim.run(params.duration, params.dt);
         meters.checkpoint("model-run", context);
 
         // write meters
@@ -209,12 +228,18 @@ std::ostream& operator<<(std::ostream& o, const bench_params& p) {
       << "  name:          " << p.name << "\n"
       << "  num cells:     " << p.num_cells << "\n"
       << "  duration:      " << p.duration << " ms\n"
+      << "  dt:            " << p.dt << " ms\n"
       << "  fan in:        " << p.network.fan_in << " connections/cell\n"
       << "  min delay:     " << p.network.min_delay << " ms\n"
       << "  spike freq:    " << p.cell.spike_freq_hz << " Hz\n"
-      << "  cell overhead: " << p.cell.realtime_ratio << " ms to advance 1 ms\n";
+      << "  cell overhead: " << p.cell.realtime_ratio << " ms to advance 1 ms\n"
+      << "  step traffic:  " << p.cell.bytes_per_step << " bytes/step over "
+                             << p.cell.working_set_bytes << " bytes working set\n"
+      << "  event cost:    " << p.cell.event_cost_us << " µs/event\n";
     o << "expected:\n"
       << "  cell advance: " << p.expected_advance_time() << " s\n"
+      << "  event cost:   " << p.expected_event_time() << " s\n"
+      << "  streamed:     " << p.expected_bytes_streamed()*1e-9 << " GB\n"
       << "  spikes:       " << p.expected_spikes() << "\n"
       << "  events:       " << p.expected_events() << "\n"
       << "  spikes:       " << p.expected_spikes_per_interval() << " per interval\n"
@@ -248,10 +273,14 @@ bench_params read_options(int argc, char** argv) {
     param_from_json(params.name, "name", json);
     param_from_json(params.num_cells, "num-cells", json);
     param_from_json(params.duration, "duration", json);
+    param_from_json(params.dt, "dt", json);
     param_from_json(params.network.min_delay, "min-delay", json);
     param_from_json(params.network.fan_in, "fan-in", json);
     param_from_json(params.cell.realtime_ratio, "realtime-ratio", json);
     param_from_json(params.cell.spike_freq_hz, "spike-frequency", json);
+    param_from_json(params.cell.bytes_per_step, "bytes-per-step", json);
+    param_from_json(params.cell.working_set_bytes, "working-set", json);
+    param_from_json(params.cell.event_cost_us, "event-cost", json);
 
     for (auto it=json.begin(); it!=json.end(); ++it) {
         std::cout << "  Warning: unused input parameter: \"" << it.key() << "\"\n";
@@ -255,8 +255,11 @@ int main(int argc, char** argv) {
         partition_hint_map hints;
         hints[cell_kind::lif].cpu_group_size = group_size;
         auto decomp = partition_load_balance(recipe, context, hints);
+        meters.checkpoint("model-decompose", context);
 
         simulation sim(recipe, decomp, context);
+        meters.record_phases(decomp.construction_times);
+        meters.record_phases(sim.construction_times());
 
         // Set up spike recording.
         std::vector<arb::spike> recorded_spikes;
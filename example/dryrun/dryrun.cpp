@@ -178,9 +178,12 @@ int main(int argc, char** argv) {
         arb::symmetric_recipe recipe(std::move(tile));
 
         auto decomp = arb::partition_load_balance(recipe, ctx);
+        meters.checkpoint("model-decompose", ctx);
 
         // Construct the model.
         arb::simulation sim(recipe, decomp, ctx);
+        meters.record_phases(decomp.construction_times);
+        meters.record_phases(sim.construction_times());
 
         // The id of the only probe on the cell: the cell_member type points to (cell 0, probe 0)
         auto probe_id = cell_member_type{0, 0};
@@ -178,9 +178,12 @@ int main(int argc, char** argv) {
         gj_recipe recipe(params);
 
         auto decomp = arb::partition_load_balance(recipe, context);
+        meters.checkpoint("model-decompose", context);
 
         // Construct the model.
         arb::simulation sim(recipe, decomp, context);
+        meters.record_phases(decomp.construction_times);
+        meters.record_phases(sim.construction_times());
 
         // Set up the probe that will measure voltage in the cell.
 
@@ -166,9 +166,12 @@ int main(int argc, char** argv) {
         ring_recipe recipe(params.num_cells, params.cell, params.min_delay);
 
         auto decomp = arb::partition_load_balance(recipe, context);
+        meters.checkpoint("model-decompose", context);
 
         // Construct the model.
         arb::simulation sim(recipe, decomp, context);
+        meters.record_phases(decomp.construction_times);
+        meters.record_phases(sim.construction_times());
 
         // Set up the probe that will measure voltage in the cell.
 
@@ -161,6 +161,27 @@ void register_cells(pybind11::module& m) {
         .def("__repr__", [](const arb::spike_source_cell&){return "<arbor.spike_source_cell>";})
         .def("__str__",  [](const arb::spike_source_cell&){return "<arbor.spike_source_cell>";});
 
+    // arb::benchmark_cost_profile
+
+    pybind11::class_<arb::benchmark_cost_profile> benchmark_cost_profile(m, "benchmark_cost_profile",
+        "Memory and event costs emulated by a benchmark cell in addition to its realtime ratio.");
+
+    benchmark_cost_profile
+        .def(pybind11::init<>(
+            [](std::size_t bytes_per_step, std::size_t working_set_bytes, double event_cost_us) {
+                return arb::benchmark_cost_profile{bytes_per_step, working_set_bytes, event_cost_us};}),
+            "bytes_per_step"_a=0, "working_set_bytes"_a=0, "event_cost_us"_a=0.,
+            "Construct a cost profile: bytes of cell state streamed each time step, the size in bytes\n"
+            "of the state over which they cycle, and the time in µs to process each event.")
+        .def_readwrite("bytes_per_step", &arb::benchmark_cost_profile::bytes_per_step,
+            "Number of bytes of cell state read and written each time step.")
+        .def_readwrite("working_set_bytes", &arb::benchmark_cost_profile::working_set_bytes,
+            "Size in bytes of the cell state over which the streamed bytes cycle.")
+        .def_readwrite("event_cost_us", &arb::benchmark_cost_profile::event_cost_us,
+            "Time taken in µs to process each post-synaptic event delivered to the cell.")
+        .def("__repr__", [](const arb::benchmark_cost_profile&){return "<arbor.benchmark_cost_profile>";})
+        .def("__str__",  [](const arb::benchmark_cost_profile&){return "<arbor.benchmark_cost_profile>";});
+
     // arb::benchmark_cell
 
     pybind11::class_<arb::benchmark_cell> benchmark_cell(m, "benchmark_cell",
@@ -172,23 +193,25 @@ void register_cells(pybind11::module& m) {
 
     benchmark_cell
         .def(pybind11::init<>(
-            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const regular_schedule_shim& sched, double ratio){
-                return arb::benchmark_cell{std::move(source_label), std::move(target_label), sched.schedule(), ratio};}),
-            "source_label"_a, "target_label"_a,"schedule"_a, "realtime_ratio"_a=1.0,
+            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const regular_schedule_shim& sched, double ratio, const arb::benchmark_cost_profile& cost){
+                return arb::benchmark_cell{std::move(source_label), std::move(target_label), sched.schedule(), ratio, cost};}),
+            "source_label"_a, "target_label"_a, "schedule"_a, "realtime_ratio"_a=1.0, "cost"_a=arb::benchmark_cost_profile{},
             "Construct a benchmark cell that generates spikes on 'source_label' at regular intervals.\n"
             "The cell has one source labeled 'source_label', and one target labeled 'target_label'.")
         .def(pybind11::init<>(
-            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const explicit_schedule_shim& sched, double ratio){
-                return arb::benchmark_cell{std::move(source_label), std::move(target_label),sched.schedule(), ratio};}),
-            "source_label"_a, "target_label"_a, "schedule"_a, "realtime_ratio"_a=1.0,
+            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const explicit_schedule_shim& sched, double ratio, const arb::benchmark_cost_profile& cost){
+                return arb::benchmark_cell{std::move(source_label), std::move(target_label),sched.schedule(), ratio, cost};}),
+            "source_label"_a, "target_label"_a, "schedule"_a, "realtime_ratio"_a=1.0, "cost"_a=arb::benchmark_cost_profile{},
             "Construct a benchmark cell that generates spikes on 'source_label' at a sequence of user-defined times.\n"
             "The cell has one source labeled 'source_label', and one target labeled 'target_label'.")
         .def(pybind11::init<>(
-            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const poisson_schedule_shim& sched, double ratio){
-                return arb::benchmark_cell{std::move(source_label), std::move(target_label), sched.schedule(), ratio};}),
-            "source_label"_a, "target_label"_a, "schedule"_a, "realtime_ratio"_a=1.0,
+            [](arb::cell_tag_type source_label, arb::cell_tag_type target_label, const poisson_schedule_shim& sched, double ratio, const arb::benchmark_cost_profile& cost){
+                return arb::benchmark_cell{std::move(source_label), std::move(target_label), sched.schedule(), ratio, cost};}),
+            "source_label"_a, "target_label"_a, "schedule"_a, "realtime_ratio"_a=1.0, "cost"_a=arb::benchmark_cost_profile{},
             "Construct a benchmark cell that generates spikeson 'source_label' at times defined by a Poisson sequence.\n"
             "The cell has one source labeled 'source_label', and one target labeled 'target_label'.")
+        .def_readwrite("cost", &arb::benchmark_cell::cost,
+            "Memory and event costs emulated in addition to the realtime ratio.")
         .def("__repr__", [](const arb::benchmark_cell&){return "<arbor.benchmark_cell>";})
         .def("__str__",  [](const arb::benchmark_cell&){return "<arbor.benchmark_cell>";});
 
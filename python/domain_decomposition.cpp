@@ -53,6 +53,16 @@ void register_domain_decomposition(pybind11::module& m) {
         .def("__str__",  &gd_string)
         .def("__repr__", &gd_string);
 
+    // Partition strategy
+    pybind11::enum_<arb::partition_strategy>(m, "partition_strategy",
+        "Enumeration of the ways in which cells are divided among domains and cell groups.")
+        .value("count", arb::partition_strategy::count,
+            "Balance the number of cells in each domain and cell group.")
+        .value("cost", arb::partition_strategy::cost,
+            "Balance the estimated cost of the cells in each domain and cell group.")
+        .value("graph", arb::partition_strategy::graph,
+            "Divide cells among domains to minimise connections between domains, balancing cost.");
+
     // Partition hint
     pybind11::class_<arb::partition_hint> partition_hint(m, "partition_hint",
         "Provide a hint on how the cell groups should be partitioned.");
@@ -71,6 +81,8 @@ void register_domain_decomposition(pybind11::module& m) {
                                         "The size of cell group assigned to GPU.")
         .def_readwrite("prefer_gpu", &arb::partition_hint::prefer_gpu,
                                         "Whether GPU usage is preferred.")
+        .def_readwrite("strategy", &arb::partition_hint::strategy,
+                                        "How the cells of the kind are divided into cell groups, by count by default.")
         .def_property_readonly_static("max_size",  [](pybind11::object) { return arb::partition_hint::max_size; },
                                         "Get the maximum size of cell groups.")
         .def("__str__",  &ph_string)
@@ -104,19 +116,23 @@ void register_domain_decomposition(pybind11::module& m) {
     // Partition load balancer
     // The Python recipe has to be shimmed for passing to the function that takes a C++ recipe.
     m.def("partition_load_balance",
-        [](std::shared_ptr<py_recipe>& recipe, const context_shim& ctx, arb::partition_hint_map hint_map) {
+        [](std::shared_ptr<py_recipe>& recipe, const context_shim& ctx, arb::partition_hint_map hint_map, arb::partition_strategy domain_strategy) {
             try {
-                return arb::partition_load_balance(py_recipe_shim(recipe), ctx.context, std::move(hint_map));
+                return arb::partition_load_balance(py_recipe_shim(recipe), ctx.context, std::move(hint_map), domain_strategy);
             }
             catch (...) {
                 py_reset_and_throw();
                 throw;
             }
         },
+        // Release the python gil, so that callbacks into the python recipe don't deadlock.
+        pybind11::call_guard<pybind11::gil_scoped_release>(),
         "Construct a domain_decomposition that distributes the cells in the model described by recipe\n"
         "over the distributed and local hardware resources described by context.\n"
-        "Optionally, provide a dictionary of partition hints for certain cell kinds, by default empty.",
-        "recipe"_a, "context"_a, "hints"_a=arb::partition_hint_map{});
+        "Optionally, provide a dictionary of partition hints for certain cell kinds, by default empty,\n"
+        "and the strategy by which cells are divided among domains, by count by default;\n"
+        "the strategy must be the same on every domain.",
+        "recipe"_a, "context"_a, "hints"_a=arb::partition_hint_map{}, "domain_strategy"_a=arb::partition_strategy::count);
 }
 
 } // namespace pyarb
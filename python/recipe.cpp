@@ -199,6 +199,9 @@ void register_recipe(pybind11::module& m) {
         .def("probes", &py_recipe::probes,
             "gid"_a,
             "The probes to allow monitoring.")
+        .def("cell_cost", &py_recipe::cell_cost,
+            "gid"_a,
+            "The relative cost of simulating gid, for load balancing; estimated from the cell if not positive, 0 by default.")
         .def("global_properties", &py_recipe::global_properties,
             "kind"_a,
             "The default properties applied to all cells of type 'kind' in the model.")
@@ -45,6 +45,9 @@ public:
     virtual std::vector<arb::probe_info> probes(arb::cell_gid_type gid) const {
         return {};
     }
+    virtual double cell_cost(arb::cell_gid_type gid) const {
+        return 0;
+    }
     virtual pybind11::object global_properties(arb::cell_kind kind) const {
         return pybind11::none();
     };
@@ -81,6 +84,10 @@ public:
         PYBIND11_OVERLOAD(std::vector<arb::probe_info>, py_recipe, probes, gid);
     }
 
+    double cell_cost(arb::cell_gid_type gid) const override {
+        PYBIND11_OVERLOAD(double, py_recipe, cell_cost, gid);
+    }
+
     pybind11::object global_properties(arb::cell_kind kind) const override {
         PYBIND11_OVERLOAD(pybind11::object, py_recipe, global_properties, kind);
     }
@@ -129,6 +136,10 @@ public:
         return try_catch_pyexception([&](){ return impl_->probes(gid); }, msg);
     }
 
+    double get_cell_cost(arb::cell_gid_type gid) const override {
+        return try_catch_pyexception([&](){ return impl_->cell_cost(gid); }, msg);
+    }
+
     std::any get_global_properties(arb::cell_kind kind) const override;
 };
 
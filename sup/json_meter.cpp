@@ -22,11 +22,21 @@ nlohmann::json to_json(const arb::profile::meter_report& report) {
         json_meters.push_back(to_json(mnt));
     }
 
+    nlohmann::json json_phases;
+    for (std::size_t i = 0; i<report.phases.size(); ++i) {
+        json_phases.push_back({
+            {"name", report.phases[i]},
+            {"units", "s"},
+            {"measurements", report.phase_times[i]}
+        });
+    }
+
     return {
         {"checkpoints", report.checkpoints},
         {"num_domains", report.num_domains},
         {"meters", json_meters},
         {"hosts", report.hosts},
+        {"phases", json_phases},
     };
 }
 
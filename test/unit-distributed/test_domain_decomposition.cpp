@@ -1,5 +1,6 @@
 #include "../gtest.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <fstream>
 #include <iostream>
@@ -138,6 +139,67 @@ namespace {
         unsigned groups_;
         cell_size_type size_;
     };
+
+    // Cable cells, where the first half of the cells cost three times as
+    // much as the second.
+    class cost_recipe: public recipe {
+    public:
+        cost_recipe(cell_size_type s): size_(s) {}
+
+        cell_size_type num_cells() const override {
+            return size_;
+        }
+
+        arb::util::unique_any get_cell_description(cell_gid_type) const override {
+            return {};
+        }
+
+        cell_kind get_cell_kind(cell_gid_type) const override {
+            return cell_kind::cable;
+        }
+
+        double get_cell_cost(cell_gid_type gid) const override {
+            return gid<size_/2? 3: 1;
+        }
+
+    private:
+        cell_size_type size_;
+    };
+
+    // Cable cells in interleaved clusters, one for each rank, where each
+    // cell has two connections from the previous cell of its cluster.
+    class cluster_recipe: public recipe {
+    public:
+        cluster_recipe(unsigned num_ranks, cell_size_type cluster_size):
+            n_cluster_(num_ranks), size_(num_ranks*cluster_size)
+        {}
+
+        cell_size_type num_cells() const override {
+            return size_;
+        }
+
+        arb::util::unique_any get_cell_description(cell_gid_type) const override {
+            return {};
+        }
+
+        cell_kind get_cell_kind(cell_gid_type) const override {
+            return cell_kind::cable;
+        }
+
+        std::vector<cell_connection> connections_on(cell_gid_type gid) const override {
+            cell_gid_type src = (gid+size_-n_cluster_)%size_;
+            return {cell_connection({src, "src"}, {"tgt"}, 1.f, 1.f),
+                    cell_connection({src, "src"}, {"tgt"}, 1.f, 1.f)};
+        }
+
+        double get_cell_cost(cell_gid_type) const override {
+            return 1;
+        }
+
+    private:
+        unsigned n_cluster_;
+        cell_size_type size_;
+    };
 }
 
 TEST(domain_decomposition, homogeneous_population_mc) {
@@ -411,3 +473,93 @@ TEST(domain_decomposition, non_symmetric_groups)
         }
     }
 }
+
+TEST(domain_decomposition, cost_domains)
+{
+    proc_allocation resources{1, -1};
+#ifdef TEST_MPI
+    auto ctx = make_context(resources, MPI_COMM_WORLD);
+#else
+    auto ctx = make_context(resources);
+#endif
+
+    const unsigned N = arb::num_ranks(ctx);
+    const unsigned I = arb::rank(ctx);
+
+    // 10 cells per domain by count; by cost, the costly cells are spread
+    // over more domains.
+    unsigned n_global = 10*N;
+    auto R = cost_recipe(n_global);
+    const auto D = partition_load_balance(R, ctx, {}, partition_strategy::cost);
+
+    double total = 0;
+    for (auto gid: util::make_span(n_global)) {
+        total += R.get_cell_cost(gid);
+    }
+
+    // Each cell goes to the domain in whose share of the total cost the
+    // midpoint of its cost lies.
+    unsigned n_local = 0;
+    double cum = 0;
+    for (auto gid: util::make_span(n_global)) {
+        double cost = R.get_cell_cost(gid);
+        int domain = std::min<int>(N-1, (cum+cost/2)*N/total);
+        cum += cost;
+
+        EXPECT_EQ(domain, D.gid_domain(gid));
+        n_local += domain==(int)I;
+    }
+
+    EXPECT_EQ((int)N, D.num_domains);
+    EXPECT_EQ(n_local, D.num_local_cells);
+    EXPECT_EQ(n_global, D.num_global_cells);
+
+    unsigned n_group_cells = 0;
+    for (const auto& g: D.groups) {
+        for (auto gid: g.gids) {
+            EXPECT_EQ((int)I, D.gid_domain(gid));
+            ++n_group_cells;
+        }
+    }
+    EXPECT_EQ(n_local, n_group_cells);
+}
+
+TEST(domain_decomposition, graph_domains)
+{
+    proc_allocation resources{1, -1};
+#ifdef TEST_MPI
+    auto ctx = make_context(resources, MPI_COMM_WORLD);
+#else
+    auto ctx = make_context(resources);
+#endif
+
+    const unsigned N = arb::num_ranks(ctx);
+    const unsigned I = arb::rank(ctx);
+
+    // By count, every domain would hold cells of every cluster; by graph
+    // partition, each domain holds one whole cluster.
+    unsigned n_local = 10;
+    unsigned n_global = n_local*N;
+    auto R = cluster_recipe(N, n_local);
+    const auto D = partition_load_balance(R, ctx, {}, partition_strategy::graph);
+
+    EXPECT_EQ(n_local, D.num_local_cells);
+    for (auto gid: util::make_span(n_global)) {
+        EXPECT_EQ(D.gid_domain(gid%N), D.gid_domain(gid));
+    }
+
+    std::vector<int> cluster_domains;
+    for (auto c: util::make_span(N)) {
+        cluster_domains.push_back(D.gid_domain(c));
+    }
+    std::sort(cluster_domains.begin(), cluster_domains.end());
+    for (auto c: util::make_span(N)) {
+        EXPECT_EQ((int)c, cluster_domains[c]);
+    }
+
+    for (const auto& g: D.groups) {
+        for (auto gid: g.gids) {
+            EXPECT_EQ((int)I, D.gid_domain(gid));
+        }
+    }
+}
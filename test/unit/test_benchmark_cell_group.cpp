@@ -0,0 +1,134 @@
+#include "../gtest.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include <arbor/benchmark_cell.hpp>
+#include <arbor/schedule.hpp>
+#include <arbor/spike_event.hpp>
+
+#include "benchmark_cell_group.hpp"
+#include "util/span.hpp"
+
+#include "../simple_recipes.hpp"
+
+using namespace arb;
+using bench_recipe = homogeneous_recipe<cell_kind::benchmark, benchmark_cell>;
+
+namespace {
+std::size_t count_streamed(const std::vector<double>& state) {
+    return std::count_if(state.begin(), state.end(), [](double x) { return x!=0; });
+}
+}
+
+TEST(benchmark_cell_group, cell_kind) {
+    bench_recipe rec(1u, benchmark_cell("src", "tgt", explicit_schedule({}), 0));
+    cell_label_range srcs, tgts;
+    benchmark_cell_group group({0}, rec, srcs, tgts);
+
+    EXPECT_EQ(cell_kind::benchmark, group.get_cell_kind());
+}
+
+TEST(benchmark_cell_group, streaming) {
+    // 10 doubles streamed per step, cycling over a working set of 250.
+    benchmark_cost_profile cost;
+    cost.bytes_per_step = 10*sizeof(double);
+    cost.working_set_bytes = 250*sizeof(double);
+
+    bench_recipe rec(2u, benchmark_cell("src", "tgt", explicit_schedule({}), 0, cost));
+    cell_label_range srcs, tgts;
+    benchmark_cell_group group({0, 1}, rec, srcs, tgts);
+
+    for (auto i: util::make_span(2)) {
+        ASSERT_EQ(250u, group.cell_state(i).size());
+        EXPECT_EQ(0u, count_streamed(group.cell_state(i)));
+    }
+
+    // Ten steps in each epoch: each stream picks up where the last left off.
+    epoch ep(0, 0., 1.);
+    group.advance(ep, 0.1, {});
+    EXPECT_EQ(100u, count_streamed(group.cell_state(0)));
+    EXPECT_EQ(100u, count_streamed(group.cell_state(1)));
+
+    ep.advance_to(2.);
+    group.advance(ep, 0.1, {});
+    EXPECT_EQ(200u, count_streamed(group.cell_state(0)));
+
+    // The stream wraps around the working set.
+    ep.advance_to(3.);
+    group.advance(ep, 0.1, {});
+    EXPECT_EQ(250u, count_streamed(group.cell_state(0)));
+
+    group.reset();
+    EXPECT_EQ(0u, count_streamed(group.cell_state(0)));
+
+    // Without a working set, the state is the size of one step.
+    cost.working_set_bytes = 0;
+    bench_recipe small(1u, benchmark_cell("src", "tgt", explicit_schedule({}), 0, cost));
+    benchmark_cell_group small_group({0}, small, srcs, tgts);
+    EXPECT_EQ(10u, small_group.cell_state(0).size());
+}
+
+TEST(benchmark_cell_group, working_set) {
+    using duration_ms = std::chrono::duration<double, std::milli>;
+
+    // 32 MB streamed per step, over a working set of the same size or of
+    // 4 kB, which is reused within the step and stays in cache.
+    benchmark_cost_profile cost;
+    cost.bytes_per_step = std::size_t(1)<<25;
+
+    auto time_advance = [&](std::size_t working_set_bytes) {
+        cost.working_set_bytes = working_set_bytes;
+        bench_recipe rec(1u, benchmark_cell("src", "tgt", explicit_schedule({}), 0, cost));
+        cell_label_range srcs, tgts;
+        benchmark_cell_group group({0}, rec, srcs, tgts);
+        EXPECT_EQ((working_set_bytes? working_set_bytes: cost.bytes_per_step)/sizeof(double), group.cell_state(0).size());
+
+        // Best of three, each of ten steps.
+        double best = 0;
+        for (auto k: util::make_span(3)) {
+            epoch ep(0, 0., 1.);
+            auto start = std::chrono::high_resolution_clock::now();
+            group.advance(ep, 0.1, {});
+            double t = duration_ms(std::chrono::high_resolution_clock::now()-start).count();
+            best = k? std::min(best, t): t;
+        }
+        return best;
+    };
+
+    EXPECT_LT(time_advance(4096), time_advance(0));
+
+    // A working set smaller than a cache line is one cache line.
+    cost.working_set_bytes = 8;
+    bench_recipe rec(1u, benchmark_cell("src", "tgt", explicit_schedule({}), 0, cost));
+    cell_label_range srcs, tgts;
+    benchmark_cell_group group({0}, rec, srcs, tgts);
+    EXPECT_EQ(64u/sizeof(double), group.cell_state(0).size());
+}
+
+TEST(benchmark_cell_group, event_cost) {
+    using duration_ms = std::chrono::duration<double, std::milli>;
+
+    // Only events cost time: 0.2 ms each.
+    benchmark_cost_profile cost;
+    cost.event_cost_us = 200;
+
+    bench_recipe rec(1u, benchmark_cell("src", "tgt", explicit_schedule({}), 0, cost));
+    cell_label_range srcs, tgts;
+    benchmark_cell_group group({0}, rec, srcs, tgts);
+
+    auto time_advance = [&](unsigned n_events) {
+        std::vector<pse_vector> lanes(1);
+        for (auto k: util::make_span(n_events)) lanes[0].push_back({0, 0.01*k, 1.f});
+
+        group.reset();
+        epoch ep(0, 0., 1.);
+        auto start = std::chrono::high_resolution_clock::now();
+        group.advance(ep, 0.1, util::subrange_view(lanes, 0, 1));
+        return duration_ms(std::chrono::high_resolution_clock::now()-start).count();
+    };
+
+    EXPECT_GE(time_advance(10), 2.);
+    EXPECT_GE(time_advance(20), 4.);
+}
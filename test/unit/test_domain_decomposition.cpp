@@ -1,5 +1,7 @@
 #include "../gtest.h"
 
+#include <algorithm>
+#include <numeric>
 #include <stdexcept>
 
 #include <arbor/context.hpp>
@@ -8,6 +10,7 @@
 
 #include <arborenv/gpu_env.hpp>
 
+#include "domain_balance.hpp"
 #include "util/span.hpp"
 
 #include "../common_cells.hpp"
@@ -58,6 +61,27 @@ namespace {
         cell_size_type size_;
     };
 
+    // Spike source cells, of which the first four are ten times as costly
+    // as the rest.
+    class cost_recipe: public recipe {
+    public:
+        cell_size_type num_cells() const override {
+            return 12;
+        }
+
+        util::unique_any get_cell_description(cell_gid_type) const override {
+            return {};
+        }
+
+        cell_kind get_cell_kind(cell_gid_type) const override {
+            return cell_kind::spike_source;
+        }
+
+        double get_cell_cost(cell_gid_type gid) const override {
+            return gid<4? 10: 1;
+        }
+    };
+
     class gap_recipe: public recipe {
     public:
         gap_recipe() {}
@@ -118,6 +142,16 @@ namespace {
     private:
         cell_size_type size_ = 15;
     };
+
+    // Whether cells a and b are in the same cell group of d.
+    bool in_same_group(const domain_decomposition& d, cell_gid_type a, cell_gid_type b) {
+        for (auto& g: d.groups) {
+            bool has_a = std::count(g.gids.begin(), g.gids.end(), a);
+            bool has_b = std::count(g.gids.begin(), g.gids.end(), b);
+            if (has_a || has_b) return has_a && has_b;
+        }
+        return false;
+    }
 }
 
 // test assumes one domain
@@ -361,3 +395,173 @@ TEST(domain_decomposition, compulsory_groups)
     EXPECT_EQ(expected_groups2, D2.groups[0].gids);
 
 }
+
+TEST(domain_decomposition, cost_hints) {
+    auto ctx = make_context();
+
+    // By count, the twelve cells are split into four groups of three; by
+    // cost, into four groups with the total cost of 48 shared near equally.
+    partition_hint_map hints;
+    hints[cell_kind::spike_source].cpu_group_size = 3;
+    hints[cell_kind::spike_source].strategy = partition_strategy::cost;
+
+    const auto D0 = partition_load_balance(cost_recipe(), ctx, hints);
+    EXPECT_EQ(12u, D0.num_local_cells);
+
+    std::vector<std::vector<cell_gid_type>> expected_groups0 =
+        {{0}, {1}, {2, 3}, {4, 5, 6, 7, 8, 9, 10, 11}};
+
+    ASSERT_EQ(expected_groups0.size(), D0.groups.size());
+    for (unsigned i = 0; i < expected_groups0.size(); i++) {
+        EXPECT_EQ(expected_groups0[i], D0.groups[i].gids);
+    }
+
+    // Estimated costs of cable cells: super cells stay together, and every
+    // cell is assigned to a group.
+    hints.clear();
+    hints[cell_kind::cable].cpu_group_size = 3;
+    hints[cell_kind::cable].prefer_gpu = false;
+    hints[cell_kind::cable].strategy = partition_strategy::cost;
+
+    const auto D1 = partition_load_balance(gap_recipe(), ctx, hints);
+    std::vector<cell_gid_type> gids, expected_gids;
+    for (auto& g: D1.groups) {
+        gids.insert(gids.end(), g.gids.begin(), g.gids.end());
+    }
+    std::sort(gids.begin(), gids.end());
+    for (auto gid: make_span(15u)) {
+        expected_gids.push_back(gid);
+    }
+    EXPECT_EQ(expected_gids, gids);
+
+    EXPECT_TRUE(in_same_group(D1, 0, 13));
+    EXPECT_TRUE(in_same_group(D1, 2, 11));
+    EXPECT_TRUE(in_same_group(D1, 3, 9));
+}
+
+TEST(domain_decomposition, cost_divisions) {
+    // Twelve cells of total cost 32 are held by four domains in the equal
+    // count division, and divided among them again with a cost near 8 each:
+    // a cell goes to the domain in whose share the midpoint of its cost lies.
+    std::vector<double> costs = {8, 8, 1, 1, 1, 1, 1, 1, 1, 1, 4, 4};
+    std::vector<cell_gid_type> held = {0, 3, 6, 9, 12};
+
+    // Divisions found by each domain in turn, as gathered from all domains.
+    auto divide = [&]() {
+        auto local = [&](unsigned d) {
+            return std::vector<double>(costs.begin()+held[d], costs.begin()+held[d+1]);
+        };
+
+        std::vector<double> totals;
+        for (auto d: make_span(held.size()-1)) {
+            auto c = local(d);
+            totals.push_back(std::accumulate(c.begin(), c.end(), 0.));
+        }
+
+        std::vector<cell_gid_type> divisions;
+        for (auto d: make_span(held.size()-1)) {
+            auto local_divisions = local_cost_divisions(totals, d, local(d), held[d]);
+            divisions.insert(divisions.end(), local_divisions.begin(), local_divisions.end());
+        }
+        return divisions;
+    };
+
+    EXPECT_EQ((std::vector<cell_gid_type>{1, 2, 10}), divide());
+
+    // The shares of domains 1 and 2 start in the costs held by domain 0,
+    // and that of domain 3 in those of domain 3; a domain holding no cells
+    // finds no division.
+    held = {0, 5, 9, 9, 12};
+    EXPECT_EQ((std::vector<cell_gid_type>{1, 2, 10}), divide());
+
+    // A share starting at the end of the costs held by one domain is found
+    // by the next.
+    costs = {0, 0, 4, 0, 4, 0};
+    held = {0, 3, 6};
+    EXPECT_EQ((std::vector<cell_gid_type>{3}), divide());
+}
+
+TEST(domain_decomposition, graph_hints) {
+    auto ctx = make_context();
+
+    // With one domain, the graph partition keeps every cell local, and a
+    // hint selecting the graph strategy groups cells as by cost.
+    partition_hint_map hints;
+    hints[cell_kind::cable].cpu_group_size = 3;
+    hints[cell_kind::cable].prefer_gpu = false;
+    hints[cell_kind::cable].strategy = partition_strategy::cost;
+    const auto D0 = partition_load_balance(gap_recipe(), ctx, hints);
+
+    hints[cell_kind::cable].strategy = partition_strategy::graph;
+    const auto D1 = partition_load_balance(gap_recipe(), ctx, hints, partition_strategy::graph);
+
+    EXPECT_EQ(15u, D1.num_local_cells);
+    for (auto gid: make_span(15u)) {
+        EXPECT_EQ(0, D1.gid_domain(gid));
+    }
+
+    ASSERT_EQ(D0.groups.size(), D1.groups.size());
+    for (auto i: make_span(D0.groups.size())) {
+        EXPECT_EQ(D0.groups[i].gids, D1.groups[i].gids);
+    }
+}
+
+TEST(domain_decomposition, graph_division) {
+    // Sixteen cells in two interleaved clusters of even and odd gids, where
+    // each cell has two connections from the previous cell of its cluster.
+    // Cells 9 and 15 are connected by a gap junction within the second of
+    // two domains holding [0, 8) and [8, 16); cells 2 and 10 by one between
+    // the domains.
+    const cell_gid_type n = 16;
+    std::vector<cell_gid_type> held = {0, 8, 16};
+    std::vector<std::pair<cell_gid_type, cell_gid_type>> gap_junctions = {{9, 15}, {2, 10}};
+
+    std::vector<local_cell_graph> local;
+    for (auto d: make_span(2)) {
+        std::vector<std::vector<cell_gid_type>> sources, peers;
+        for (auto gid: make_span(held[d], held[d+1])) {
+            cell_gid_type src = (gid+n-2)%n;
+            sources.push_back({src, src});
+            peers.emplace_back();
+            for (auto [a, b]: gap_junctions) {
+                if (gid==a) peers.back().push_back(b);
+                if (gid==b) peers.back().push_back(a);
+            }
+        }
+        local.push_back(make_local_cell_graph(held[d], sources, peers));
+    }
+
+    // Gap junctions within a domain are contracted, and those between
+    // domains kept; repeated connections are merged into one edge.
+    EXPECT_EQ(9u, local[1].roots[15-8]);
+    EXPECT_EQ(11u, local[1].roots[11-8]);
+    EXPECT_EQ((std::vector<cell_gid_type>{10}), local[0].peer);
+    EXPECT_EQ((std::vector<cell_gid_type>{2}), local[0].cell);
+    EXPECT_EQ((std::vector<cell_gid_type>{2}), local[1].peer);
+    EXPECT_EQ((std::vector<cell_gid_type>{10}), local[1].cell);
+    EXPECT_EQ(8u, local[0].source.size());
+    EXPECT_EQ(8u, local[1].source.size());
+    for (auto& g: local) {
+        for (auto w: g.weight) EXPECT_EQ(2u, w);
+    }
+    EXPECT_EQ(9u, local[1].num_edges());
+
+    // The gathered graph is divided between two domains by cluster.
+    local_cell_graph gathered;
+    for (auto& g: local) {
+        auto append = [](auto& to, const auto& from) { to.insert(to.end(), from.begin(), from.end()); };
+        append(gathered.roots, g.roots);
+        append(gathered.source, g.source);
+        append(gathered.target, g.target);
+        append(gathered.weight, g.weight);
+        append(gathered.peer, g.peer);
+        append(gathered.cell, g.cell);
+    }
+
+    auto domains = partition_cell_graph(std::vector<cell_gid_type>(n, 1), gathered, 2);
+    ASSERT_EQ(n, domains.size());
+    EXPECT_NE(domains[0], domains[1]);
+    for (auto gid: make_span(n)) {
+        EXPECT_EQ(domains[gid%2], domains[gid]);
+    }
+}
@@ -54,6 +54,15 @@ TEST(dry_run_context, sum)
     EXPECT_EQ(42.f * num_ranks, ctx->sum(42.f));
     EXPECT_EQ(int(42 * num_ranks), ctx->sum(42));
     EXPECT_EQ(unsigned(42 * num_ranks), ctx->sum(42u));
+    EXPECT_EQ((std::vector<double>{1. * num_ranks, 42. * num_ranks}), ctx->sum(std::vector<double>{1., 42.}));
+}
+
+TEST(dry_run_context, gather_all)
+{
+    distributed_context_handle ctx = arb::make_dry_run_context(num_ranks, num_cells_per_rank);
+
+    EXPECT_EQ(std::vector<double>(num_ranks, 42.), ctx->gather_all(42.));
+    EXPECT_EQ(std::vector<int>(num_ranks, 42), ctx->gather_all(42));
 }
 
 TEST(dry_run_context, gather_spikes)
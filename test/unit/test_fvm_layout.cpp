@@ -181,6 +181,103 @@ TEST(fvm_layout, mech_index) {
     EXPECT_EQ(ivec({0,6}), M.ions.at("k"s).cv);
 }
 
+TEST(fvm_layout, cell_templates) {
+    auto system = two_cell_system();
+    auto& descriptions = system.descriptions;
+    auto& builders = system.builders;
+
+    descriptions[0].decorations.place(builders[0].location({1, 0.4}), "expsyn", "syn0");
+    descriptions[1].decorations.place(builders[1].location({2, 0.4}), "exp2syn", "syn1");
+    descriptions[1].decorations.place(builders[1].location({3, 0.4}), "expsyn", "syn2");
+
+    // Cells 2 and 3 repeat cells 0 and 1; cell 4 differs from cell 0 only in
+    // a parameter value.
+    auto desc4 = descriptions[0];
+    desc4.decorations.paint("dend"_lab, membrane_capacitance{0.02});
+    descriptions = {descriptions[0], descriptions[1], descriptions[0], descriptions[1], desc4};
+
+    cable_cell_global_properties gprop;
+    gprop.default_parameters = neuron_parameter_defaults;
+
+    auto cells = system.cells();
+    fvm_cv_discretization D = fvm_cv_discretize(cells, gprop.default_parameters);
+    EXPECT_EQ((std::vector<fvm_size_type>{0, 1, 0, 1, 4}), D.cell_template);
+
+    // Cells discretized one at a time are not compared.
+    fvm_cv_discretization E;
+    for (const auto& c: cells) append(E, fvm_cv_discretize(c, gprop.default_parameters));
+    EXPECT_TRUE(E.cell_template.empty());
+
+    EXPECT_EQ(E.geometry.cv_parent, D.geometry.cv_parent);
+    EXPECT_EQ(E.geometry.cv_to_cell, D.geometry.cv_to_cell);
+    EXPECT_EQ(E.geometry.cell_cv_divs, D.geometry.cell_cv_divs);
+    EXPECT_EQ(E.cv_area, D.cv_area);
+    EXPECT_EQ(E.cv_capacitance, D.cv_capacitance);
+    EXPECT_EQ(E.face_conductance, D.face_conductance);
+
+    fvm_mechanism_data M = fvm_build_mechanism_data(gprop, cells, D);
+    fvm_mechanism_data N = fvm_build_mechanism_data(gprop, cells, E);
+
+    EXPECT_EQ(N.n_target, M.n_target);
+    EXPECT_EQ(N.target_divs, M.target_divs);
+    ASSERT_EQ(N.mechanisms.size(), M.mechanisms.size());
+    for (const auto& [name, config]: N.mechanisms) {
+        SCOPED_TRACE(name);
+        const auto& other = M.mechanisms.at(name);
+        EXPECT_EQ(config.cv, other.cv);
+        EXPECT_EQ(config.multiplicity, other.multiplicity);
+        EXPECT_EQ(config.norm_area, other.norm_area);
+        EXPECT_EQ(config.target, other.target);
+        EXPECT_EQ(config.param_values, other.param_values);
+    }
+    ASSERT_EQ(N.ions.size(), M.ions.size());
+    for (const auto& [name, config]: N.ions) {
+        SCOPED_TRACE(name);
+        EXPECT_EQ(config.cv, M.ions.at(name).cv);
+        EXPECT_EQ(config.init_iconc, M.ions.at(name).init_iconc);
+    }
+    EXPECT_EQ(N.stimuli.cv, M.stimuli.cv);
+    EXPECT_EQ(N.stimuli.cv_unique, M.stimuli.cv_unique);
+    EXPECT_EQ(N.stimuli.envelope_amplitude, M.stimuli.envelope_amplitude);
+}
+
+namespace {
+// Fixed per branch policy counting its evaluations.
+struct counting_cv_policy: cv_policy_base {
+    std::shared_ptr<unsigned> count = std::make_shared<unsigned>(0);
+
+    locset cv_boundary_points(const cable_cell& cell) const override {
+        ++*count;
+        return cv_policy_fixed_per_branch(2).cv_boundary_points(cell);
+    }
+    region domain() const override { return reg::all(); }
+    cv_policy_base_ptr clone() const override { return cv_policy_base_ptr(new counting_cv_policy(*this)); }
+    std::ostream& print(std::ostream& os) override { return os << "(counting)"; }
+};
+}
+
+TEST(fvm_layout, cell_templates_cv_policy) {
+    auto system = two_cell_system();
+    auto& descriptions = system.descriptions;
+    descriptions = {descriptions[0], descriptions[1], descriptions[0], descriptions[1], descriptions[0]};
+
+    counting_cv_policy policy;
+    for (auto& d: descriptions) d.decorations.set_default(cv_policy(policy));
+
+    // The policy is evaluated once for the cells on copies of each morphology.
+    auto cells = system.cells();
+    const auto& dflt = neuron_parameter_defaults;
+    fvm_cv_discretization D = fvm_cv_discretize(cells, dflt);
+    EXPECT_EQ((std::vector<fvm_size_type>{0, 1, 0, 1, 0}), D.cell_template);
+    EXPECT_EQ(2u, *policy.count);
+
+    fvm_cv_discretization E;
+    for (const auto& c: cells) append(E, fvm_cv_discretize(c, dflt));
+    EXPECT_EQ(2u, *policy.count);
+    EXPECT_EQ(E.geometry.cv_parent, D.geometry.cv_parent);
+    EXPECT_EQ(E.geometry.cell_cv_divs, D.geometry.cell_cv_divs);
+}
+
 struct exp_instance {
     int cv;
     int multiplicity;
@@ -447,6 +447,55 @@ TEST(fvm_lowered, ac_stimulus) {
     }
 }
 
+TEST(fvm_lowered, ac_stimulus_incremental) {
+    // Simple cell (one CV) with oscillating stimulus sampled at regular
+    // and irregular intervals over many periods.
+
+    arb::execution_context context;
+
+    decor dec;
+    segment_tree tree;
+    tree.append(mnpos, {0., 0., 0., 1.}, {100., 0., 0., 1.}, 1);
+
+    const double freq = 0.35;  // (kHz)
+    const double phase = 0.7;  // (radian)
+    const double amplitude = 2; // (nA)
+    const double t_on = 1.3;    // (ms)
+    const double t_off = 180.;  // (ms)
+
+    dec.place(mlocation{0, 0}, i_clamp::box(t_on, t_off-t_on, amplitude, freq, phase), "clamp");
+    std::vector<cable_cell> cells = {cable_cell(tree, {}, dec)};
+
+    cable_cell_global_properties gprop;
+    gprop.default_parameters = neuron_parameter_defaults;
+
+    fvm_cv_discretization D = fvm_cv_discretize(cells, gprop.default_parameters, context);
+    const auto& A = D.cv_area;
+
+    fvm_cell fvcell(context);
+    fvcell.initialize({0}, cable1d_recipe(cells));
+
+    auto& state = *(fvcell.*private_state_ptr).get();
+    auto& J = state.current_density;
+    auto& T = state.time;
+
+    constexpr double unit_factor = 1e-3; // scale A/m²·µm² to nA
+    const double abstol = 1e-10*amplitude;
+
+    double t = 0;
+    for (unsigned i = 0; t<200; ++i) {
+        memory::fill(J, 0.);
+        memory::fill(T, t);
+        state.add_stimulus_current();
+
+        double expected_I = t>=t_on && t<t_off? amplitude*std::sin(2*math::pi<double>*t*freq+phase): 0;
+        EXPECT_NEAR(-expected_I, J[0]*A[0]*unit_factor, abstol);
+
+        // Mostly regular steps, with occasional shorter and longer steps.
+        t += i%97==0? 0.013: i%89==0? 0.6: 0.025;
+    }
+}
+
 // Test derived mechanism behaviour.
 
 TEST(fvm_lowered, derived_mechs) {
@@ -738,6 +787,64 @@ TEST(fvm_lowered, ionic_currents) {
     EXPECT_NEAR(expected_Xi, ion.Xi_[0], 1e-6);
 }
 
+// Test that reversal potentials depending only on constant concentrations are
+// computed on reset, while those depending on written concentrations are
+// updated as the concentrations change.
+
+TEST(fvm_lowered, revpot_update) {
+    arb::proc_allocation resources;
+    if (auto nt = arbenv::get_env_num_threads()) {
+        resources.num_threads = nt;
+    }
+    else {
+        resources.num_threads = arbenv::thread_concurrency();
+    }
+    arb::execution_context context(resources);
+
+    soma_cell_builder b(6);
+
+    // Inward calcium current raises cai linearly from zero; nothing
+    // writes sodium concentrations.
+
+    mechanism_desc m1("fixed_ica_current");
+    m1["current_density"] = -1.5;
+
+    mechanism_desc m2("linear_ca_conc");
+    m2["coeff"] = 0.5;
+
+    auto c = b.make_cell();
+    c.decorations.paint("soma"_lab, m1);
+    c.decorations.paint("soma"_lab, m2);
+    c.decorations.paint("soma"_lab, "hh");
+
+    cable1d_recipe rec({cable_cell{c}});
+    rec.catalogue() = make_unit_test_catalogue(global_default_catalogue());
+    rec.nernst_ion("na");
+    rec.nernst_ion("ca");
+
+    fvm_cell fvcell(context);
+    fvcell.initialize({0}, rec);
+
+    auto& state = *(fvcell.*private_state_ptr).get();
+    auto& na = state.ion_data.at("na"s);
+    auto& ca = state.ion_data.at("ca"s);
+
+    // Sodium reversal potential given by Nernst equation immediately after reset.
+    double na_ex = na.eX_[0];
+    EXPECT_NE(na.init_eX_[0], na_ex);
+    EXPECT_GT(na_ex, 0.);
+
+    (void)fvcell.integrate(1, 0.1, {}, {});
+    double ca_ex = ca.eX_[0];
+    EXPECT_EQ(na_ex, na.eX_[0]);
+    EXPECT_TRUE(std::isfinite(ca_ex));
+
+    // Calcium reversal potential decreases as cai increases.
+    (void)fvcell.integrate(2, 0.1, {}, {});
+    EXPECT_EQ(na_ex, na.eX_[0]);
+    EXPECT_LT(ca.eX_[0], ca_ex);
+}
+
 // Test correct scaling of an ionic current updated via a point mechanism
 
 TEST(fvm_lowered, point_ionic_current) {
@@ -1544,4 +1651,110 @@ TEST(fvm_lowered, label_data) {
         }
         EXPECT_EQ(actual_labeled_ranges, expected_labeled_ranges);
     }
-}
\ No newline at end of file
+}
+
+TEST(fvm_lowered, take_samples) {
+    // Two integration domains with four CVs each. Sample events mix runs of
+    // consecutive handles and offsets with isolated and null handles, and
+    // with linear probes evaluated by the back-end.
+
+    using value_type = arb::fvm_value_type;
+    using index_type = arb::fvm_index_type;
+
+    const unsigned n_cv = 8;
+    std::vector<index_type> cv_to_intdom = {0, 0, 0, 0, 1, 1, 1, 1};
+    std::vector<value_type> v_init(n_cv);
+    std::iota(v_init.begin(), v_init.end(), 10.);
+
+    shared_state state(2, 2, 0,
+        cv_to_intdom, cv_to_intdom, {},
+        v_init,
+        std::vector<value_type>(n_cv, 300.),
+        std::vector<value_type>(n_cv, 1.),
+        std::vector<index_type>(0),
+        1);
+
+    state.reset();
+    state.time[1] = 0.5;
+    arb::util::fill(state.time_to, 1.);
+
+    const value_type* v = state.voltage.data();
+    state.configure_linear_probes({{v+0, 2.}, {v+5, 0.5}, {v+7, -1.}}, {0, 2, 3});
+
+    std::vector<arb::sample_event> events = {
+        {0.1, 0, {v+0, 0}}, {0.1, 0, {v+1, 1}}, {0.1, 0, {v+2, 2}}, {0.1, 0, {v+3, 3}},
+        {0.1, 0, {nullptr, 4}}, {0.1, 0, {nullptr, 13, 0}},
+        {0.2, 0, {v+1, 5}}, {0.2, 0, {v+2, 7}}, {0.2, 0, {v+3, 8}},
+        {0.2, 0, {v+0, 6}},
+        {0.6, 1, {v+4, 9}}, {0.6, 1, {v+5, 10}},
+        {0.6, 1, {v+7, 11}}, {0.6, 1, {nullptr, 14, 1}},
+        {2.0, 1, {v+6, 12}}
+    };
+
+    arb::multicore::sample_event_stream stream(2);
+    stream.init(events);
+    stream.mark_until(state.time_to);
+
+    const unsigned n_sample = 15;
+    backend::array sample_time(n_sample, -1.), sample_value(n_sample, -1.);
+    state.take_samples(stream.marked_events(), sample_time, sample_value);
+
+    std::vector<value_type> expected_value = {10, 11, 12, 13, 0, 11, 10, 12, 13, 14, 15, 17, -1, 27.5, -17};
+    std::vector<value_type> expected_time = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0.5, 0.5, 0.5, -1, 0, 0.5};
+
+    EXPECT_EQ(expected_value, std::vector<value_type>(sample_value.begin(), sample_value.end()));
+    EXPECT_EQ(expected_time, std::vector<value_type>(sample_time.begin(), sample_time.end()));
+}
+
+TEST(fvm_lowered, reduced_samples) {
+    // Samples for reduced samplers are combined by the back-end at one offset
+    // per reduction window, rather than stored for each sample time.
+
+    soma_cell_builder builder(12.6157/2.0);
+    builder.add_branch(0, 200, 1.0/2, 1.0/2, 4, "dend");
+    auto cell = builder.make_cell();
+    cell.decorations.paint("soma"_lab, "hh");
+    cell.decorations.place(builder.location({1, 1}), i_clamp::box(5, 80, 0.3), "clamp");
+
+    // Sample the soma voltage at six times, with the given offset, store
+    // and first flag for each.
+    using arb::sample_store;
+    struct sample_spec {
+        sample_size_type offset;
+        sample_store store;
+        bool first;
+    };
+
+    auto sample = [&](const std::vector<sample_spec>& specs) {
+        arb::execution_context context;
+        fvm_cell fvcell(context);
+        fvcell.initialize({0}, cable1d_recipe(cable_cell(cell)));
+        const fvm_value_type* v = (fvcell.*private_state_ptr)->voltage.data();
+
+        std::vector<sample_event> events;
+        for (unsigned j = 0; j<specs.size(); ++j) {
+            events.push_back({5.+0.5*j, 0, {v, specs[j].offset, -1, specs[j].store, specs[j].first}});
+        }
+
+        auto result = fvcell.integrate(10, 0.025, {}, std::move(events));
+        return std::make_pair(
+            std::vector<fvm_value_type>(result.sample_time.begin(), result.sample_time.end()),
+            std::vector<fvm_value_type>(result.sample_value.begin(), result.sample_value.end()));
+    };
+
+    std::vector<sample_spec> copies;
+    for (unsigned j = 0; j<6; ++j) copies.push_back({sample_size_type(j), sample_store::copy, true});
+    auto [time, value] = sample(copies);
+    ASSERT_EQ(6u, value.size());
+
+    // A window of four samples reduced to their sum, then a window of two
+    // reduced to their maximum.
+    auto [rtime, rvalue] = sample({
+        {0, sample_store::sum, true}, {0, sample_store::sum, false}, {0, sample_store::sum, false}, {0, sample_store::sum, false},
+        {1, sample_store::max, true}, {1, sample_store::max, false}});
+    ASSERT_EQ(2u, rvalue.size());
+    EXPECT_EQ(time[3], rtime[0]);
+    EXPECT_EQ(time[5], rtime[1]);
+    EXPECT_DOUBLE_EQ(value[0]+value[1]+value[2]+value[3], rvalue[0]);
+    EXPECT_EQ(std::max(value[4], value[5]), rvalue[1]);
+}
@@ -0,0 +1,55 @@
+#include "../gtest.h"
+
+#include <stdexcept>
+#include <vector>
+
+#include "gid_domain_map.hpp"
+#include "util/span.hpp"
+
+using namespace arb;
+using util::make_span;
+
+TEST(gid_domain_map, runs) {
+    EXPECT_EQ((std::vector<cell_gid_type>{}), gid_runs({}));
+    EXPECT_EQ((std::vector<cell_gid_type>{3, 4}), gid_runs({3}));
+    EXPECT_EQ((std::vector<cell_gid_type>{0, 3, 5, 6, 7, 9}), gid_runs({0, 1, 2, 5, 7, 8}));
+}
+
+TEST(gid_domain_map, blocks) {
+    // 10 cells over 4 domains, of sizes 3, 3, 2, 2, given in any order.
+    gid_domain_map m({{6, 8, 2}, {0, 2, 0}, {2, 3, 0}, {8, 10, 3}, {3, 6, 1}}, 10, 4);
+    EXPECT_EQ(0u, m.num_runs());
+
+    std::vector<int> expected = {0, 0, 0, 1, 1, 1, 2, 2, 3, 3};
+    for (auto gid: make_span(10u)) {
+        EXPECT_EQ(expected[gid], m(gid));
+    }
+    EXPECT_THROW(m(10), std::out_of_range);
+
+    // Fewer cells than domains: the last domains are empty.
+    gid_domain_map small({{0, 1, 0}, {1, 2, 1}}, 2, 3);
+    EXPECT_EQ(0, small(0));
+    EXPECT_EQ(1, small(1));
+    EXPECT_THROW(small(2), std::out_of_range);
+}
+
+TEST(gid_domain_map, ranges) {
+    // Contiguous ranges of other sizes: one run per domain.
+    gid_domain_map m({{0, 5, 0}, {5, 6, 1}, {6, 10, 2}}, 10, 3);
+    EXPECT_EQ(3u, m.num_runs());
+
+    std::vector<int> expected = {0, 0, 0, 0, 0, 1, 2, 2, 2, 2};
+    for (auto gid: make_span(10u)) {
+        EXPECT_EQ(expected[gid], m(gid));
+    }
+
+    // Irregular division, with gaps.
+    gid_domain_map irregular({{0, 2, 1}, {2, 3, 0}, {4, 6, 1}, {6, 7, 0}}, 8, 2);
+    EXPECT_EQ(4u, irregular.num_runs());
+    EXPECT_EQ(1, irregular(1));
+    EXPECT_EQ(0, irregular(2));
+    EXPECT_THROW(irregular(3), std::out_of_range);
+    EXPECT_EQ(1, irregular(5));
+    EXPECT_EQ(0, irregular(6));
+    EXPECT_THROW(irregular(7), std::out_of_range);
+}
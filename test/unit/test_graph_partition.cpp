@@ -0,0 +1,137 @@
+#include "../gtest.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "graph_partition.hpp"
+#include "util/span.hpp"
+
+using namespace arb;
+using util::make_span;
+
+namespace {
+// Clusters of densely connected vertices, each connected to the next
+// cluster in a ring by a single edge.
+weighted_graph clustered_graph(unsigned n_cluster, unsigned cluster_size) {
+    std::vector<unsigned> a, b;
+    for (auto c: make_span(n_cluster)) {
+        unsigned first = c*cluster_size;
+        for (auto i: make_span(cluster_size)) {
+            for (auto j: make_span(i)) {
+                if (j+1==i || (i*j)%7==0) {
+                    a.push_back(first+i);
+                    b.push_back(first+j);
+                }
+            }
+        }
+        a.push_back(first);
+        b.push_back(((c+1)%n_cluster)*cluster_size+1);
+    }
+
+    // Interleave the clusters, so that vertex order does not reveal them.
+    unsigned n = n_cluster*cluster_size;
+    auto shuffle = [&](unsigned v) { return (v%cluster_size)*n_cluster + v/cluster_size; };
+    for (auto& v: a) v = shuffle(v);
+    for (auto& v: b) v = shuffle(v);
+
+    return weighted_graph(std::vector<weighted_graph::weight_type>(n, 1), a, b);
+}
+}
+
+TEST(graph_partition, weighted_graph) {
+    // Repeated edges are merged in either direction; self loops are ignored.
+    weighted_graph g({1, 2, 3, 4}, {0, 1, 0, 2, 3}, {1, 0, 2, 2, 0});
+
+    EXPECT_EQ(4u, g.size());
+    EXPECT_EQ(10, g.total_weight());
+    EXPECT_EQ((std::vector<unsigned>{0, 3, 4, 5, 6}), g.offsets);
+
+    auto neighbours = [&](unsigned v) {
+        std::vector<std::pair<unsigned, weighted_graph::weight_type>> n;
+        for (auto e: make_span(g.offsets[v], g.offsets[v+1])) {
+            n.emplace_back(g.adjacency[e], g.edge_weights[e]);
+        }
+        std::sort(n.begin(), n.end());
+        return n;
+    };
+
+    using nbrs = std::vector<std::pair<unsigned, weighted_graph::weight_type>>;
+    EXPECT_EQ((nbrs{{1, 2}, {2, 1}, {3, 1}}), neighbours(0));
+    EXPECT_EQ((nbrs{{0, 2}}), neighbours(1));
+    EXPECT_EQ((nbrs{{0, 1}}), neighbours(2));
+    EXPECT_EQ((nbrs{{0, 1}}), neighbours(3));
+
+    EXPECT_EQ(0, edge_cut(g, {0, 0, 0, 0}));
+    EXPECT_EQ(3, edge_cut(g, {0, 1, 0, 1}));
+}
+
+TEST(graph_partition, weighted_edges) {
+    // The weights of repeated edges are summed.
+    weighted_graph g({1, 1, 1}, {0, 1, 2, 1}, {1, 0, 1, 1}, {2, 3, 4, 5});
+
+    EXPECT_EQ((std::vector<unsigned>{0, 1, 3, 4}), g.offsets);
+    EXPECT_EQ((std::vector<unsigned>{1, 0, 2, 1}), g.adjacency);
+    EXPECT_EQ((std::vector<weighted_graph::weight_type>{5, 5, 4, 4}), g.edge_weights);
+    EXPECT_EQ(9, edge_cut(g, {0, 1, 0}));
+}
+
+TEST(graph_partition, trivial) {
+    auto g = clustered_graph(3, 4);
+
+    EXPECT_EQ(std::vector<unsigned>(12, 0), partition_graph(g, 1));
+
+    // With no more vertices than parts, each vertex has its own part.
+    weighted_graph h({1, 1, 1}, {0, 1}, {1, 2});
+    EXPECT_EQ((std::vector<unsigned>{0, 1, 2}), partition_graph(h, 3));
+    EXPECT_TRUE(partition_graph(weighted_graph(), 4).empty());
+}
+
+TEST(graph_partition, clusters) {
+    // The partition into as many parts as clusters should separate the
+    // clusters, cutting only the edges between them.
+    for (unsigned n_cluster: {2u, 4u, 7u}) {
+        const unsigned cluster_size = 60;
+        auto g = clustered_graph(n_cluster, cluster_size);
+        auto part = partition_graph(g, n_cluster);
+
+        ASSERT_EQ(g.size(), part.size());
+        EXPECT_EQ(n_cluster, edge_cut(g, part));
+
+        std::vector<unsigned> part_size(n_cluster);
+        for (auto p: part) {
+            ASSERT_LT(p, n_cluster);
+            ++part_size[p];
+        }
+        for (auto s: part_size) {
+            EXPECT_EQ(cluster_size, s);
+        }
+
+        // The partition is deterministic.
+        EXPECT_EQ(part, partition_graph(g, n_cluster));
+    }
+}
+
+TEST(graph_partition, balance) {
+    // A ring of vertices of varied weight is cut into arcs of near equal weight.
+    const unsigned n = 1000, n_part = 8;
+    std::vector<weighted_graph::weight_type> weights(n);
+    std::vector<unsigned> a, b;
+    for (auto v: make_span(n)) {
+        weights[v] = 1 + v%5;
+        a.push_back(v);
+        b.push_back((v+1)%n);
+    }
+    weighted_graph g(weights, a, b);
+    auto part = partition_graph(g, n_part, 0.05);
+
+    std::vector<weighted_graph::weight_type> part_weight(n_part);
+    for (auto v: make_span(n)) part_weight[part[v]] += weights[v];
+
+    double mean = double(g.total_weight())/n_part;
+    for (auto w: part_weight) {
+        EXPECT_LE(w, 1.05*mean+5);
+        EXPECT_GE(w, 0.8*mean);
+    }
+    EXPECT_LE(edge_cut(g, part), 4*n_part);
+}
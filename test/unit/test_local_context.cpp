@@ -46,6 +46,7 @@ TEST(local_context, sum)
     EXPECT_EQ(42.f, ctx.min(42.));
     EXPECT_EQ(42,   ctx.sum(42));
     EXPECT_EQ(42u,  ctx.min(42u));
+    EXPECT_EQ((std::vector<double>{1., 42.}), ctx.sum(std::vector<double>{1., 42.}));
 }
 
 TEST(local_context, gather)
@@ -57,6 +58,14 @@ TEST(local_context, gather)
     EXPECT_EQ(std::vector<std::string>{"42"}, ctx.gather(std::string("42"), 0));
 }
 
+TEST(local_context, gather_all)
+{
+    arb::local_context ctx;
+
+    EXPECT_EQ(std::vector<int>{42}, ctx.gather_all(42));
+    EXPECT_EQ(std::vector<double>{42}, ctx.gather_all(42.));
+}
+
 TEST(local_context, gather_spikes)
 {
     arb::local_context ctx;
@@ -1,5 +1,8 @@
 #include "../test/gtest.h"
 
+#include <functional>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 #include <arborio/label_parse.hpp>
@@ -12,6 +15,7 @@
 #include <arbor/morph/primitives.hpp>
 #include <arbor/morph/region.hpp>
 
+#include "morph/mprovider_cache.hpp"
 #include "util/span.hpp"
 #include "util/strprintf.hpp"
 
@@ -173,6 +177,89 @@ TEST(region, thingify_named) {
     }
 }
 
+TEST(mprovider, shared_cache) {
+    using pvec = std::vector<msize_t>;
+    using svec = std::vector<mpoint>;
+
+    auto sm = segments_from_points(svec{ {0,0,0,1}, {10,0,0,1} }, pvec{mnpos, 0});
+    morphology m(sm);
+
+    label_dict d1, d2;
+    d1.set("cake", reg::cable(0, 0.2, 0.3));
+    d1.set("icing", join(region("cake"_lab), reg::cable(0, 0.5, 0.6)));
+    d2.set("cake", reg::cable(0, 0.4, 0.5));
+    d2.set("icing", join(region("cake"_lab), reg::cable(0, 0.5, 0.6)));
+
+    // Providers on copies of one morphology share evaluations only with
+    // providers with the same dictionary.
+    mprovider p1(m, d1), p2(m, d2), p3(m, d1);
+    EXPECT_EQ((mcable_list{{0, 0.2, 0.3}}), p1.region("cake").cables());
+    EXPECT_EQ((mcable_list{{0, 0.4, 0.5}}), p2.region("cake").cables());
+    EXPECT_EQ((mcable_list{{0, 0.2, 0.3}, {0, 0.5, 0.6}}), p3.region("icing").cables());
+    EXPECT_EQ((mcable_list{{0, 0.4, 0.6}}), p2.concrete_region(region("icing"_lab)).cables());
+
+    // Parameters are compared at full precision.
+    EXPECT_EQ((mcable_list{{0, 0.1, 0.2}}), p1.concrete_region(reg::cable(0, 0.1, 0.2)).cables());
+    EXPECT_EQ((mcable_list{{0, 0.1, 0.2000001}}), p3.concrete_region(reg::cable(0, 0.1, 0.2000001)).cables());
+    EXPECT_EQ((mlocation_list{{0, 0.25}}), p1.concrete_locset(ls::location(0, 0.25)));
+
+    // Providers may be constructed and queried concurrently.
+    std::vector<std::thread> threads;
+    std::vector<mcable_list> icing(4);
+    for (unsigned i = 0; i<icing.size(); ++i) {
+        threads.emplace_back([&, i] { icing[i] = mprovider(m, i%2? d1: d2).region("icing").cables(); });
+    }
+    for (auto& t: threads) t.join();
+    for (unsigned i = 0; i<icing.size(); ++i) {
+        EXPECT_EQ(i%2? p1.region("icing").cables(): p2.region("icing").cables(), icing[i]);
+    }
+
+    // Failed evaluations are not cached.
+    label_dict d3 = d1;
+    d3.set("icing", region("topping"_lab));
+    d3.set("topping", region("icing"_lab));
+    EXPECT_THROW(mprovider(m, d3), circular_definition);
+    EXPECT_THROW(mprovider(m, d3), circular_definition);
+    EXPECT_THROW(p1.concrete_region(region("durian"_lab)), unbound_name);
+}
+
+TEST(mprovider, cache_eviction) {
+    lru_cache<int> cache(2);
+    auto insert = [&](std::string_view k, int v) { return cache.insert(std::hash<std::string_view>{}(k), k, v); };
+    auto find = [&](std::string_view k) { return cache.find(std::hash<std::string_view>{}(k), k); };
+
+    EXPECT_EQ(1, insert("a", 1));
+    EXPECT_EQ(2, insert("b", 2));
+    EXPECT_EQ(1, insert("a", 3));
+    ASSERT_TRUE(find("a"));
+    EXPECT_EQ(1, *find("a"));
+
+    // "b" is least recently used.
+    EXPECT_EQ(4, insert("c", 4));
+    EXPECT_EQ(2u, cache.size());
+    EXPECT_FALSE(find("b"));
+    EXPECT_TRUE(find("a"));
+    EXPECT_TRUE(find("c"));
+
+    // Keys with the same hash are told apart.
+    EXPECT_EQ(5, cache.insert(0, "d", 5));
+    EXPECT_EQ(6, cache.insert(0, "e", 6));
+    EXPECT_EQ(5, *cache.find(0, "d"));
+    EXPECT_FALSE(cache.find(0, "f"));
+    EXPECT_EQ(2u, cache.size());
+
+    // A provider cache holds at most its capacity of expressions.
+    using pvec = std::vector<msize_t>;
+    using svec = std::vector<mpoint>;
+    morphology m(segments_from_points(svec{ {0,0,0,1}, {10,0,0,1} }, pvec{mnpos, 0}));
+    mprovider p(m);
+    const unsigned n = mprovider_cache_capacity+10;
+    for (unsigned i = 0; i<n; ++i) {
+        EXPECT_EQ((mlocation_list{{0, i/double(n)}}), p.concrete_locset(ls::location(0, i/double(n))));
+    }
+    EXPECT_EQ((mlocation_list{{0, 0.}}), p.concrete_locset(ls::location(0, 0.)));
+}
+
 // Embedded evaluation (thingify) tests:
 
 TEST(locset, thingify) {
@@ -1,7 +1,9 @@
 #include "../gtest.h"
 
+#include <algorithm>
 #include <cmath>
 #include <map>
+#include <numeric>
 #include <vector>
 
 #include <arbor/cable_cell.hpp>
@@ -9,7 +11,9 @@
 #include <arbor/load_balance.hpp>
 #include <arbor/mechanism.hpp>
 #include <arbor/mechcat.hpp>
+#include <arbor/math.hpp>
 #include <arbor/mechinfo.hpp>
+#include <arbor/morph/place_pwlin.hpp>
 #include <arbor/sampling.hpp>
 #include <arbor/schedule.hpp>
 #include <arbor/simple_sampler.hpp>
@@ -1134,6 +1138,53 @@ void run_total_current_probe_test(const context& ctx) {
 }
 
 
+template <typename Backend>
+void run_extracellular_potential_probe_test(const context& ctx) {
+    // Compare extracellular potential at a set of electrodes with that
+    // computed from sampled total membrane currents.
+
+    auto m = make_y_morphology();
+    decor d;
+
+    d.place(mlocation{0, 0}, i_clamp(0.3), "clamp0");
+    d.paint(reg::all(), mechanism_desc("ca_linear").set("g", 0.01)); // [S/cm²]
+    d.set_default(membrane_capacitance{0.01}); // [F/m²]
+    d.set_default(cv_policy_fixed_per_branch(3));
+    cable_cell cell(m, {}, d);
+
+    const double sigma = 0.5; // [S/m]
+    std::vector<mpoint> electrodes = {{30, 0, 0, 0}, {0, 50, 20, 0}, {0, 0, 0, 0}};
+
+    auto current = run_simple_sampler<std::vector<double>, mcable_list>(ctx, 0.5, {cell}, 0,
+        cable_probe_total_current_cell{}, {0.1, 0.4}).at(0);
+    auto potential = run_simple_sampler<std::vector<double>, std::vector<mpoint>>(ctx, 0.5, {cell}, 0,
+        cable_probe_extracellular_potential{electrodes, sigma}, {0.1, 0.4}).at(0);
+
+    ASSERT_EQ(2u, current.size());
+    ASSERT_EQ(2u, potential.size());
+
+    const mcable_list& cables = current.meta;
+    EXPECT_EQ(electrodes, potential.meta);
+
+    place_pwlin place(cell.morphology());
+    for (unsigned j = 0; j<2; ++j) {
+        EXPECT_EQ(current[j].t, potential[j].t);
+        ASSERT_EQ(cables.size(), current[j].v.size());
+        ASSERT_EQ(electrodes.size(), potential[j].v.size());
+
+        for (unsigned e = 0; e<electrodes.size(); ++e) {
+            double expected = 0;
+            for (unsigned k = 0; k<cables.size(); ++k) {
+                mpoint x = place.at(mlocation{cables[k].branch, 0.5*(cables[k].prox_pos+cables[k].dist_pos)});
+                double r = std::max(distance(x, electrodes[e]), x.radius);
+                expected += current[j].v[k]/(4*math::pi<double>*sigma*r);
+            }
+            EXPECT_NE(0., expected);
+            EXPECT_TRUE(testing::near_relative(expected, potential[j].v[e], 1e-9));
+        }
+    }
+}
+
 template <typename Backend>
 void run_stimulus_probe_test(const context& ctx) {
     // Model two simple stick cable cells, 3 CVs each, and stimuli on cell 0, cv 1
@@ -1305,7 +1356,7 @@ void run_exact_sampling_probe_test(const context& ctx) {
 #define PROBE_TESTS \
     v_i, v_cell, v_sampled, expsyn_g, expsyn_g_cell, ion_density, \
     axial_and_ion_current_sampled, partial_density, exact_sampling, \
-    multi, total_current
+    multi, total_current, extracellular_potential
 
 #undef RUN_MULTICORE
 #define RUN_MULTICORE(x) \
@@ -1385,3 +1436,157 @@ TEST(probe, get_probe_metadata) {
     EXPECT_EQ((mlocation{2, 1.}), locs[1]);
     EXPECT_EQ((mlocation{5, 1.}), locs[2]);
 }
+
+// Test bulk samplers against samples taken through regular samplers on the same probes.
+
+TEST(probe, bulk_sampler) {
+    auto m = common_morphology::m_mlt_b6;
+    decor d;
+
+    d.paint(reg::all(), mechanism_desc("pas"));
+    d.paint(reg::branch(1), mechanism_desc("param_as_state").set("p", 10.));
+    d.paint(reg::branch(2), mechanism_desc("param_as_state").set("p", 20.));
+    d.place(mlocation{0, 0.5}, i_clamp::box(0.1, 0.5, 2.), "clamp");
+
+    std::vector<cable_cell> cells = {cable_cell{m, {}, d}, cable_cell{m, {}, d}};
+    cable1d_recipe rec(cells, false);
+    rec.catalogue() = make_unit_test_catalogue(global_default_catalogue());
+
+    for (cell_gid_type gid: {0, 1}) {
+        rec.add_probe(gid, 0, cable_probe_membrane_voltage{ls::terminal()});        // interpolated
+        rec.add_probe(gid, 1, cable_probe_membrane_voltage_cell{});                 // not scalar
+        rec.add_probe(gid, 2, cable_probe_density_state{ls::terminal(), "param_as_state", "s"}); // scalar
+    }
+
+    context ctx = make_context();
+    partition_hint_map phints = {
+       {cell_kind::cable, {partition_hint::max_size, partition_hint::max_size, true}}
+    };
+    simulation sim(rec, partition_load_balance(rec, ctx, phints), ctx);
+
+    using sample_key = std::pair<cell_member_type, unsigned>;
+    using sample_trace = std::vector<std::pair<time_type, double>>;
+    std::map<sample_key, sample_trace> expected, bulk, bulk_direct;
+
+    auto sched = regular_schedule(0.1);
+
+    sim.add_sampler(all_probes, sched,
+        [&](probe_metadata pm, std::size_t n, const sample_record* records) {
+            for (std::size_t i = 0; i<n; ++i) {
+                if (auto* v = any_cast<const double*>(records[i].data)) {
+                    expected[{pm.id, pm.index}].push_back({records[i].time, *v});
+                }
+            }
+        });
+
+    auto bulk_sampler = [](std::map<sample_key, sample_trace>& traces) {
+        return [&traces](const sample_columns& cols) {
+            for (std::size_t k = 0; k<cols.n_probe; ++k) {
+                auto& trace = traces[{cols.meta[k].id, cols.meta[k].index}];
+                for (std::size_t j = 0; j<cols.n_sample; ++j) {
+                    trace.push_back({cols.time[k*cols.n_sample+j], cols.value[k*cols.n_sample+j]});
+                }
+            }
+        };
+    };
+
+    sim.add_bulk_sampler(all_probes, sched, bulk_sampler(bulk));
+    sim.add_bulk_sampler([](cell_member_type pid) { return pid.index==2; }, sched, bulk_sampler(bulk_direct));
+
+    sim.run(1.0, 0.025);
+
+    // Two cells each with three terminal locations for each of probes 0 and 2.
+    ASSERT_EQ(12u, expected.size());
+    EXPECT_EQ(expected, bulk);
+
+    std::map<sample_key, sample_trace> expected_direct;
+    for (auto& [key, trace]: expected) {
+        ASSERT_EQ(10u, trace.size());
+        if (key.first.index==2) expected_direct[key] = trace;
+    }
+    EXPECT_EQ(4u, expected_direct.size());
+    EXPECT_EQ(expected_direct, bulk_direct);
+}
+
+TEST(probe, reduced_sampler) {
+    auto m = common_morphology::m_mlt_b6;
+    decor d;
+
+    d.paint(reg::all(), mechanism_desc("pas"));
+    d.place(mlocation{0, 0.5}, i_clamp::box(0.1, 0.5, 2.), "clamp");
+
+    cable1d_recipe rec(cable_cell{m, {}, d}, false);
+    rec.add_probe(0, 0, cable_probe_membrane_voltage{ls::terminal()});  // interpolated
+    rec.add_probe(0, 1, cable_probe_membrane_voltage_cell{});           // not scalar
+    rec.add_probe(0, 2, cable_probe_total_ion_current_density{ls::terminal()});
+
+    context ctx = make_context();
+    simulation sim(rec, partition_load_balance(rec, ctx), ctx);
+
+    using sample_key = std::pair<cell_member_type, unsigned>;
+    using sample_trace = std::vector<std::pair<time_type, double>>;
+
+    auto trace_sampler = [](std::map<sample_key, sample_trace>& traces) {
+        return [&traces](probe_metadata pm, std::size_t n, const sample_record* records) {
+            for (std::size_t i = 0; i<n; ++i) {
+                auto* v = any_cast<const double*>(records[i].data);
+                ASSERT_TRUE(v);
+                traces[{pm.id, pm.index}].push_back({records[i].time, *v});
+            }
+        };
+    };
+
+    std::map<sample_key, sample_trace> full;
+    std::map<sample_reduction, std::map<sample_key, sample_trace>> reduced;
+    const unsigned window = 3;
+
+    auto sched = regular_schedule(0.1);
+    sim.add_sampler([](cell_member_type pid) { return pid.index!=1; }, sched, trace_sampler(full));
+
+    for (auto op: {sample_reduction::decimate, sample_reduction::mean, sample_reduction::min, sample_reduction::max, sample_reduction::rms}) {
+        sim.add_sampler(all_probes, sched, trace_sampler(reduced[op]), sample_reducer{op, window});
+    }
+
+    EXPECT_THROW(sim.add_sampler(all_probes, sched, trace_sampler(full), sample_reducer{sample_reduction::mean, 0}), range_check_failure);
+
+    // Windows span the boundary between runs.
+    sim.run(0.5, 0.025);
+    sim.run(1.0, 0.025);
+
+    ASSERT_FALSE(full.empty());
+
+    for (auto& [op, traces]: reduced) {
+        ASSERT_EQ(full.size(), traces.size());
+
+        for (auto& [key, trace]: full) {
+            ASSERT_EQ(10u, trace.size());
+            const sample_trace& reduced_trace = traces[key];
+            ASSERT_EQ(3u, reduced_trace.size());
+
+            for (unsigned w = 0; w<3; ++w) {
+                auto begin = trace.begin()+w*window, end = begin+window;
+
+                double expected = end[-1].second;
+                switch (op) {
+                case sample_reduction::decimate:
+                    break;
+                case sample_reduction::mean:
+                    expected = std::accumulate(begin, end, 0., [](double a, auto& s) { return a+s.second; })/window;
+                    break;
+                case sample_reduction::min:
+                    expected = std::min_element(begin, end, [](auto& a, auto& b) { return a.second<b.second; })->second;
+                    break;
+                case sample_reduction::max:
+                    expected = std::max_element(begin, end, [](auto& a, auto& b) { return a.second<b.second; })->second;
+                    break;
+                case sample_reduction::rms:
+                    expected = std::sqrt(std::accumulate(begin, end, 0., [](double a, auto& s) { return a+s.second*s.second; })/window);
+                    break;
+                }
+
+                EXPECT_EQ(end[-1].first, reduced_trace[w].first);
+                EXPECT_DOUBLE_EQ(expected, reduced_trace[w].second);
+            }
+        }
+    }
+}
@@ -1,9 +1,14 @@
 #include "../gtest.h"
 
+#include <cmath>
+#include <cstdint>
 #include <random>
+#include <string>
 #include <vector>
 #include <any>
 
+#include <arbor/arbexcept.hpp>
+#include <arbor/benchmark_cell.hpp>
 #include <arbor/cable_cell.hpp>
 #include <arbor/common_types.hpp>
 #include <arbor/context.hpp>
@@ -14,7 +19,9 @@
 #include <arbor/simulation.hpp>
 #include <arbor/spike_source_cell.hpp>
 
+#include "thread_assignment.hpp"
 #include "util/rangeutil.hpp"
+#include "util/span.hpp"
 #include "util/transform.hpp"
 
 #include "common.hpp"
@@ -94,6 +101,57 @@ TEST(simulation, spike_global_callback) {
     EXPECT_EQ(expected_spikes, collected);
 }
 
+TEST(simulation, spike_statistics) {
+    play_spikes rec({
+        explicit_schedule({1., 2., 4., 7.}),  // ISIs 1, 2, 3
+        explicit_schedule({0.5, 5.5}),        // one ISI: no CV
+        explicit_schedule({3., 6., 9.}),      // ISIs 3, 3
+        explicit_schedule({}),
+        explicit_schedule({8.5}),
+        explicit_schedule({1., 2., 3.})       // not in any population
+    });
+
+    auto ctx = n_thread_context(4);
+    simulation sim(rec, partition_load_balance(rec, ctx), ctx);
+
+    EXPECT_TRUE(sim.spike_statistics().empty());
+    EXPECT_THROW(sim.set_spike_statistics({{{0, 3}, {2, 4}}, 2.}), arbor_exception);
+    EXPECT_THROW(sim.set_spike_statistics({{{0, 3}}, 0.}), arbor_exception);
+
+    // Populations are given out of order.
+    sim.set_spike_statistics({{{3, 5}, {0, 3}}, 2.});
+
+    auto check_stats = [&]() {
+        auto stats = sim.spike_statistics();
+        ASSERT_EQ(2u, stats.size());
+
+        auto& p0 = stats[0];
+        EXPECT_EQ(std::make_pair(0u, 3u), p0.population);
+        EXPECT_EQ(9u, p0.n_spike);
+        EXPECT_DOUBLE_EQ(9/(3*10e-3), p0.rate);
+        EXPECT_EQ((std::vector<std::uint64_t>{2, 2, 2, 2, 1}), p0.histogram);
+        EXPECT_EQ(2u, p0.n_isi_cv_cell);
+        EXPECT_DOUBLE_EQ(std::sqrt(2./3.)/2/2, p0.isi_cv);
+
+        auto& p1 = stats[1];
+        EXPECT_EQ(std::make_pair(3u, 5u), p1.population);
+        EXPECT_EQ(1u, p1.n_spike);
+        EXPECT_DOUBLE_EQ(1/(2*10e-3), p1.rate);
+        EXPECT_EQ((std::vector<std::uint64_t>{0, 0, 0, 0, 1}), p1.histogram);
+        EXPECT_EQ(0u, p1.n_isi_cv_cell);
+        EXPECT_TRUE(std::isnan(p1.isi_cv));
+    };
+
+    sim.run(5., 0.01);
+    sim.run(10., 0.01);
+    check_stats();
+
+    sim.reset();
+    EXPECT_EQ(0u, sim.spike_statistics().at(0).n_spike);
+    sim.run(10., 0.01);
+    check_stats();
+}
+
 struct lif_chain: public recipe {
     lif_chain(unsigned n, double delay, schedule triggers):
         n_(n), delay_(delay), triggers_(std::move(triggers)) {}
@@ -190,3 +248,191 @@ TEST(simulation, restart) {
         }
     }
 }
+
+TEST(simulation, group_costs) {
+    lif_chain rec(5, 10., explicit_schedule({1., 2., 3.}));
+
+    auto ctx = n_thread_context(4);
+    auto decomp = partition_load_balance(rec, ctx);
+    simulation sim(rec, decomp, ctx);
+
+    std::size_t n_spike = 0;
+    sim.set_global_spike_callback([&](const std::vector<spike>& spikes) { n_spike += spikes.size(); });
+
+    auto costs = sim.group_costs();
+    ASSERT_EQ(decomp.groups.size(), costs.size());
+    for (auto c: costs) EXPECT_EQ(0., c);
+
+    // Groups are advanced in order of cost after the first epoch: results
+    // are unchanged, and every group accumulates time.
+    sim.run(40., 0.01);
+    EXPECT_EQ(12u, n_spike);
+
+    auto after = sim.group_costs();
+    ASSERT_EQ(costs.size(), after.size());
+    for (auto c: after) EXPECT_GT(c, 0.);
+
+    sim.run(50., 0.01);
+    auto later = sim.group_costs();
+    for (unsigned i = 0; i<later.size(); ++i) EXPECT_GE(later[i], after[i]);
+}
+
+TEST(simulation, construction_times) {
+    lif_chain rec(5, 10., explicit_schedule({1., 2., 3.}));
+
+    auto ctx = n_thread_context(4);
+    auto decomp = partition_load_balance(rec, ctx);
+    simulation sim(rec, decomp, ctx);
+
+    // Phase times are recorded whether or not the profiler is enabled.
+    auto names = [](const profile::phase_times& times) {
+        std::vector<std::string> names;
+        for (const auto& [name, t]: times) {
+            names.push_back(name);
+            EXPECT_GE(t, 0.);
+        }
+        return names;
+    };
+
+    std::vector<std::string> expected_decomp =
+        {"init_decompose_balance", "init_decompose_query", "init_decompose_group", "init_decompose_domains"};
+    EXPECT_EQ(expected_decomp, names(decomp.construction_times));
+
+    std::vector<std::string> expected_sim =
+        {"init_cellgroups", "init_communicator", "init_eventgenerators"};
+    EXPECT_EQ(expected_sim, names(sim.construction_times()));
+}
+
+TEST(simulation, rebalance) {
+    lif_chain rec(5, 10., explicit_schedule({1., 2., 3.}));
+
+    // Threads bound to the first core: groups are pinned to threads, and
+    // reassigned on rebalance.
+    for (bool bound: {false, true}) {
+        proc_allocation resources(4, -1);
+        if (bound) resources.thread_affinity = {0};
+        auto ctx = make_context(resources);
+        auto decomp = partition_load_balance(rec, ctx);
+        simulation sim(rec, decomp, ctx);
+
+        std::size_t n_spike = 0;
+        sim.set_global_spike_callback([&](const std::vector<spike>& spikes) { n_spike += spikes.size(); });
+
+        // With one rank, the rank imbalance is always one.
+        EXPECT_EQ(1., sim.rebalance());
+
+        sim.run(20., 0.01);
+        EXPECT_EQ(1., sim.rebalance());
+
+        // Results are unchanged by the new assignment.
+        sim.run(40., 0.01);
+        EXPECT_EQ(12u, n_spike);
+        EXPECT_EQ(1., sim.rebalance());
+    }
+}
+
+TEST(simulation, rebalance_skewed) {
+    // Eight benchmark cells in groups of one, where the first costs ten
+    // times as much as any other to advance.
+    struct skewed_recipe: recipe {
+        cell_size_type num_cells() const override { return 8; }
+        cell_kind get_cell_kind(cell_gid_type) const override { return cell_kind::benchmark; }
+        util::unique_any get_cell_description(cell_gid_type gid) const override {
+            return benchmark_cell("src", "tgt", explicit_schedule({}), gid? 0.05: 0.5);
+        }
+    } rec;
+
+    proc_allocation resources(4, -1);
+    resources.thread_affinity = {0};
+    auto ctx = make_context(resources);
+    auto decomp = partition_load_balance(rec, ctx);
+    simulation sim(rec, decomp, ctx);
+
+    // Until the first rebalance, each thread advances two groups in turn.
+    EXPECT_EQ((std::vector<unsigned>{0, 0, 1, 1, 2, 2, 3, 3}), sim.group_threads());
+
+    sim.run(10., 0.1);
+    sim.rebalance();
+
+    // The costly group takes a thread to itself, and the other seven are
+    // spread over the other three threads. The threads share one core, so
+    // the measured costs of the cheap groups are noisy, and how many each
+    // thread gets is not fixed: see assign_groups_by_cost for that.
+    auto threads = sim.group_threads();
+    ASSERT_EQ(8u, threads.size());
+    std::vector<unsigned> per_thread(4);
+    for (auto t: threads) ++per_thread[t];
+    EXPECT_EQ(1u, per_thread[threads[0]]);
+    for (unsigned t = 0; t<4; ++t) {
+        if (t!=threads[0]) {
+            EXPECT_GE(per_thread[t], 1u);
+        }
+    }
+}
+
+TEST(simulation, assign_groups_by_cost) {
+    // Longest first, each group to the thread with least total cost: the
+    // groups of costs 5, 4, 3, 3, 2, 1 go to threads 0, 1, 1, 0, 1, 0.
+    auto a = assign_groups_by_cost({1, 5, 2, 4, 3, 3}, std::vector<int>(6, 0), {0, 0});
+    EXPECT_EQ((std::vector<unsigned>{1, 5, 0, 3, 4, 2}), a.groups);
+    EXPECT_EQ((std::vector<std::size_t>{0, 3, 6}), a.bounds);
+
+    // One costly group takes a thread to itself.
+    a = assign_groups_by_cost({1, 1, 6, 1, 1, 1}, std::vector<int>(6, 0), {0, 0});
+    EXPECT_EQ((std::vector<unsigned>{2, 0, 1, 3, 4, 5}), a.groups);
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 6}), a.bounds);
+
+    // Threads beyond the number of groups are left idle.
+    a = assign_groups_by_cost({2, 3}, {0, 0}, {0, 0, 0});
+    EXPECT_EQ((std::vector<unsigned>{1, 0}), a.groups);
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 2, 2}), a.bounds);
+
+    // Groups stay on the NUMA node of their state: the costly group on node
+    // 0 takes thread 0 to itself, but the groups on node 1 are not moved to
+    // thread 1, which is on node 0.
+    a = assign_groups_by_cost({9, 1, 1, 1, 1, 1}, {0, 0, 0, 1, 1, 1}, {0, 0, 1, 1});
+    EXPECT_EQ((std::vector<unsigned>{0, 1, 2, 3, 5, 4}), a.groups);
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 3, 5, 6}), a.bounds);
+
+    // Groups on a node without threads go to the least loaded thread.
+    a = assign_groups_by_cost({2, 1}, {0, 2}, {0, 1});
+    EXPECT_EQ((std::vector<unsigned>{0, 1}), a.groups);
+    EXPECT_EQ((std::vector<std::size_t>{0, 1, 2}), a.bounds);
+}
+
+TEST(simulation, cell_costs) {
+    struct measured_chain: lif_chain {
+        using lif_chain::lif_chain;
+        std::vector<double> costs;
+        double get_cell_cost(cell_gid_type gid) const override {
+            return gid<costs.size()? costs[gid]: 0;
+        }
+    };
+    measured_chain rec(5, 10., explicit_schedule({1., 2., 3.}));
+
+    auto ctx = n_thread_context(4);
+    partition_hint_map hints;
+    hints[cell_kind::lif].cpu_group_size = 2;
+    auto decomp = partition_load_balance(rec, ctx, hints);
+    simulation sim(rec, decomp, ctx);
+    sim.run(40., 0.01);
+
+    // The time for each group is shared among its cells.
+    auto group_costs = sim.group_costs();
+    rec.costs = sim.cell_costs();
+    ASSERT_EQ(5u, rec.costs.size());
+    for (auto i: util::count_along(decomp.groups)) {
+        const auto& gids = decomp.groups[i].gids;
+        for (auto gid: gids) {
+            EXPECT_GT(rec.costs[gid], 0.);
+            EXPECT_DOUBLE_EQ(group_costs[i]/gids.size(), rec.costs[gid]);
+        }
+    }
+
+    // The measured costs can balance a new decomposition.
+    hints[cell_kind::lif].strategy = partition_strategy::cost;
+    auto rebalanced = partition_load_balance(rec, ctx, hints, partition_strategy::cost);
+    std::size_t n_cell = 0;
+    for (const auto& g: rebalanced.groups) n_cell += g.gids.size();
+    EXPECT_EQ(5u, n_cell);
+}
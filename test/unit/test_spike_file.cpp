@@ -0,0 +1,160 @@
+#include "../gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <arbor/spike.hpp>
+
+#include <arborio/spike_file.hpp>
+
+using namespace arb;
+using namespace arborio;
+
+namespace {
+// Remove named temporary file on scope exit.
+struct temp_file {
+    std::string path;
+
+    explicit temp_file(const std::string& name):
+        path((std::filesystem::temp_directory_path()/name).string())
+    {}
+
+    ~temp_file() { std::remove(path.c_str()); }
+};
+
+bool spike_less(const spike& a, const spike& b) {
+    return a.time<b.time || (a.time==b.time && a.source<b.source);
+}
+} // anonymous namespace
+
+TEST(spike_file, write_read) {
+    temp_file tmp("arbor_test_spike_file_write_read.arbspike");
+
+    // Batches are unsorted, and overflow the initial capacity.
+    std::vector<std::vector<spike>> batches = {
+        {{{3, 0}, 0.5}, {{1, 1}, 0.25}, {{1, 0}, 0.5}},
+        {},
+        {{{2, 0}, 1.5}, {{0, 0}, 1.0}},
+        {{{4, 1}, 2.0}}
+    };
+
+    std::vector<spike> expected;
+    {
+        spike_writer writer(tmp.path, 2);
+        auto callback = writer.callback();
+        for (auto& batch: batches) {
+            callback(batch);
+            expected.insert(expected.end(), batch.begin(), batch.end());
+        }
+        EXPECT_EQ(expected.size(), writer.size());
+
+        writer.close();
+        EXPECT_THROW(writer.append({{{0, 0}, 3.0}}), spike_file_error);
+        EXPECT_EQ(std::vector<std::string>{tmp.path}, writer.segments());
+    }
+    std::sort(expected.begin(), expected.end(), spike_less);
+
+    spike_reader reader(tmp.path);
+    ASSERT_EQ(expected.size(), reader.size());
+    EXPECT_EQ(expected, std::vector<spike>(reader.begin(), reader.end()));
+    EXPECT_EQ(std::filesystem::file_size(tmp.path), sizeof(spike_file_header)+expected.size()*sizeof(spike));
+}
+
+TEST(spike_file, segments) {
+    temp_file tmp("arbor_test_spike_file_segments.arbspike");
+    temp_file tmp1(tmp.path+".1"), tmp2(tmp.path+".2");
+
+    std::vector<spike> run0 = {{{0, 0}, 0.5}, {{1, 0}, 2.0}};
+    std::vector<spike> run1 = {{{1, 0}, 0.25}, {{0, 0}, 0.75}};
+    std::vector<spike> run2 = {{{2, 0}, 3.0}};
+
+    {
+        spike_writer writer(tmp.path, 1);
+
+        // A batch preceding the last spike written, as after a simulation
+        // reset, is an error, and is not written.
+        writer.append(run0);
+        EXPECT_THROW(writer.append(run1), spike_file_error);
+        EXPECT_EQ(run0.size(), writer.size());
+        EXPECT_EQ(std::vector<std::string>{tmp.path}, writer.segments());
+
+        // Segments are started explicitly.
+        writer.start_segment();
+        EXPECT_EQ(0u, writer.size());
+        writer.append(run1);
+        writer.start_segment();
+        writer.append(run2);
+        writer.close();
+
+        EXPECT_EQ((std::vector<std::string>{tmp.path, tmp1.path, tmp2.path}), writer.segments());
+    }
+
+    std::sort(run1.begin(), run1.end(), spike_less);
+    std::vector<std::vector<spike>> expected = {run0, run1, run2};
+    std::vector<std::string> paths = {tmp.path, tmp1.path, tmp2.path};
+    for (unsigned i = 0; i<paths.size(); ++i) {
+        spike_reader reader(paths[i]);
+        EXPECT_EQ(expected[i], std::vector<spike>(reader.begin(), reader.end()));
+    }
+}
+
+TEST(spike_file, merge) {
+    constexpr unsigned n_rank = 4;
+    constexpr unsigned n_spike_per_rank = 50000;
+
+    std::vector<temp_file> rank_files;
+    rank_files.reserve(n_rank);
+    temp_file merged("arbor_test_spike_file_merge.arbspike");
+
+    // Spike times are quantized so that there are ties across ranks.
+    std::mt19937 gen(23);
+    std::uniform_int_distribution<int> udist(0, 9999);
+
+    std::vector<spike> expected;
+    for (unsigned rank = 0; rank<n_rank; ++rank) {
+        rank_files.emplace_back("arbor_test_spike_file_merge_"+std::to_string(rank)+".arbspike");
+        spike_writer writer(rank_files.back().path, 1000);
+
+        // Each rank writes spikes for its own gids over ten epochs.
+        for (unsigned epoch = 0; epoch<10; ++epoch) {
+            std::vector<spike> batch;
+            for (unsigned i = 0; i<n_spike_per_rank/10; ++i) {
+                cell_gid_type gid = rank+n_rank*(udist(gen)%100);
+                batch.push_back({{gid, 0}, epoch+udist(gen)*1e-4});
+            }
+            writer.append(batch);
+            expected.insert(expected.end(), batch.begin(), batch.end());
+        }
+        writer.close();
+    }
+    std::sort(expected.begin(), expected.end(), spike_less);
+
+    std::vector<std::string> paths;
+    for (auto& f: rank_files) paths.push_back(f.path);
+
+    for (unsigned n_thread: {1u, 3u}) {
+        EXPECT_EQ(expected.size(), merge_spike_files(paths, merged.path, n_thread));
+
+        spike_reader reader(merged.path);
+        ASSERT_EQ(expected.size(), reader.size());
+        EXPECT_TRUE(std::equal(expected.begin(), expected.end(), reader.begin()));
+    }
+}
+
+TEST(spike_file, bad_file) {
+    temp_file tmp("arbor_test_spike_file_bad_file.arbspike");
+    EXPECT_THROW(spike_reader{tmp.path}, spike_file_error);
+    EXPECT_THROW(merge_spike_files({tmp.path}, tmp.path), spike_file_error);
+
+    std::FILE* f = std::fopen(tmp.path.c_str(), "wb");
+    ASSERT_TRUE(f);
+    std::vector<char> junk(200, 'x');
+    std::fwrite(junk.data(), 1, junk.size(), f);
+    std::fclose(f);
+
+    EXPECT_THROW(spike_reader{tmp.path}, spike_file_error);
+}
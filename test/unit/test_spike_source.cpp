@@ -6,6 +6,7 @@
 #include <arbor/util/unique_any.hpp>
 
 #include "spike_source_cell_group.hpp"
+#include "threading/threading.hpp"
 
 #include "../simple_recipes.hpp"
 
@@ -115,3 +116,40 @@ TEST(spike_source, exhaust)
     test_seq(regular_schedule(0, 1, 5));
     test_seq(explicit_schedule({0.3, 2.3, 4.7}));
 }
+
+// Test that a spike_source_cell_group with many cells, advanced over a
+// thread pool, produces each cell's spikes in cell order, and appends to
+// spikes from previous epochs until cleared.
+TEST(spike_source, multiple_cells)
+{
+    auto test_seq = [](schedule seq) {
+        const cell_size_type n = 37;
+        ss_recipe rec(n, spike_source_cell("src", seq));
+        cell_label_range srcs, tgts;
+
+        std::vector<cell_gid_type> gids;
+        for (cell_gid_type i = 0; i<n; ++i) gids.push_back(2*i+1);
+
+        auto ts = std::make_shared<threading::task_system>(4);
+        spike_source_cell_group group(gids, rec, srcs, tgts, ts);
+
+        epoch ep(0, 0., 10.);
+        group.advance(ep, 1, {});
+        ep.advance_to(20);
+        group.advance(ep, 1, {});
+
+        std::vector<spike> expected;
+        for (int k = 0; k<2; ++k) {
+            auto times = as_vector(seq.events(10.*k, 10.*(k+1)));
+            for (auto gid: gids) {
+                for (auto t: times) expected.push_back({{gid, 0u}, t});
+            }
+        }
+        EXPECT_EQ(expected, group.spikes());
+    };
+
+    std::mt19937_64 G;
+    test_seq(regular_schedule(0, 1));
+    test_seq(poisson_schedule(10, G));
+    test_seq(explicit_schedule({0.3, 2.3, 14.7}));
+}
@@ -204,6 +204,96 @@ TEST(SPIKES_TEST_CLASS, threshold_watcher) {
     EXPECT_FALSE(watch.is_crossed(2));
 }
 
+TEST(SPIKES_TEST_CLASS, threshold_watcher_many) {
+    using value_type = backend::value_type;
+    using index_type = backend::index_type;
+    using array = backend::array;
+    using iarray = backend::iarray;
+
+    // Watch 13 of 20 values, with thresholds and oscillating values chosen so
+    // that detectors cross at different steps, and check crossings and
+    // time since spike against a direct evaluation.
+    execution_context context;
+    const unsigned n = 20, n_step = 40;
+    const value_type dt = 0.1;
+
+    std::vector<index_type> index;
+    std::vector<value_type> thresh;
+    for (unsigned i = 0; i<n; ++i) {
+        if (i%3==1) continue;
+        index.push_back(i);
+        thresh.push_back(0.1*(i%7)-0.2);
+    }
+    const unsigned n_watch = index.size();
+
+    auto value_at = [](unsigned i, unsigned step) {
+        return std::sin(0.37*step*(1+0.1*i)+i);
+    };
+
+    // Values 0..9 are in intdom 0, 10..19 in intdom 1.
+    iarray cv_to_intdom(n, 0);
+    for (unsigned i = n/2; i<n; ++i) cv_to_intdom[i] = 1;
+
+    std::vector<index_type> src_to_spike_vec;
+    for (unsigned i = 0; i<n_watch; ++i) src_to_spike_vec.push_back(2*i);
+    iarray src_to_spike(n_watch);
+    memory::copy(src_to_spike_vec, src_to_spike);
+
+    std::vector<value_type> values_vec(n);
+    for (unsigned i = 0; i<n; ++i) values_vec[i] = value_at(i, 0);
+    array values(n);
+    memory::copy(values_vec, values);
+
+    array time_before(2, 0.);
+    array time_after(2, 0.);
+    array time_since_spike(2*n_watch, -1.0);
+
+    backend::threshold_watcher watch(cv_to_intdom.data(), values.data(), src_to_spike.data(),
+                                     &time_before, &time_after, index, thresh, context);
+
+    std::vector<threshold_crossing> expected;
+    std::vector<value_type> v_prev(values_vec);
+    for (unsigned step = 1; step<=n_step; ++step) {
+        // The two intdoms advance with different time steps.
+        value_type t0[2] = {(step-1)*dt, (step-1)*2*dt};
+        value_type t1[2] = {step*dt, step*2*dt};
+        memory::copy(std::vector<value_type>(t0, t0+2), time_before);
+        memory::copy(std::vector<value_type>(t1, t1+2), time_after);
+
+        for (unsigned i = 0; i<n; ++i) values_vec[i] = value_at(i, step);
+        memory::copy(values_vec, values);
+
+        watch.test(&time_since_spike);
+
+        std::vector<value_type> expected_tss(2*n_watch, -1.0);
+        for (unsigned k = 0; k<n_watch; ++k) {
+            auto cv = index[k];
+            auto d = cv_to_intdom[cv];
+            auto v0 = v_prev[cv], v1 = values_vec[cv];
+            if (v0<thresh[k] && v1>=thresh[k]) {
+                value_type t = t0[d] + (t1[d]-t0[d])*(thresh[k]-v0)/(v1-v0);
+                expected.push_back({k, t});
+                expected_tss[2*k] = t1[d]-t;
+            }
+            EXPECT_EQ(v1>=thresh[k], watch.is_crossed(k));
+        }
+        v_prev = values_vec;
+
+        std::vector<value_type> tss(2*n_watch);
+        memory::copy(time_since_spike, tss);
+        for (unsigned j = 0; j<tss.size(); ++j) {
+            EXPECT_NEAR(expected_tss[j], tss[j], 1e-12);
+        }
+    }
+
+    ASSERT_EQ(expected.size(), watch.crossings().size());
+    EXPECT_LT(n_watch, expected.size());
+    for (unsigned i = 0; i<expected.size(); ++i) {
+        EXPECT_EQ(expected[i].index, watch.crossings()[i].index);
+        EXPECT_NEAR(expected[i].time, watch.crossings()[i].time, 1e-12);
+    }
+}
+
 TEST(SPIKES_TEST_CLASS, threshold_watcher_interpolation) {
     double dt = 0.025;
     double duration = 1;
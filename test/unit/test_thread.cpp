@@ -1,8 +1,18 @@
 #include "../gtest.h"
 #include "common.hpp"
 
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <ostream>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 // (Pending abstraction of threading interface)
 #include <arbor/version.hpp>
 
@@ -116,6 +126,78 @@ TEST(notification_queue, test_move) {
     reset();
 }
 
+TEST(ws_deque, owner_and_thieves) {
+    // Owner pushes and pops while thieves steal: every task is taken exactly
+    // once, and the owner takes tasks newest first.
+    ws_deque d;
+    const int n_task = 100000;
+    const int n_thief = 3;
+    std::vector<std::atomic<int>> count(n_task);
+    for (auto& c: count) c = 0;
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> thieves;
+    for (int k = 0; k<n_thief; ++k) {
+        thieves.emplace_back([&] {
+            while (!done) {
+                if (task* t = d.steal()) {
+                    (*t)();
+                    delete t;
+                }
+            }
+        });
+    }
+
+    for (int i = 0; i<n_task; ++i) {
+        d.push(new task([&count, i] { ++count[i]; }));
+        if (i%3==0) {
+            if (task* t = d.pop()) {
+                (*t)();
+                delete t;
+            }
+        }
+    }
+    while (task* t = d.pop()) {
+        (*t)();
+        delete t;
+    }
+    done = true;
+    for (auto& t: thieves) t.join();
+
+    for (int i = 0; i<n_task; ++i) {
+        EXPECT_EQ(1, count[i]) << i;
+    }
+
+    std::vector<int> order;
+    for (int i = 0; i<3; ++i) d.push(new task([&order, i] { order.push_back(i); }));
+    task* oldest = d.steal();
+    while (task* t = d.pop()) {
+        (*t)();
+        delete t;
+    }
+    (*oldest)();
+    delete oldest;
+    EXPECT_EQ((std::vector<int>{2, 1, 0}), order);
+}
+
+TEST(task_system, external_thread) {
+    // Tasks submitted from a thread outside the pool are run by the pool.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        std::atomic<int> n{0};
+
+        std::thread([&] {
+            task_group g(&ts);
+            for (int i = 0; i<1000; ++i) {
+                g.run([&] { ++n; });
+            }
+            g.wait();
+        }).join();
+
+        EXPECT_EQ(1000, n);
+    }
+}
+
 TEST(task_group, test_copy) {
     for (int nthreads = 1; nthreads < 20; nthreads*=2) {
         task_system ts(nthreads);
@@ -189,6 +271,245 @@ TEST(task_group, parallel_for) {
     }
 }
 
+TEST(task_group, parallel_for_grain) {
+    // Adaptive splitting runs each index once for any grain, also when
+    // nested within another parallel_for.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        for (int grain: {1, 7, 1000}) {
+            const int m = 8, n = 5000;
+            std::vector<std::atomic<int>> count(m*n);
+            parallel_for::apply(0, m, &ts, [&](int i) {
+                parallel_for::apply(0, n, &ts, [&](int j) { ++count[i*n+j]; }, grain);
+            });
+            for (int i = 0; i < m*n; i++) {
+                EXPECT_EQ(1, count[i]);
+            }
+        }
+    }
+}
+
+TEST(task_group, parallel_reduce) {
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        for (int n = 0; n < 10000; n = !n ? 1 : 2 * n) {
+            auto sum = parallel_reduce::apply(0, n, &ts, 0l,
+                [](int i) { return long(i); },
+                [](long a, long b) { return a+b; });
+            EXPECT_EQ(long(n)*(n-1)/2, sum);
+
+            auto max = parallel_reduce::apply(0, n, &ts, -1,
+                [n](int i) { return (i*37)%(n+1); },
+                [](int a, int b) { return std::max(a, b); },
+                16);
+            int expected = -1;
+            for (int i = 0; i < n; i++) {
+                expected = std::max(expected, (i*37)%(n+1));
+            }
+            EXPECT_EQ(expected, max);
+        }
+
+        EXPECT_THROW(parallel_reduce::apply(0, 1000, &ts, 0,
+            [](int i) { if (i==500) throw std::runtime_error("500"); return i; },
+            [](int a, int b) { return a+b; }), std::runtime_error);
+    }
+}
+
+TEST(task_group, parallel_for_ordered) {
+    const int n = 100;
+    std::vector<unsigned> order(n);
+    for (int i = 0; i < n; i++) {
+        order[i] = (i*37)%n;
+    }
+
+    // With one thread the indices are run in order; with more, each is run once.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        std::vector<unsigned> run;
+        std::vector<std::atomic<int>> count(n);
+        std::mutex m;
+
+        parallel_for::apply_ordered(order, &ts, [&](unsigned i) {
+            ++count[i];
+            std::lock_guard<std::mutex> l(m);
+            run.push_back(i);
+        });
+
+        for (int i = 0; i < n; i++) {
+            EXPECT_EQ(1, count[i]);
+        }
+        if (nthreads==1) {
+            EXPECT_EQ(order, run);
+        }
+    }
+}
+
+TEST(task_group, parallel_for_pinned) {
+    // Each index is run by the same thread, in contiguous blocks, both at the
+    // top level and nested within another task.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        auto ids = ts.get_thread_ids();
+        const int n = 37;
+
+        std::vector<int> thread_of(n, -1);
+        auto record = [&](int i) { thread_of[i] = ids.at(std::this_thread::get_id()); };
+
+        parallel_for::apply_pinned(0, n, &ts, record);
+        for (int i = 0; i < n; i++) {
+            EXPECT_EQ(i*nthreads/n, thread_of[i]);
+        }
+
+        task_group g(&ts);
+        g.run([&] { parallel_for::apply_pinned(0, n, &ts, record); });
+        g.wait();
+        for (int i = 0; i < n; i++) {
+            EXPECT_EQ(i*nthreads/n, thread_of[i]);
+        }
+    }
+}
+
+TEST(parallel_loop, assigned) {
+    // Indices are run by the threads to which they are assigned, in any
+    // order; threads may be assigned no indices.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        auto ids = ts.get_thread_ids();
+        parallel_loop loop(&ts);
+
+        const unsigned n = 37;
+        std::vector<unsigned> order;
+        std::vector<std::size_t> bounds = {0};
+        std::vector<int> expected(n);
+        for (int t = 0; t < nthreads; t++) {
+            for (unsigned i = n; i-- > 0;) {
+                if ((int)(i*i%7)%nthreads==t) {
+                    order.push_back(i);
+                    expected[i] = t;
+                }
+            }
+            bounds.push_back(order.size());
+        }
+
+        std::vector<int> thread_of(n, -1);
+        loop.run_pinned(order, bounds, [&](std::size_t i) { thread_of[i] = ids.at(std::this_thread::get_id()); });
+        EXPECT_EQ(expected, thread_of);
+    }
+}
+
+TEST(parallel_loop, reuse) {
+    // One loop run repeatedly, with varying ranges and grain, and nested
+    // within a second loop; an exception in the body is rethrown by run,
+    // after which the loop can be run again.
+    for (int nthreads = 1; nthreads < 20; nthreads*=2) {
+        task_system ts(nthreads);
+        parallel_loop outer(&ts), inner(&ts);
+
+        for (std::size_t n: {0, 1, 7, 100, 1000}) {
+            for (std::size_t grain: {1, 3, 64}) {
+                std::vector<std::atomic<int>> count(n);
+                inner.run(n, [&](std::size_t i) { ++count[i]; }, grain);
+                for (std::size_t i = 0; i < n; i++) {
+                    EXPECT_EQ(1, count[i]);
+                }
+            }
+        }
+
+        const std::size_t m = 10, n = 50;
+        std::vector<std::atomic<int>> count(m*n);
+        outer.run(m, [&](std::size_t i) {
+            parallel_loop nested(&ts);
+            nested.run(n, [&](std::size_t j) { ++count[i*n+j]; });
+        });
+        for (auto& c: count) {
+            EXPECT_EQ(1, c);
+        }
+
+        EXPECT_THROW(inner.run(100, [](std::size_t i) { if (i==42) throw std::runtime_error("42"); }), std::runtime_error);
+
+        std::atomic<int> total{0};
+        inner.run(100, [&](std::size_t) { ++total; });
+        EXPECT_EQ(100, total);
+    }
+}
+
+TEST(parallel_loop, affine) {
+    // A thread that is busy has the indices of its block taken by the others.
+    const int nthreads = 4;
+    task_system ts(nthreads);
+    auto ids = ts.get_thread_ids();
+
+    std::vector<unsigned> order = {3, 2, 1, 0, 7, 6, 5, 4};
+    std::vector<std::size_t> bounds = {0, 2, 4, 6, 8};
+
+    std::vector<int> thread_of(order.size(), -1);
+    std::atomic<int> count{0};
+
+    // Thread 3 is kept busy until all indices have been run.
+    std::atomic<bool> started{false}, release{false};
+    task_group g(&ts);
+    g.run_on(3, [&] {
+        started = true;
+        while (!release) std::this_thread::yield();
+    });
+    while (!started) std::this_thread::yield();
+
+    parallel_loop loop(&ts);
+    task_group h(&ts);
+    h.run([&] {
+        loop.run_affine(order, bounds, [&](std::size_t i) {
+            thread_of[i] = ids.at(std::this_thread::get_id());
+            if (++count==(int)order.size()) release = true;
+        });
+    });
+    h.wait();
+    g.wait();
+
+    EXPECT_EQ((int)order.size(), count);
+    EXPECT_NE(3, thread_of[order[6]]);
+    EXPECT_NE(3, thread_of[order[7]]);
+}
+
+#ifdef __linux__
+TEST(task_system, affinity) {
+    auto affinity_of_this_thread = [] {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+        std::vector<int> cpus;
+        for (int c = 0; c<CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+        return cpus;
+    };
+
+    auto available = affinity_of_this_thread();
+    ASSERT_FALSE(available.empty());
+
+    EXPECT_THROW(task_system(2, {-1}), std::runtime_error);
+    EXPECT_FALSE(task_system(2).bound());
+
+    const int nthreads = 4;
+    {
+        task_system ts(nthreads, available);
+        EXPECT_TRUE(ts.bound());
+
+        std::vector<std::vector<int>> bound_to(nthreads);
+        task_group g(&ts);
+        for (int i = 0; i < nthreads; i++) {
+            g.run_on(i, [&, i] { bound_to[i] = affinity_of_this_thread(); });
+        }
+        g.wait();
+
+        // The constructing thread runs as thread 0, and is not bound.
+        EXPECT_EQ(available, bound_to[0]);
+        EXPECT_EQ(available, affinity_of_this_thread());
+        for (int i = 1; i < nthreads; i++) {
+            EXPECT_EQ(std::vector<int>{available[i%available.size()]}, bound_to[i]);
+        }
+    }
+}
+#endif
 
 TEST(task_group, manual_nested_parallel_for) {
     // Check for deadlock or stack overflow
@@ -0,0 +1,156 @@
+#include "../gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arbor/cable_cell.hpp>
+#include <arbor/load_balance.hpp>
+#include <arbor/sampling.hpp>
+#include <arbor/schedule.hpp>
+#include <arbor/simulation.hpp>
+#include <arbor/util/any_cast.hpp>
+
+#include <arborio/trace_file.hpp>
+
+#include "common_morphologies.hpp"
+#include "../simple_recipes.hpp"
+
+using namespace arb;
+using namespace arborio;
+
+namespace {
+// Remove named temporary file on scope exit.
+struct temp_file {
+    std::string path;
+
+    explicit temp_file(const std::string& name):
+        path((std::filesystem::temp_directory_path()/name).string())
+    {}
+
+    ~temp_file() { std::remove(path.c_str()); }
+};
+} // anonymous namespace
+
+TEST(trace_file, write_read) {
+    temp_file tmp("arbor_test_trace_file_write_read.arbtrace");
+
+    // Three probes across two calls, with samples not filling a whole
+    // number of blocks.
+    std::vector<probe_metadata> meta = {
+        {{3, 0}, 7, 0, {}},
+        {{3, 0}, 7, 1, {}},
+        {{5, 2}, 9, 0, {}}
+    };
+    const std::size_t n_sample = 5;
+
+    auto value = [](unsigned call, unsigned k, unsigned j) { return 100.*call+10.*k+j; };
+    auto time = [](unsigned call, unsigned j) { return 0.5*(n_sample*call+j); };
+
+    {
+        trace_writer writer(tmp.path, 4);
+        auto sampler = writer.sampler();
+
+        for (unsigned call = 0; call<2; ++call) {
+            // Second call has probes in reverse order.
+            std::vector<probe_metadata> call_meta = meta;
+            if (call) std::reverse(call_meta.begin(), call_meta.end());
+
+            std::vector<double> t, v;
+            for (unsigned k = 0; k<meta.size(); ++k) {
+                unsigned probe = call? meta.size()-1-k: k;
+                for (unsigned j = 0; j<n_sample; ++j) {
+                    t.push_back(time(call, j));
+                    v.push_back(value(call, probe, j));
+                }
+            }
+            sampler({meta.size(), n_sample, call_meta.data(), t.data(), v.data()});
+        }
+        writer.close();
+    }
+
+    trace_reader reader(tmp.path);
+    EXPECT_EQ(4u, reader.header().block_size);
+    ASSERT_EQ(3u, reader.num_probes());
+    ASSERT_EQ(30u, reader.num_records());
+
+    for (unsigned k = 0; k<meta.size(); ++k) {
+        const trace_probe& p = reader.probes()[k];
+        EXPECT_EQ(meta[k].id.gid, p.gid);
+        EXPECT_EQ(meta[k].id.index, p.lid);
+        EXPECT_EQ(meta[k].index, p.index);
+        EXPECT_EQ(meta[k].tag, p.tag);
+
+        std::vector<std::pair<double, double>> expected;
+        for (unsigned call = 0; call<2; ++call) {
+            for (unsigned j = 0; j<n_sample; ++j) {
+                expected.push_back({time(call, j), value(call, k, j)});
+            }
+        }
+        EXPECT_EQ(expected, reader.trace(k));
+    }
+    EXPECT_TRUE(reader.trace(3).empty());
+}
+
+TEST(trace_file, simulation) {
+    temp_file tmp("arbor_test_trace_file_simulation.arbtrace");
+
+    decor d;
+    d.paint(reg::all(), mechanism_desc("pas"));
+    d.place(mlocation{0, 0.5}, i_clamp::box(0.1, 0.5, 2.), "clamp");
+
+    std::vector<cable_cell> cells(3, cable_cell{common_morphology::m_mlt_b6, {}, d});
+    cable1d_recipe rec(cells, false);
+    for (cell_gid_type gid = 0; gid<3; ++gid) {
+        rec.add_probe(gid, 0, cable_probe_membrane_voltage{ls::terminal()});
+    }
+
+    context ctx = make_context();
+    simulation sim(rec, partition_load_balance(rec, ctx), ctx);
+
+    std::map<std::pair<cell_gid_type, unsigned>, std::vector<std::pair<double, double>>> expected;
+    sim.add_sampler(all_probes, regular_schedule(0.05),
+        [&](probe_metadata pm, std::size_t n, const sample_record* records) {
+            for (std::size_t i = 0; i<n; ++i) {
+                expected[{pm.id.gid, pm.index}].push_back({records[i].time, *util::any_cast<const double*>(records[i].data)});
+            }
+        });
+
+    {
+        trace_writer writer(tmp.path, 16);
+        sim.add_bulk_sampler(all_probes, regular_schedule(0.05), writer.sampler());
+        sim.run(2.0, 0.025);
+        sim.remove_all_samplers();
+        writer.close();
+    }
+
+    trace_reader reader(tmp.path);
+    ASSERT_EQ(expected.size(), reader.num_probes());
+
+    std::size_t n_record = 0;
+    for (std::size_t i = 0; i<reader.num_probes(); ++i) {
+        const trace_probe& p = reader.probes()[i];
+        auto& trace = expected[{p.gid, p.index}];
+        EXPECT_EQ(40u, trace.size());
+        EXPECT_EQ(trace, reader.trace(i));
+        n_record += trace.size();
+    }
+    EXPECT_EQ(n_record, reader.num_records());
+}
+
+TEST(trace_file, bad_file) {
+    temp_file tmp("arbor_test_trace_file_bad_file.arbtrace");
+    EXPECT_THROW(trace_reader{tmp.path}, trace_error);
+
+    std::FILE* f = std::fopen(tmp.path.c_str(), "wb");
+    ASSERT_TRUE(f);
+    std::vector<char> junk(200, 'x');
+    std::fwrite(junk.data(), 1, junk.size(), f);
+    std::fclose(f);
+
+    EXPECT_THROW(trace_reader{tmp.path}, trace_error);
+}